@@ -0,0 +1,317 @@
+/**
+ * load_generator.js
+ *
+ * Load generator for the RideMatcher addon path: the same open/closed-loop
+ * model, request mix and latency report as uber_mini_loadgen, but every
+ * operation crosses the N-API boundary, so the two reports show what the
+ * JavaScript layer costs per request
+ *
+ * Usage: node backend/bench/load_generator.js [--mode open|closed] [--rate 200]
+ *          [--duration 10] [--arrivals uniform|poisson] [--think-us 0]
+ *          [--nodes 50] [--drivers 12] [--mix find=35,update=30,complete=35]
+ *          [--update-batch 16] [--warmup 50] [--seed 42] [--out results.json]
+ */
+
+const fs = require('fs');
+const nativeAddon = require('../../build/Release/uber_mini_native.node');
+
+const OPERATIONS = ['find', 'update', 'complete'];
+
+function parseArgs(argv) {
+    const options = {
+        mode: 'open',
+        rate: 200,
+        duration: 10,
+        arrivals: 'uniform',
+        thinkUs: 0,
+        nodes: 50,
+        drivers: 12,
+        mix: { find: 35, update: 30, complete: 35 },
+        updateBatch: 16,
+        warmup: 50,
+        seed: 42,
+        out: null
+    };
+
+    for (let i = 2; i + 1 < argv.length; i += 2) {
+        const value = argv[i + 1];
+        switch (argv[i]) {
+            case '--mode': options.mode = value === 'closed' ? 'closed' : 'open'; break;
+            case '--rate': options.rate = Number(value); break;
+            case '--duration': options.duration = Number(value); break;
+            case '--arrivals': options.arrivals = value === 'poisson' ? 'poisson' : 'uniform'; break;
+            case '--think-us': options.thinkUs = Number(value); break;
+            case '--nodes': options.nodes = parseInt(value, 10); break;
+            case '--drivers': options.drivers = parseInt(value, 10); break;
+            case '--update-batch': options.updateBatch = parseInt(value, 10); break;
+            case '--warmup': options.warmup = parseInt(value, 10); break;
+            case '--seed': options.seed = parseInt(value, 10); break;
+            case '--out': options.out = value; break;
+            case '--mix':
+                options.mix = { find: 0, update: 0, complete: 0 };
+                for (const item of value.split(',')) {
+                    const [name, weight] = item.split('=');
+                    if (!(name in options.mix)) throw new Error(`Unknown operation in --mix: ${name}`);
+                    options.mix[name] = Number(weight);
+                }
+                break;
+            default:
+                throw new Error(`Unknown option ${argv[i]}`);
+        }
+    }
+    return options;
+}
+
+/**
+ * Small seeded PRNG (mulberry32) so runs are repeatable
+ */
+function createRandom(seed) {
+    let state = seed >>> 0;
+    return function next() {
+        state = (state + 0x6D2B79F5) >>> 0;
+        let t = state;
+        t = Math.imul(t ^ (t >>> 15), t | 1);
+        t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
+
+/**
+ * Latency samples in microseconds with nearest-rank percentiles
+ */
+class LatencySamples {
+    constructor() {
+        this.samples = [];
+        this.sorted = true;
+    }
+
+    record(us) {
+        this.samples.push(us);
+        this.sorted = false;
+    }
+
+    // Back-fill the samples a steady client would have seen during a stall
+    recordCorrected(us, intervalUs) {
+        this.record(us);
+        if (intervalUs <= 0) return;
+        for (let missed = us - intervalUs; missed >= intervalUs; missed -= intervalUs) {
+            this.record(missed);
+        }
+    }
+
+    percentile(p) {
+        if (this.samples.length === 0) return 0;
+        if (!this.sorted) {
+            this.samples.sort((a, b) => a - b);
+            this.sorted = true;
+        }
+        const rank = Math.floor((p / 100) * this.samples.length);
+        return this.samples[Math.min(rank, this.samples.length - 1)];
+    }
+
+    mean() {
+        if (this.samples.length === 0) return 0;
+        return this.samples.reduce((sum, value) => sum + value, 0) / this.samples.length;
+    }
+
+    toJSON() {
+        const round = (value) => Math.round(value * 10) / 10;
+        return {
+            count: this.samples.length,
+            mean: round(this.mean()),
+            p50: round(this.percentile(50)),
+            p90: round(this.percentile(90)),
+            p99: round(this.percentile(99)),
+            p999: round(this.percentile(99.9)),
+            max: round(this.percentile(100))
+        };
+    }
+}
+
+function nowUs() {
+    return Number(process.hrtime.bigint()) / 1000;
+}
+
+// Busy-wait: the generator owns the event loop for the whole run
+function waitUntilUs(deadline) {
+    while (nowUs() < deadline) {
+        // spin
+    }
+}
+
+function createLoad(options, rideMatcher, handles, random) {
+    const totalWeight = OPERATIONS.reduce((sum, op) => sum + options.mix[op], 0);
+    const activeTrips = [];
+    const batchHandles = new Int32Array(options.updateBatch);
+    const batchLocations = new Int32Array(options.updateBatch);
+    const oneHandle = new Int32Array(1);
+    const oneLocation = new Int32Array(1);
+    const available = Uint8Array.of(1);
+    let passengerCounter = 0;
+
+    const randomNode = () => Math.floor(random() * options.nodes);
+
+    return {
+        nextOperation() {
+            let pick = random() * totalWeight;
+            for (const op of OPERATIONS) {
+                pick -= options.mix[op];
+                if (pick < 0) return op;
+            }
+            return OPERATIONS[OPERATIONS.length - 1];
+        },
+
+        // Returns false when the operation had nothing to do
+        execute(op) {
+            if (op === 'find') {
+                const pickup = randomNode();
+                let destination = randomNode();
+                while (destination === pickup) destination = randomNode();
+
+                const match = rideMatcher.findRide(`P${passengerCounter++}`, pickup, destination);
+                if (!match.success) return false;
+                activeTrips.push([rideMatcher.getDriverHandles([match.driver.id])[0], destination]);
+                return true;
+            }
+
+            if (op === 'update') {
+                for (let i = 0; i < options.updateBatch; i++) {
+                    batchHandles[i] = handles[Math.floor(random() * handles.length)];
+                    batchLocations[i] = randomNode();
+                }
+                return rideMatcher.updateDriverLocations(batchHandles, batchLocations) > 0;
+            }
+
+            if (activeTrips.length === 0) return false;
+            const [handle, dropOff] = activeTrips.shift();
+            oneHandle[0] = handle;
+            oneLocation[0] = dropOff;
+            rideMatcher.updateDriverLocations(oneHandle, oneLocation);
+            return rideMatcher.setDriverAvailabilities(oneHandle, available) === 1;
+        }
+    };
+}
+
+function main() {
+    const options = parseArgs(process.argv);
+    const random = createRandom(options.seed);
+
+    const cityData = nativeAddon.generateCityGraph(options.nodes);
+    const rideMatcher = new nativeAddon.RideMatcher(cityData.graph);
+
+    const vehicleTypes = ['Sedan', 'SUV', 'Compact'];
+    const fleet = [];
+    for (let i = 0; i < options.drivers; i++) {
+        fleet.push({
+            id: `L${i}`,
+            name: `Load Driver ${i}`,
+            currentLocation: Math.floor(random() * options.nodes),
+            isAvailable: true,
+            vehicleType: vehicleTypes[i % 3],
+            rating: 4.5,
+            completedRides: 0
+        });
+    }
+    const handles = rideMatcher.addDrivers(fleet);
+    const load = createLoad(options, rideMatcher, handles, random);
+
+    console.error(`Warming up (${options.warmup} requests)...`);
+    for (let i = 0; i < options.warmup; i++) {
+        load.execute(load.nextOperation());
+    }
+
+    const operations = {};
+    for (const op of OPERATIONS) {
+        operations[op] = { count: 0, failures: 0, serviceUs: new LatencySamples() };
+    }
+    const latencyUs = new LatencySamples();
+    const serviceUs = new LatencySamples();
+    let requests = 0;
+    let maxScheduleLagUs = 0;
+
+    const runOne = () => {
+        const op = load.nextOperation();
+        const begin = nowUs();
+        const ok = load.execute(op);
+        const end = nowUs();
+
+        serviceUs.record(end - begin);
+        operations[op].count++;
+        operations[op].serviceUs.record(end - begin);
+        if (!ok) operations[op].failures++;
+        requests++;
+        return { begin, end };
+    };
+
+    console.error(`Running ${options.mode}-loop load for ${options.duration}s on ` +
+                  `${options.nodes} nodes / ${options.drivers} drivers...`);
+
+    const start = nowUs();
+    if (options.mode === 'open') {
+        // Latency counts from the intended arrival time
+        const total = Math.floor(options.rate * options.duration);
+        const meanGapUs = 1e6 / options.rate;
+        let offsetUs = 0;
+        for (let i = 0; i < total; i++) {
+            const intended = start + offsetUs;
+            offsetUs += options.arrivals === 'poisson'
+                ? -Math.log(1 - random()) * meanGapUs
+                : meanGapUs;
+
+            waitUntilUs(intended);
+            const { begin, end } = runOne();
+            maxScheduleLagUs = Math.max(maxScheduleLagUs, begin - intended);
+            latencyUs.record(end - intended);
+        }
+    } else {
+        const raw = [];
+        const stop = start + options.duration * 1e6;
+        while (nowUs() < stop) {
+            const { begin, end } = runOne();
+            raw.push(end - begin);
+            if (options.thinkUs > 0) waitUntilUs(end + options.thinkUs);
+        }
+        const intervalUs = options.thinkUs + serviceUs.mean();
+        for (const sample of raw) {
+            latencyUs.recordCorrected(sample, intervalUs);
+        }
+    }
+    const wallSec = (nowUs() - start) / 1e6;
+
+    const stats = rideMatcher.getStats();
+    const report = {
+        tool: 'uber_mini_loadgen',
+        target: 'addon',
+        mode: options.mode,
+        ...(options.mode === 'open'
+            ? { arrivals: options.arrivals, targetRate: options.rate }
+            : { thinkUs: options.thinkUs }),
+        nodes: options.nodes,
+        drivers: options.drivers,
+        seed: options.seed,
+        requests,
+        wallSec: Math.round(wallSec * 10) / 10,
+        throughput: Math.round((requests / wallSec) * 10) / 10,
+        ...(options.mode === 'open' ? { maxScheduleLagUs: Math.round(maxScheduleLagUs * 10) / 10 } : {}),
+        latencyUs,
+        serviceUs,
+        operations,
+        matcher: {
+            successfulMatches: stats.successfulMatches,
+            failedMatches: stats.failedMatches,
+            availableDrivers: stats.availableDrivers
+        }
+    };
+
+    console.error(`Throughput: ${report.throughput} req/s, p50 ${latencyUs.percentile(50).toFixed(1)}us, ` +
+                  `p99 ${latencyUs.percentile(99).toFixed(1)}us, p999 ${latencyUs.percentile(99.9).toFixed(1)}us`);
+
+    const json = JSON.stringify(report);
+    if (options.out) {
+        fs.writeFileSync(options.out, json + '\n');
+    } else {
+        console.log(json);
+    }
+}
+
+main();
@@ -0,0 +1,77 @@
+/**
+ * alloc_counter.cpp
+ *
+ * Replacement global operator new/delete that count allocator calls
+ * (benchmark executables only; never linked into the addon)
+ */
+
+#include "bench/alloc_counter.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* countedAlloc(std::size_t size) {
+    RideSharing::Bench::allocationCalls.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* ptr = std::malloc(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    RideSharing::Bench::allocationCalls.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void*)) align = sizeof(void*);
+    // aligned_alloc requires a size that is a multiple of the alignment
+    std::size_t rounded = (size + align - 1) / align * align;
+    void* ptr = std::aligned_alloc(align, rounded == 0 ? align : rounded);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+struct CountingRegistration {
+    CountingRegistration() {
+        RideSharing::Bench::allocationCountingActive.store(true, std::memory_order_relaxed);
+    }
+};
+
+CountingRegistration registration;
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
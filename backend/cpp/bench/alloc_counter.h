@@ -0,0 +1,29 @@
+/**
+ * alloc_counter.h
+ *
+ * Global allocation counter for the native benchmarks. Linking
+ * alloc_counter.cpp replaces operator new/delete with versions that count
+ * every call, so cases can report allocator calls per operation.
+ *
+ * Time Complexity: O(1) per allocation (one relaxed atomic increment)
+ * Space Complexity: O(1)
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <atomic>
+
+namespace RideSharing {
+namespace Bench {
+
+// Calls to any operator new since start-up
+inline std::atomic<unsigned long long> allocationCalls(0);
+
+// Set by alloc_counter.cpp when its replacement operators are linked in
+inline std::atomic<bool> allocationCountingActive(false);
+
+} // namespace Bench
+} // namespace RideSharing
+
+#endif // ALLOC_COUNTER_H
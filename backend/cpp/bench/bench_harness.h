@@ -0,0 +1,177 @@
+/**
+ * bench_harness.h
+ *
+ * Minimal micro-benchmark harness for the native benchmarks: times each
+ * iteration of a callable with a steady clock, summarises the samples and
+ * writes the results as JSON so runs can be tracked over time
+ *
+ * When hardware counters are attached with setCounters(), they run across
+ * the timed loop and are reported as averages per operation (iterations
+ * times opsPerIteration, like nsPerOp); when alloc_counter.cpp is linked
+ * in, allocator calls are reported the same way
+ * Cases that produce output can set bytesPerIteration to report MB/s;
+ * build cases set structureBytes to report the size of what they built
+ *
+ * Time Complexity: O(k log k) to summarise k samples
+ * Space Complexity: O(k)
+ */
+
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RideSharing {
+namespace Bench {
+
+// Summary of one benchmark case at one scale
+struct BenchResult {
+    std::string name;
+    int scale;                   // City size (nodes) the case ran on
+    long long iterations;
+    long long opsPerIteration;   // Logical operations timed per iteration
+    double meanNs;
+    double medianNs;
+    double p90Ns;
+    double minNs;
+    double maxNs;
+    CounterSample counters;      // Totals over all timed iterations
+    bool allocationsCounted;     // Whether allocations holds a real count
+    unsigned long long allocations; // operator new calls over all timed iterations
+    long long bytesPerIteration; // Output produced per iteration (0 = not a throughput case)
+    long long structureBytes;    // Size of the structure a build case produced (0 = none)
+
+    BenchResult() : scale(0), iterations(0), opsPerIteration(1), meanNs(0.0),
+                    medianNs(0.0), p90Ns(0.0), minNs(0.0), maxNs(0.0),
+                    allocationsCounted(false), allocations(0), bytesPerIteration(0),
+                    structureBytes(0) {}
+};
+
+// Keeps results observable so the optimiser cannot drop the timed work
+inline volatile double resultSink = 0.0;
+
+inline void doNotOptimize(double value) {
+    resultSink = value;
+}
+
+// Counters sampled around each case's timed loop (none by default)
+inline PerfCounters* activeCounters = nullptr;
+
+inline void setCounters(PerfCounters* counters) {
+    activeCounters = counters;
+}
+
+/**
+ * Time fn() for the given number of iterations after a short warm-up
+ * fn receives the iteration index
+ */
+template <typename Fn>
+BenchResult run(const std::string& name, int scale, int iterations,
+                long long opsPerIteration, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+
+    int warmup = std::max(1, iterations / 10);
+    for (int i = 0; i < warmup; ++i) {
+        fn(i);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    unsigned long long allocationsBefore = allocationCalls.load(std::memory_order_relaxed);
+    if (activeCounters != nullptr) {
+        activeCounters->start();
+    }
+    for (int i = 0; i < iterations; ++i) {
+        Clock::time_point start = Clock::now();
+        fn(i);
+        Clock::time_point end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    BenchResult result;
+    if (activeCounters != nullptr) {
+        result.counters = activeCounters->stop();
+    }
+    result.allocationsCounted = allocationCountingActive.load(std::memory_order_relaxed);
+    result.allocations = allocationCalls.load(std::memory_order_relaxed) - allocationsBefore;
+    result.name = name;
+    result.scale = scale;
+    result.iterations = iterations;
+    result.opsPerIteration = opsPerIteration;
+    if (samples.empty()) {
+        return result;
+    }
+
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    result.meanNs = total / samples.size();
+    result.medianNs = samples[samples.size() / 2];
+    result.p90Ns = samples[(samples.size() * 9) / 10];
+    result.minNs = samples.front();
+    result.maxNs = samples.back();
+    return result;
+}
+
+inline void writeJson(std::ostream& out, const BenchResult& result) {
+    out << "{\"name\":\"" << result.name << "\""
+        << ",\"scale\":" << result.scale
+        << ",\"iterations\":" << result.iterations
+        << ",\"opsPerIteration\":" << result.opsPerIteration
+        << ",\"meanNs\":" << result.meanNs
+        << ",\"medianNs\":" << result.medianNs
+        << ",\"p90Ns\":" << result.p90Ns
+        << ",\"minNs\":" << result.minNs
+        << ",\"maxNs\":" << result.maxNs
+        << ",\"nsPerOp\":" << (result.medianNs / result.opsPerIteration);
+
+    // Batch cases time opsPerIteration operations per iteration
+    const double ops = static_cast<double>(result.iterations) * result.opsPerIteration;
+
+    if (result.allocationsCounted && ops > 0.0) {
+        out << ",\"allocsPerOp\":" << static_cast<double>(result.allocations) / ops;
+    }
+
+    // Throughput at the median iteration time (bytes per ns * 1000 = MB/s)
+    if (result.bytesPerIteration > 0 && result.medianNs > 0.0) {
+        out << ",\"bytesPerIteration\":" << result.bytesPerIteration
+            << ",\"mbPerSecond\":" << result.bytesPerIteration * 1000.0 / result.medianNs;
+    }
+    if (result.structureBytes > 0) {
+        out << ",\"structureBytes\":" << result.structureBytes;
+    }
+
+    // Per-operation counter averages; null where a counter is unavailable
+    if (result.counters.any() && ops > 0.0) {
+        const CounterSample& counters = result.counters;
+        out << ",\"counters\":{";
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            out << (i > 0 ? "," : "") << "\"" << counterName(i) << "\":";
+            if (counters.available[i]) {
+                out << counters.values[i] / ops;
+            } else {
+                out << "null";
+            }
+        }
+        if (counters.available[COUNTER_CYCLES] && counters.available[COUNTER_INSTRUCTIONS] &&
+            counters.values[COUNTER_CYCLES] > 0.0) {
+            out << ",\"ipc\":" << counters.values[COUNTER_INSTRUCTIONS] / counters.values[COUNTER_CYCLES];
+        }
+        out << "}";
+    }
+    out << "}";
+}
+
+} // namespace Bench
+} // namespace RideSharing
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,633 @@
+/**
+ * core_bench.cpp
+ *
+ * Native benchmarks for the routing and matching core, linked against the
+ * same uber_mini_core library as the addon and the dispatch server, so C++
+ * performance can be measured without going through Node.js
+ *
+ * Cases (each run on generated cities of every requested size):
+ *   graph.generate, graph.build, graph.components, dijkstra.oneToAll, dijkstra.pointToPoint,
+ *   dijkstra.batch.serial, dijkstra.batch.parallel, dijkstra.batch.hotspot,
+ *   routing.build.{float,uint32,double} (structureBytes = CSR size),
+ *   routing.{float,uint32,double}.pointToPoint, geo.haversine.{scalar,batch},
+ *   tiles.build, tiles.overview, tiles.detail (tile cases report bytesPerIteration),
+ *   minheap.ops, hashmap.{int,string}.{std,flat}.{insert,find,churn},
+ *   apsp.build.{float,uint16} (structureBytes = table size, up to
+ *   APSP_MAX_NODES), apsp.lookup, drivers.updateById, drivers.updateBatch,
+ *   betweenness.exact.{serial,parallel} (up to BETWEENNESS_EXACT_MAX_NODES;
+ *   their ratio is the pool's speedup), betweenness.sampled,
+ *   matcher.findRide, matcher.findRide.table, matcher.processRequest, json.graph, json.graph.reuse, json.drivers,
+ *   json.rideMatch (json cases also report bytesPerIteration and MB/s)
+ *
+ * With --counters (default on) cycles, instructions, LLC misses, branch
+ * misses and page faults are sampled via perf_event_open around every case
+ * where the platform allows it, and reported per operation; allocator calls
+ * per operation are always reported (alloc_counter.cpp is linked in)
+ *
+ * Usage: uber_mini_bench [--scales 50,200,1000] [--iterations 200]
+ *                        [--seed 42] [--counters on|off] [--threads N]
+ *                        [--out results.json]
+ */
+
+#include "include/city_graph_generator.h"
+#include "include/dijkstra.h"
+#include "include/min_heap.h"
+#include "include/driver_manager.h"
+#include "include/ride_matcher.h"
+#include "include/json_writer.h"
+#include "include/flat_hash_map.h"
+#include "include/thread_pool.h"
+#include "include/routing_graph.h"
+#include "include/geo_distance.h"
+#include "include/graph_tile.h"
+#include "include/distance_table.h"
+#include "include/betweenness.h"
+#include "include/graph_components.h"
+#include "bench/bench_harness.h"
+#include "bench/perf_counters.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace RideSharing;
+using Bench::BenchResult;
+
+namespace {
+
+// Largest city the all-pairs table cases run on (6 bytes per node pair)
+const int APSP_MAX_NODES = 5000;
+
+// Largest city exact betweenness runs on (one search per node, twice)
+const int BETWEENNESS_EXACT_MAX_NODES = 5000;
+
+// Sources searched by the sampled betweenness case
+const int BETWEENNESS_SAMPLES = 64;
+
+struct BenchOptions {
+    std::vector<int> scales;
+    int iterations;
+    unsigned int seed;
+    bool useCounters;
+    size_t threads;       // Pool workers for the parallel cases (0 = one per core)
+    std::string outPath;
+
+    BenchOptions() : scales({50, 200, 1000}), iterations(200), seed(42), useCounters(true),
+                     threads(0) {}
+};
+
+std::vector<int> parseScales(const char* text) {
+    std::vector<int> scales;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = std::atoi(item.c_str());
+        if (value > 1) {
+            scales.push_back(value);
+        }
+    }
+    return scales;
+}
+
+// One driver per five nodes (at least a dozen), spread over the city
+std::vector<Driver> makeDrivers(int numNodes, std::mt19937& rng) {
+    static const char* vehicleTypes[] = {"Sedan", "SUV", "Compact"};
+    std::uniform_int_distribution<> nodeDis(0, numNodes - 1);
+
+    int count = std::max(12, numNodes / 5);
+    std::vector<Driver> drivers;
+    drivers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Driver driver("B" + std::to_string(i), "Bench Driver " + std::to_string(i),
+                      nodeDis(rng), vehicleTypes[i % 3], 4.5);
+        drivers.push_back(driver);
+    }
+    return drivers;
+}
+
+// Rebuild a graph from its columnar export: pure construction cost
+Graph* buildFromColumns(const GraphColumns& columns, int numVertices) {
+    Graph* graph = new Graph(numVertices);
+    for (size_t i = 0; i < columns.nodeIds.size(); ++i) {
+        graph->addNode(columns.nodeIds[i], columns.names[columns.nodeNameIds[i]],
+                       columns.latitudes[i], columns.longitudes[i]);
+    }
+    for (size_t i = 0; i < columns.edgeSources.size(); ++i) {
+        graph->addEdge(columns.edgeSources[i], columns.edgeTargets[i],
+                       columns.edgeWeights[i], columns.names[columns.roadNameIds[i]],
+                       static_cast<RoadClass>(columns.roadClasses[i]));
+    }
+    return graph;
+}
+
+// Insert every key into an empty map, look up every key plus as many
+// absent ones, and churn the map by erasing and reinserting half its keys
+template <typename Map, typename Key>
+void runMapCases(const std::string& prefix, int numNodes, int iterations,
+                 const std::vector<Key>& keys, const std::vector<Key>& absent,
+                 std::vector<BenchResult>& results) {
+    const long long count = static_cast<long long>(keys.size());
+
+    results.push_back(Bench::run(prefix + ".insert", numNodes, iterations, count, [&](int) {
+        Map map;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            map[keys[i]] = static_cast<int>(i);
+        }
+        Bench::doNotOptimize(static_cast<double>(map.size()));
+    }));
+
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map[keys[i]] = static_cast<int>(i);
+    }
+    results.push_back(Bench::run(prefix + ".find", numNodes, iterations, count * 2, [&](int) {
+        long long found = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            found += map.find(keys[i]) != map.end();
+            found += map.find(absent[i]) != map.end();
+        }
+        Bench::doNotOptimize(static_cast<double>(found));
+    }));
+
+    results.push_back(Bench::run(prefix + ".churn", numNodes, iterations, count, [&](int) {
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            map.erase(keys[i]);
+        }
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            map[keys[i]] = static_cast<int>(i);
+        }
+        Bench::doNotOptimize(static_cast<double>(map.size()));
+    }));
+}
+
+// Compile graph to a CSR RoutingGraph with WeightT weights, then answer the
+// same point-to-point queries as dijkstra.pointToPoint on it
+template <typename WeightT>
+void runRoutingCases(const std::string& weightName, const Graph& graph, int numNodes,
+                     int iterations, int buildIterations, double weightScale,
+                     const std::vector<int>& sources, const std::vector<int>& targets,
+                     std::vector<BenchResult>& results) {
+    typedef RoutingGraph<uint32_t, WeightT> Routing;
+
+    size_t routingBytes = 0;
+    results.push_back(Bench::run("routing.build." + weightName, numNodes, buildIterations,
+                                 static_cast<long long>(graph.getNumDirectedEdges()), [&](int) {
+        Routing built = Routing::fromGraph(graph, weightScale);
+        routingBytes = built.memoryBytes();
+        Bench::doNotOptimize(static_cast<double>(built.numEdges()));
+    }));
+    results.back().structureBytes = static_cast<long long>(routingBytes);
+
+    Routing routing = Routing::fromGraph(graph, weightScale);
+    RoutingSearch<uint32_t, WeightT> search(routing);
+    std::vector<uint32_t> path;
+    results.push_back(Bench::run("routing." + weightName + ".pointToPoint", numNodes, iterations, 1,
+                                 [&](int i) {
+        typename Routing::Distance distance = 0;
+        search.route(static_cast<uint32_t>(sources[i]), static_cast<uint32_t>(targets[i]),
+                     distance, &path);
+        Bench::doNotOptimize(routing.toGraphUnits(distance));
+    }));
+}
+
+void runScale(int numNodes, const BenchOptions& options, ThreadPool& pool,
+              std::vector<BenchResult>& results) {
+    const int iterations = options.iterations;
+    std::mt19937 rng(options.seed + numNodes);
+    std::uniform_int_distribution<> nodeDis(0, numNodes - 1);
+
+    // Random endpoints shared by the routing cases
+    std::vector<int> sources(iterations);
+    std::vector<int> targets(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        sources[i] = nodeDis(rng);
+        targets[i] = nodeDis(rng);
+    }
+
+    CityGraphGenerator::seed(options.seed);
+    std::unique_ptr<CityData> city(CityGraphGenerator::generateCityGraph(numNodes));
+    const Graph& graph = *city->graph;
+    GraphColumns columns = graph.exportColumns();
+
+    // Generation and findRide (one Dijkstra per available driver) grow
+    // super-linearly; cap their iteration count at large scales
+    int heavyIterations = std::max(3, std::min(iterations, 20000 / numNodes));
+    results.push_back(Bench::run("graph.generate", numNodes, heavyIterations, 1, [&](int) {
+        std::unique_ptr<CityData> generated(CityGraphGenerator::generateCityGraph(numNodes));
+        Bench::doNotOptimize(generated->graph->getNumVertices());
+    }));
+
+    results.push_back(Bench::run("graph.build", numNodes, heavyIterations,
+                                 static_cast<long long>(columns.edgeSources.size()), [&](int) {
+        std::unique_ptr<Graph> built(buildFromColumns(columns, numNodes));
+        Bench::doNotOptimize(built->getNumVertices());
+    }));
+
+    // Labelling runs again after every edit, so its cost bounds edit rates
+    results.push_back(Bench::run("graph.components", numNodes, heavyIterations,
+                                 static_cast<long long>(numNodes), [&](int) {
+        ComponentLabels labels = ComponentLabels::compute(graph);
+        Bench::doNotOptimize(labels.getNumStrongComponents());
+    }));
+
+    results.push_back(Bench::run("dijkstra.oneToAll", numNodes, iterations, 1, [&](int i) {
+        Dijkstra dijkstra(graph);
+        DijkstraResult result = dijkstra.findShortestPaths(sources[i]);
+        Bench::doNotOptimize(result.distances[targets[i]]);
+    }));
+
+    results.push_back(Bench::run("dijkstra.pointToPoint", numNodes, iterations, 1, [&](int i) {
+        Dijkstra dijkstra(graph);
+        PathResult result = dijkstra.findShortestPath(sources[i], targets[i]);
+        Bench::doNotOptimize(result.totalDistance);
+    }));
+
+    // Integer weights are stored in hundredths of a graph weight unit
+    runRoutingCases<float>("float", graph, numNodes, iterations, heavyIterations, 1.0,
+                           sources, targets, results);
+    runRoutingCases<uint32_t>("uint32", graph, numNodes, iterations, heavyIterations, 100.0,
+                              sources, targets, results);
+    runRoutingCases<double>("double", graph, numNodes, iterations, heavyIterations, 1.0,
+                            sources, targets, results);
+
+    // A batch of point-to-point queries, one after another vs spread over
+    // the work-stealing pool
+    const size_t batchSize = std::min<size_t>(64, sources.size());
+    std::vector<double> batchDistances(batchSize);
+    results.push_back(Bench::run("dijkstra.batch.serial", numNodes, heavyIterations,
+                                 static_cast<long long>(batchSize), [&](int) {
+        Dijkstra dijkstra(graph, std::pmr::get_default_resource(), false);
+        std::pmr::vector<int> path;
+        for (size_t i = 0; i < batchSize; ++i) {
+            double distance = 0.0;
+            dijkstra.findRoute(sources[i], targets[i], distance, path);
+            batchDistances[i] = distance;
+        }
+        Bench::doNotOptimize(batchDistances[0]);
+    }));
+
+    results.push_back(Bench::run("dijkstra.batch.parallel", numNodes, heavyIterations,
+                                 static_cast<long long>(batchSize), [&](int) {
+        Dijkstra::findRouteDistances(graph, sources.data(), targets.data(), batchSize,
+                                     batchDistances.data(), pool);
+        Bench::doNotOptimize(batchDistances[0]);
+    }));
+
+    // The same batch size where every query is one trip, as in a burst from
+    // one venue; workers searching it at the same time share a search
+    std::vector<int> hotspotSources(batchSize, sources[0]);
+    std::vector<int> hotspotTargets(batchSize, targets[0]);
+    results.push_back(Bench::run("dijkstra.batch.hotspot", numNodes, heavyIterations,
+                                 static_cast<long long>(batchSize), [&](int) {
+        Dijkstra::findRouteDistances(graph, hotspotSources.data(), hotspotTargets.data(), batchSize,
+                                     batchDistances.data(), pool);
+        Bench::doNotOptimize(batchDistances[0]);
+    }));
+
+    // Straight-line distance from one node to every node: the scalar
+    // generator formula vs the SoA batch kernel (both over plain arrays)
+    GeoPoints geoPoints = GeoPoints::fromGraph(graph);
+    std::vector<double> nodeLatitudes(numNodes);
+    std::vector<double> nodeLongitudes(numNodes);
+    for (int v = 0; v < numNodes; ++v) {
+        nodeLatitudes[v] = graph.getNode(v).latitude;
+        nodeLongitudes[v] = graph.getNode(v).longitude;
+    }
+    std::vector<double> geoDistances(numNodes);
+    results.push_back(Bench::run("geo.haversine.scalar", numNodes, iterations, numNodes, [&](int i) {
+        double latitude = nodeLatitudes[sources[i]];
+        double longitude = nodeLongitudes[sources[i]];
+        for (int v = 0; v < numNodes; ++v) {
+            geoDistances[v] = CityGraphGenerator::calculateDistance(latitude, longitude,
+                                                                    nodeLatitudes[v], nodeLongitudes[v]);
+        }
+        Bench::doNotOptimize(geoDistances[targets[i]]);
+    }));
+
+    results.push_back(Bench::run("geo.haversine.batch", numNodes, iterations, numNodes, [&](int i) {
+        GeoDistance::haversineBatch(nodeLatitudes[sources[i]], nodeLongitudes[sources[i]], geoPoints,
+                                    geoDistances.data());
+        Bench::doNotOptimize(geoDistances[targets[i]]);
+    }));
+
+    // Road tiles: the whole city zoomed out (major roads, merged lines) and
+    // a small box around a node at street level
+    results.push_back(Bench::run("tiles.build", numNodes, heavyIterations,
+                                 static_cast<long long>(columns.edgeSources.size()), [&](int) {
+        GraphTileIndex built(graph);
+        Bench::doNotOptimize(static_cast<double>(built.edgeCount()));
+    }));
+
+    GraphTileIndex tileIndex(graph);
+    size_t tileBytes = 0;
+    results.push_back(Bench::run("tiles.overview", numNodes, iterations, 1, [&](int) {
+        std::vector<uint8_t> tile = tileIndex.encodeTile(tileIndex.getBounds(), 8);
+        tileBytes = tile.size();
+    }));
+    results.back().bytesPerIteration = static_cast<long long>(tileBytes);
+
+    results.push_back(Bench::run("tiles.detail", numNodes, iterations, 1, [&](int i) {
+        const Node& center = graph.getNode(sources[i]);
+        GeoBounds box(center.latitude - 0.01, center.longitude - 0.01,
+                      center.latitude + 0.01, center.longitude + 0.01);
+        std::vector<uint8_t> tile = tileIndex.encodeTile(box, 14);
+        tileBytes = tile.size();
+    }));
+    results.back().bytesPerIteration = static_cast<long long>(tileBytes);
+
+    // Insert every vertex, decrease half the keys, then drain the heap
+    std::vector<double> keys(numNodes);
+    std::uniform_real_distribution<> keyDis(0.0, 1000.0);
+    for (double& key : keys) {
+        key = keyDis(rng);
+    }
+    results.push_back(Bench::run("minheap.ops", numNodes, iterations,
+                                 numNodes * 2 + numNodes / 2, [&](int) {
+        MinHeap heap;
+        for (int v = 0; v < numNodes; ++v) {
+            heap.insert(v, keys[v]);
+        }
+        for (int v = 0; v < numNodes; v += 2) {
+            heap.decreaseKey(v, keys[v] * 0.5);
+        }
+        double last = 0.0;
+        while (!heap.isEmpty()) {
+            last = heap.extractMin().distance;
+        }
+        Bench::doNotOptimize(last);
+    }));
+
+    // Lookup tables: vertex IDs (Graph::nodes, MinHeap positions) and
+    // driver IDs (DriverManager index), std::unordered_map vs FlatHashMap
+    std::vector<int> vertexKeys(numNodes);
+    std::vector<int> absentVertices(numNodes);
+    std::vector<std::string> driverKeys(numNodes);
+    std::vector<std::string> absentDrivers(numNodes);
+    for (int v = 0; v < numNodes; ++v) {
+        vertexKeys[v] = v;
+        absentVertices[v] = numNodes + v;
+        driverKeys[v] = "B" + std::to_string(v);
+        absentDrivers[v] = "X" + std::to_string(v);
+    }
+    std::shuffle(vertexKeys.begin(), vertexKeys.end(), rng);
+    runMapCases<std::unordered_map<int, int>>("hashmap.int.std", numNodes, iterations,
+                                              vertexKeys, absentVertices, results);
+    runMapCases<FlatHashMap<int, int>>("hashmap.int.flat", numNodes, iterations,
+                                       vertexKeys, absentVertices, results);
+    runMapCases<std::unordered_map<std::string, int>>("hashmap.string.std", numNodes, iterations,
+                                                      driverKeys, absentDrivers, results);
+    runMapCases<FlatHashMap<std::string, int>>("hashmap.string.flat", numNodes, iterations,
+                                               driverKeys, absentDrivers, results);
+
+    // Driver location updates: by string id vs the batch handle path
+    std::vector<Driver> drivers = makeDrivers(numNodes, rng);
+    DriverManager manager;
+    std::vector<int> handles = manager.addDrivers(drivers);
+    std::vector<int> locations(handles.size());
+    const long long driverCount = static_cast<long long>(drivers.size());
+
+    results.push_back(Bench::run("drivers.updateById", numNodes, iterations, driverCount, [&](int i) {
+        for (size_t d = 0; d < drivers.size(); ++d) {
+            manager.updateDriverLocation(drivers[d].id, (sources[i] + static_cast<int>(d)) % numNodes);
+        }
+        manager.clearLogs();
+    }));
+
+    results.push_back(Bench::run("drivers.updateBatch", numNodes, iterations, driverCount, [&](int i) {
+        for (size_t d = 0; d < locations.size(); ++d) {
+            locations[d] = (targets[i] + static_cast<int>(d)) % numNodes;
+        }
+        Bench::doNotOptimize(manager.updateDriverLocations(handles.data(), locations.data(),
+                                                           handles.size(), numNodes));
+        manager.clearLogs();
+    }));
+
+    // findRide marks the matched driver busy; free it again so the fleet
+    // stays the same size across iterations
+    RideMatcher matcher(&graph);
+    matcher.addDrivers(drivers);
+    results.push_back(Bench::run("matcher.findRide", numNodes, heavyIterations, 1, [&](int i) {
+        RideRequest request("", sources[i], targets[i], "P" + std::to_string(i));
+        RideMatch match = matcher.findRide(request);
+        if (match.success) {
+            matcher.setDriverAvailability(match.driver.id, true);
+        }
+        matcher.clearLogs();
+        Bench::doNotOptimize(match.totalDistance);
+    }));
+
+    results.push_back(Bench::run("matcher.processRequest", numNodes, heavyIterations, 1, [&](int i) {
+        RideMatchResult result = matcher.processRequest(
+            RideRequest("R" + std::to_string(i), sources[i], targets[i], "P"));
+        if (result.success) {
+            matcher.setDriverAvailability(result.assignedDriver.id, true);
+        }
+        matcher.clearLogs();
+        Bench::doNotOptimize(result.totalDistance);
+    }));
+
+    // All-pairs table: build cost and size, lookups, and matching with the
+    // table in place of the per-driver searches (small and medium cities)
+    if (numNodes <= APSP_MAX_NODES) {
+        const int apspIterations = std::max(1, heavyIterations / 10);
+        std::shared_ptr<const DistanceTable> table;
+        results.push_back(Bench::run("apsp.build.float", numNodes, apspIterations,
+                                     static_cast<long long>(numNodes), [&](int) {
+            table = DistanceTable::build(graph, DistanceTable::Precision::Float32, pool);
+        }));
+        results.back().structureBytes = static_cast<long long>(table->sizeBytes());
+
+        std::shared_ptr<const DistanceTable> quantised;
+        results.push_back(Bench::run("apsp.build.uint16", numNodes, apspIterations,
+                                     static_cast<long long>(numNodes), [&](int) {
+            quantised = DistanceTable::build(graph, DistanceTable::Precision::UInt16, pool);
+        }));
+        results.back().structureBytes = static_cast<long long>(quantised->sizeBytes());
+
+        results.push_back(Bench::run("apsp.lookup", numNodes, iterations, 1, [&](int i) {
+            Bench::doNotOptimize(table->distance(sources[i], targets[i]));
+        }));
+
+        RideMatcher tableMatcher(&graph);
+        tableMatcher.addDrivers(drivers);
+        tableMatcher.setDistanceTable(table);
+        results.push_back(Bench::run("matcher.findRide.table", numNodes, iterations, 1, [&](int i) {
+            RideRequest request("", sources[i], targets[i], "P" + std::to_string(i));
+            RideMatch match = tableMatcher.findRide(request);
+            if (match.success) {
+                tableMatcher.setDriverAvailability(match.driver.id, true);
+            }
+            tableMatcher.clearLogs();
+            Bench::doNotOptimize(match.totalDistance);
+        }));
+    }
+
+    // Betweenness: one search per source, so ops are sources searched
+    if (numNodes <= BETWEENNESS_EXACT_MAX_NODES) {
+        const int exactIterations = std::max(1, heavyIterations / 10);
+        BetweennessOptions exact;
+        results.push_back(Bench::run("betweenness.exact.serial", numNodes, exactIterations,
+                                     static_cast<long long>(numNodes), [&](int) {
+            Bench::doNotOptimize(Betweenness::compute(graph, exact).nodeScores[0]);
+        }));
+        results.push_back(Bench::run("betweenness.exact.parallel", numNodes, exactIterations,
+                                     static_cast<long long>(numNodes), [&](int) {
+            Bench::doNotOptimize(Betweenness::compute(graph, exact, pool).nodeScores[0]);
+        }));
+    }
+
+    BetweennessOptions sampled;
+    sampled.samples = std::min(numNodes, BETWEENNESS_SAMPLES);
+    results.push_back(Bench::run("betweenness.sampled", numNodes, heavyIterations,
+                                 static_cast<long long>(sampled.samples), [&](int i) {
+        sampled.seed = static_cast<unsigned int>(i + 1);
+        Bench::doNotOptimize(Betweenness::compute(graph, sampled, pool).nodeScores[0]);
+    }));
+
+    // Fresh-string serialization (what toJSON callers pay) and serialization
+    // into a reused buffer (what the native server's response path pays)
+    long long graphBytes = static_cast<long long>(graph.toJSON().size());
+    results.push_back(Bench::run("json.graph", numNodes, iterations, 1, [&](int) {
+        Bench::doNotOptimize(static_cast<double>(graph.toJSON().size()));
+    }));
+    results.back().bytesPerIteration = graphBytes;
+
+    std::string buffer;
+    results.push_back(Bench::run("json.graph.reuse", numNodes, iterations, 1, [&](int) {
+        buffer.clear();
+        JsonWriter writer(buffer);
+        graph.writeJSON(writer);
+        Bench::doNotOptimize(static_cast<double>(buffer.size()));
+    }));
+    results.back().bytesPerIteration = graphBytes;
+
+    long long driverBytes = static_cast<long long>(manager.toJSON().size());
+    results.push_back(Bench::run("json.drivers", numNodes, iterations, driverCount, [&](int) {
+        Bench::doNotOptimize(static_cast<double>(manager.toJSON().size()));
+    }));
+    results.back().bytesPerIteration = driverBytes;
+
+    RideMatchResult matchResult;
+    for (int i = 0; i < iterations && !matchResult.success; ++i) {
+        matchResult = matcher.processRequest(RideRequest("R" + std::to_string(i),
+                                                         sources[i], targets[i], "P"));
+    }
+    long long matchBytes = static_cast<long long>(matchResult.toJSON().size());
+    results.push_back(Bench::run("json.rideMatch", numNodes, iterations, 1, [&](int) {
+        Bench::doNotOptimize(static_cast<double>(matchResult.toJSON().size()));
+    }));
+    results.back().bytesPerIteration = matchBytes;
+}
+
+void writeReport(std::ostream& out, const BenchOptions& options,
+                 const Bench::PerfCounters* counters, const ThreadPool& pool,
+                 const std::vector<BenchResult>& results) {
+    out << std::fixed << std::setprecision(1);
+    out << "{\"benchmark\":\"uber_mini_core\""
+        << ",\"timestamp\":" << static_cast<long long>(std::time(nullptr))
+        << ",\"seed\":" << options.seed
+        << ",\"iterations\":" << options.iterations;
+
+    // Per-worker share of the run spent in tasks (parallel cases only)
+    ThreadPoolStats poolStats = pool.stats();
+    out << ",\"threadPool\":{\"workers\":" << poolStats.workerCount
+        << ",\"tasksRunByCallers\":" << poolStats.tasksRunByCallers << ",\"perWorker\":[";
+    for (size_t i = 0; i < poolStats.workers.size(); ++i) {
+        const WorkerStats& worker = poolStats.workers[i];
+        out << (i > 0 ? "," : "") << "{\"tasksExecuted\":" << worker.tasksExecuted
+            << ",\"tasksStolen\":" << worker.tasksStolen
+            << ",\"busyMs\":" << worker.busyNanoseconds / 1e6 << "}";
+    }
+    out << "]}";
+
+    out << ",\"perfCounters\":{\"enabled\":" << (counters != nullptr ? "true" : "false")
+        << ",\"available\":[";
+    bool first = true;
+    for (int i = 0; counters != nullptr && i < Bench::COUNTER_COUNT; ++i) {
+        if (!counters->isOpen(i)) continue;
+        out << (first ? "" : ",") << "\"" << Bench::counterName(i) << "\"";
+        first = false;
+    }
+    out << "]";
+    if (counters != nullptr && !counters->reason().empty()) {
+        out << ",\"unavailableReason\":\"" << counters->reason() << "\"";
+    }
+    out << "}";
+
+    out << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0) out << ",";
+        out << "\n  ";
+        Bench::writeJson(out, results[i]);
+    }
+    out << "\n]}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--scales") == 0) {
+            options.scales = parseScales(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0) {
+            options.iterations = std::max(1, std::atoi(argv[i + 1]));
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            options.useCounters = std::strcmp(argv[i + 1], "off") != 0;
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            options.threads = static_cast<size_t>(std::max(0, std::atoi(argv[i + 1])));
+        } else if (std::strcmp(argv[i], "--out") == 0) {
+            options.outPath = argv[i + 1];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--scales N,N,...] [--iterations N] [--seed N] [--counters on|off]"
+                      << " [--threads N] [--out FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Counters are optional: fall back to wall time only when none open.
+    // They are opened before the pool so its workers inherit them
+    std::unique_ptr<Bench::PerfCounters> counters;
+    if (options.useCounters) {
+        counters.reset(new Bench::PerfCounters());
+        if (!counters->reason().empty()) {
+            std::cerr << "Some hardware counters are unavailable (" << counters->reason() << ")"
+                      << std::endl;
+        }
+    }
+    Bench::setCounters(counters && counters->anyOpen() ? counters.get() : nullptr);
+
+    ThreadPool pool(options.threads);
+    std::vector<BenchResult> results;
+    for (int scale : options.scales) {
+        std::cerr << "Benchmarking " << scale << " nodes..." << std::endl;
+        runScale(scale, options, pool, results);
+    }
+
+    if (options.outPath.empty()) {
+        writeReport(std::cout, options, counters.get(), pool, results);
+        return 0;
+    }
+
+    std::ofstream file(options.outPath);
+    if (!file) {
+        std::cerr << "Cannot write " << options.outPath << std::endl;
+        return 1;
+    }
+    writeReport(file, options, counters.get(), pool, results);
+    std::cerr << "Wrote " << results.size() << " results to " << options.outPath << std::endl;
+    return 0;
+}
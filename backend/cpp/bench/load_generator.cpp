@@ -0,0 +1,530 @@
+/**
+ * load_generator.cpp
+ *
+ * End-to-end load generator for RideMatcher, driven in-process on a
+ * generated city (the same single-threaded model as the Node.js server
+ * and the native dispatch server)
+ *
+ * Modes:
+ *   open   - requests arrive on a fixed schedule (--rate per second,
+ *            uniform or Poisson); latency is measured from the intended
+ *            arrival time, so queueing behind a slow request is counted
+ *   closed - one client issues the next request when the previous one
+ *            completes (plus optional think time); latency is corrected
+ *            for coordinated omission by back-filling the samples a
+ *            steady client would have recorded during each stall
+ *
+ * The request mix combines findRide, batched driver location updates and
+ * trip completions (which free the oldest busy driver). Throughput and
+ * p50/p90/p99/p999 latency are written as JSON.
+ *
+ * Usage: uber_mini_loadgen [--mode open|closed] [--rate 200] [--duration 10]
+ *                          [--arrivals uniform|poisson] [--think-us 0]
+ *                          [--nodes 50] [--drivers 12]
+ *                          [--mix find=35,update=30,complete=35]
+ *                          [--update-batch 16] [--warmup 50] [--seed 42]
+ *                          [--out results.json] [--trace trace.json]
+ */
+
+#include "include/city_graph_generator.h"
+#include "include/ride_matcher.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RideSharing;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum OperationType { OP_FIND = 0, OP_UPDATE = 1, OP_COMPLETE = 2, OP_COUNT = 3 };
+
+const char* const OPERATION_NAMES[OP_COUNT] = {"find", "update", "complete"};
+
+struct LoadOptions {
+    bool openLoop;
+    bool poissonArrivals;
+    double rate;              // Requests per second (open loop)
+    double durationSec;
+    double thinkUs;           // Pause between requests (closed loop)
+    int numNodes;
+    int numDrivers;
+    double mix[OP_COUNT];     // Relative weights of each operation
+    int updateBatch;          // Drivers moved per update operation
+    int warmup;               // Requests run before measuring
+    unsigned int seed;
+    std::string outPath;
+    std::string tracePath;    // Chrome trace of the measured run
+
+    LoadOptions()
+        : openLoop(true), poissonArrivals(false), rate(200.0), durationSec(10.0),
+          thinkUs(0.0), numNodes(50), numDrivers(12), updateBatch(16), warmup(50),
+          seed(42) {
+        mix[OP_FIND] = 35.0;
+        mix[OP_UPDATE] = 30.0;
+        mix[OP_COMPLETE] = 35.0;
+    }
+};
+
+// Latency samples in microseconds with nearest-rank percentiles
+class LatencySamples {
+private:
+    std::vector<double> samples;
+    bool sorted;
+
+public:
+    LatencySamples() : sorted(true) {}
+
+    void record(double us) {
+        samples.push_back(us);
+        sorted = false;
+    }
+
+    /**
+     * Record a sample taken by a client that expected to issue a request
+     * every intervalUs: a stall of L also hides the requests that would
+     * have waited L - interval, L - 2*interval, ... behind it
+     */
+    void recordCorrected(double us, double intervalUs) {
+        record(us);
+        if (intervalUs <= 0.0) return;
+        for (double missed = us - intervalUs; missed >= intervalUs; missed -= intervalUs) {
+            record(missed);
+        }
+    }
+
+    size_t count() const { return samples.size(); }
+
+    double percentile(double p) {
+        if (samples.empty()) return 0.0;
+        if (!sorted) {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+        size_t rank = static_cast<size_t>(p / 100.0 * samples.size());
+        return samples[std::min(rank, samples.size() - 1)];
+    }
+
+    double mean() const {
+        if (samples.empty()) return 0.0;
+        double total = 0.0;
+        for (double sample : samples) total += sample;
+        return total / samples.size();
+    }
+
+    void writeJson(std::ostream& out) {
+        out << "{\"count\":" << count()
+            << ",\"mean\":" << mean()
+            << ",\"p50\":" << percentile(50.0)
+            << ",\"p90\":" << percentile(90.0)
+            << ",\"p99\":" << percentile(99.0)
+            << ",\"p999\":" << percentile(99.9)
+            << ",\"max\":" << percentile(100.0)
+            << "}";
+    }
+};
+
+// Per-operation counters and service-time samples
+struct OperationStats {
+    long long count;
+    long long failures;       // findRide without a match, empty completions
+    LatencySamples serviceUs;
+
+    OperationStats() : count(0), failures(0) {}
+};
+
+bool parseMix(const char* text, double mix[OP_COUNT]) {
+    for (int op = 0; op < OP_COUNT; ++op) mix[op] = 0.0;
+
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        double weight = std::atof(item.c_str() + eq + 1);
+
+        int op = 0;
+        while (op < OP_COUNT && name != OPERATION_NAMES[op]) ++op;
+        if (op == OP_COUNT || weight < 0.0) return false;
+        mix[op] = weight;
+    }
+    return mix[OP_FIND] + mix[OP_UPDATE] + mix[OP_COMPLETE] > 0.0;
+}
+
+// Fleet of synthetic drivers spread uniformly over the city
+std::vector<Driver> makeFleet(int count, int numNodes, std::mt19937& rng) {
+    static const char* vehicleTypes[] = {"Sedan", "SUV", "Compact"};
+    std::uniform_int_distribution<> nodeDis(0, numNodes - 1);
+
+    std::vector<Driver> fleet;
+    fleet.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        fleet.push_back(Driver("L" + std::to_string(i), "Load Driver " + std::to_string(i),
+                               nodeDis(rng), vehicleTypes[i % 3], 4.5));
+    }
+    return fleet;
+}
+
+class LoadDriver {
+private:
+    const LoadOptions& options;
+    RideMatcher& matcher;
+    std::vector<int> handles;
+    std::mt19937 rng;
+    std::uniform_int_distribution<> nodeDis;
+    std::uniform_int_distribution<> driverDis;
+    std::discrete_distribution<> opDis;
+
+    // Matched trips waiting to complete: driver handle and drop-off node
+    std::deque<std::pair<int, int>> activeTrips;
+    std::vector<int> batchHandles;
+    std::vector<int> batchLocations;
+    long long passengerCounter;
+
+public:
+    OperationStats operations[OP_COUNT];
+
+    LoadDriver(const LoadOptions& opts, RideMatcher& rideMatcher, const std::vector<int>& fleetHandles)
+        : options(opts), matcher(rideMatcher), handles(fleetHandles), rng(opts.seed),
+          nodeDis(0, opts.numNodes - 1),
+          driverDis(0, static_cast<int>(fleetHandles.size()) - 1),
+          opDis(opts.mix, opts.mix + OP_COUNT),
+          batchHandles(opts.updateBatch), batchLocations(opts.updateBatch),
+          passengerCounter(0) {}
+
+    OperationType nextOperation() { return static_cast<OperationType>(opDis(rng)); }
+
+    // Execute one operation; returns false when it had nothing to do
+    bool execute(OperationType op) {
+        TRACE_SPAN("loadgen", OPERATION_NAMES[op]);
+        switch (op) {
+            case OP_FIND: {
+                int pickup = nodeDis(rng);
+                int destination = nodeDis(rng);
+                while (destination == pickup) destination = nodeDis(rng);
+
+                RideRequest request("", pickup, destination, "P" + std::to_string(passengerCounter++));
+                RideMatch match = matcher.findRide(request);
+                if (!match.success) return false;
+                activeTrips.push_back(std::make_pair(matcher.getDriverHandle(match.driver.id), destination));
+                return true;
+            }
+            case OP_UPDATE: {
+                for (int i = 0; i < options.updateBatch; ++i) {
+                    batchHandles[i] = handles[driverDis(rng)];
+                    batchLocations[i] = nodeDis(rng);
+                }
+                return matcher.updateDriverLocations(batchHandles.data(), batchLocations.data(),
+                                                     batchHandles.size()) > 0;
+            }
+            case OP_COMPLETE: {
+                if (activeTrips.empty()) return false;
+                std::pair<int, int> trip = activeTrips.front();
+                activeTrips.pop_front();
+
+                const uint8_t available = 1;
+                matcher.updateDriverLocations(&trip.first, &trip.second, 1);
+                return matcher.setDriverAvailabilities(&trip.first, &available, 1) == 1;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Logs grow with every request; drop them between requests (untimed)
+    void trimLogs() { matcher.clearLogs(); }
+};
+
+double elapsedUs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+// Sleep most of the way to the deadline, then spin for precision
+void waitUntil(Clock::time_point deadline) {
+    const auto spinWindow = std::chrono::microseconds(200);
+    Clock::time_point now = Clock::now();
+    if (deadline - now > spinWindow) {
+        std::this_thread::sleep_until(deadline - spinWindow);
+    }
+    while (Clock::now() < deadline) {
+    }
+}
+
+struct RunSummary {
+    long long requests;
+    double wallSec;
+    double maxScheduleLagUs;  // Open loop: worst delay behind the schedule
+    LatencySamples latencyUs;
+    LatencySamples serviceUs;
+
+    RunSummary() : requests(0), wallSec(0.0), maxScheduleLagUs(0.0) {}
+};
+
+void runOpenLoop(const LoadOptions& options, LoadDriver& load, RunSummary& summary) {
+    std::mt19937 arrivalRng(options.seed ^ 0x9e3779b9u);
+    std::exponential_distribution<> gapDis(options.rate);
+
+    const long long total = static_cast<long long>(options.rate * options.durationSec);
+    const double meanGapUs = 1e6 / options.rate;
+    double offsetUs = 0.0;
+
+    Clock::time_point start = Clock::now();
+    for (long long i = 0; i < total; ++i) {
+        Clock::time_point intended = start + std::chrono::nanoseconds(static_cast<long long>(offsetUs * 1000.0));
+        offsetUs += options.poissonArrivals ? gapDis(arrivalRng) * 1e6 : meanGapUs;
+
+        waitUntil(intended);
+        OperationType op = load.nextOperation();
+        Clock::time_point begin = Clock::now();
+        bool ok = load.execute(op);
+        Clock::time_point end = Clock::now();
+
+        double service = elapsedUs(begin, end);
+        double latency = elapsedUs(intended, end);
+        summary.maxScheduleLagUs = std::max(summary.maxScheduleLagUs, elapsedUs(intended, begin));
+        summary.latencyUs.record(latency);
+        summary.serviceUs.record(service);
+        load.operations[op].count++;
+        load.operations[op].serviceUs.record(service);
+        if (!ok) load.operations[op].failures++;
+        summary.requests++;
+
+        load.trimLogs();
+    }
+    summary.wallSec = elapsedUs(start, Clock::now()) / 1e6;
+}
+
+void runClosedLoop(const LoadOptions& options, LoadDriver& load, RunSummary& summary) {
+    std::vector<double> rawLatency;
+    Clock::time_point start = Clock::now();
+    Clock::time_point stop = start + std::chrono::microseconds(static_cast<long long>(options.durationSec * 1e6));
+
+    while (Clock::now() < stop) {
+        OperationType op = load.nextOperation();
+        Clock::time_point begin = Clock::now();
+        bool ok = load.execute(op);
+        Clock::time_point end = Clock::now();
+
+        double service = elapsedUs(begin, end);
+        rawLatency.push_back(service);
+        summary.serviceUs.record(service);
+        load.operations[op].count++;
+        load.operations[op].serviceUs.record(service);
+        if (!ok) load.operations[op].failures++;
+        summary.requests++;
+
+        load.trimLogs();
+        if (options.thinkUs > 0.0) {
+            waitUntil(end + std::chrono::microseconds(static_cast<long long>(options.thinkUs)));
+        }
+    }
+    summary.wallSec = elapsedUs(start, Clock::now()) / 1e6;
+
+    // The client's nominal cycle is think time plus the mean service time
+    double intervalUs = options.thinkUs + summary.serviceUs.mean();
+    for (double latency : rawLatency) {
+        summary.latencyUs.recordCorrected(latency, intervalUs);
+    }
+}
+
+void writeReport(std::ostream& out, const LoadOptions& options, RideMatcher& matcher,
+                 LoadDriver& load, RunSummary& summary) {
+    MatcherStats stats = matcher.getStats();
+
+    out << std::fixed << std::setprecision(1);
+    out << "{\"tool\":\"uber_mini_loadgen\""
+        << ",\"target\":\"native\""
+        << ",\"mode\":\"" << (options.openLoop ? "open" : "closed") << "\"";
+    if (options.openLoop) {
+        out << ",\"arrivals\":\"" << (options.poissonArrivals ? "poisson" : "uniform") << "\""
+            << ",\"targetRate\":" << options.rate;
+    } else {
+        out << ",\"thinkUs\":" << options.thinkUs;
+    }
+    out << ",\"nodes\":" << options.numNodes
+        << ",\"drivers\":" << options.numDrivers
+        << ",\"seed\":" << options.seed
+        << ",\"requests\":" << summary.requests
+        << ",\"wallSec\":" << summary.wallSec
+        << ",\"throughput\":" << (summary.wallSec > 0.0 ? summary.requests / summary.wallSec : 0.0);
+    if (options.openLoop) {
+        out << ",\"maxScheduleLagUs\":" << summary.maxScheduleLagUs;
+    }
+    out << ",\"latencyUs\":";
+    summary.latencyUs.writeJson(out);
+    out << ",\"serviceUs\":";
+    summary.serviceUs.writeJson(out);
+
+    out << ",\"operations\":{";
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (op > 0) out << ",";
+        out << "\"" << OPERATION_NAMES[op] << "\":{\"count\":" << load.operations[op].count
+            << ",\"failures\":" << load.operations[op].failures
+            << ",\"serviceUs\":";
+        load.operations[op].serviceUs.writeJson(out);
+        out << "}";
+    }
+    out << "}"
+        << ",\"matcher\":{\"successfulMatches\":" << stats.successfulMatches
+        << ",\"failedMatches\":" << stats.failedMatches
+        << ",\"availableDrivers\":" << stats.fleet.availableDrivers
+        << "}}\n";
+}
+
+// Every option takes a value
+bool isKnownOption(const char* flag) {
+    static const char* const OPTIONS[] = {
+        "--mode", "--rate", "--duration", "--arrivals", "--think-us", "--nodes", "--drivers",
+        "--mix", "--update-batch", "--warmup", "--seed", "--out", "--trace"
+    };
+    for (const char* option : OPTIONS) {
+        if (std::strcmp(flag, option) == 0) return true;
+    }
+    return false;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--mode open|closed] [--rate N] [--duration SEC] [--arrivals uniform|poisson]"
+              << " [--think-us N] [--nodes N] [--drivers N] [--mix find=W,update=W,complete=W]"
+              << " [--update-batch N] [--warmup N] [--seed N] [--out FILE] [--trace FILE]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+
+    for (int i = 1; i < argc; i += 2) {
+        const char* flag = argv[i];
+        if (std::strcmp(flag, "--help") == 0 || std::strcmp(flag, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (!isKnownOption(flag)) {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[i + 1];
+        if (std::strcmp(flag, "--mode") == 0) {
+            if (std::strcmp(value, "open") != 0 && std::strcmp(value, "closed") != 0) {
+                std::cerr << "Invalid --mode: " << value << std::endl;
+                return 1;
+            }
+            options.openLoop = std::strcmp(value, "closed") != 0;
+        } else if (std::strcmp(flag, "--rate") == 0) {
+            options.rate = std::atof(value);
+        } else if (std::strcmp(flag, "--duration") == 0) {
+            options.durationSec = std::atof(value);
+        } else if (std::strcmp(flag, "--arrivals") == 0) {
+            if (std::strcmp(value, "uniform") != 0 && std::strcmp(value, "poisson") != 0) {
+                std::cerr << "Invalid --arrivals: " << value << std::endl;
+                return 1;
+            }
+            options.poissonArrivals = std::strcmp(value, "poisson") == 0;
+        } else if (std::strcmp(flag, "--think-us") == 0) {
+            options.thinkUs = std::atof(value);
+        } else if (std::strcmp(flag, "--nodes") == 0) {
+            options.numNodes = std::atoi(value);
+        } else if (std::strcmp(flag, "--drivers") == 0) {
+            options.numDrivers = std::atoi(value);
+        } else if (std::strcmp(flag, "--mix") == 0) {
+            if (!parseMix(value, options.mix)) {
+                std::cerr << "Invalid --mix: " << value << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(flag, "--update-batch") == 0) {
+            options.updateBatch = std::atoi(value);
+        } else if (std::strcmp(flag, "--warmup") == 0) {
+            options.warmup = std::atoi(value);
+        } else if (std::strcmp(flag, "--seed") == 0) {
+            options.seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(flag, "--out") == 0) {
+            options.outPath = value;
+        } else if (std::strcmp(flag, "--trace") == 0) {
+            options.tracePath = value;
+        }
+    }
+
+    if (options.rate <= 0.0 || options.durationSec <= 0.0 || options.numNodes < 2 ||
+        options.numDrivers < 1 || options.updateBatch < 1 || options.warmup < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    CityGraphGenerator::seed(options.seed);
+    std::unique_ptr<CityData> city(CityGraphGenerator::generateCityGraph(options.numNodes));
+    std::mt19937 fleetRng(options.seed);
+
+    RideMatcher matcher(city->graph);
+    std::vector<int> handles = matcher.addDrivers(makeFleet(options.numDrivers, options.numNodes, fleetRng));
+    LoadDriver load(options, matcher, handles);
+
+    std::cerr << "Warming up (" << options.warmup << " requests)..." << std::endl;
+    for (int i = 0; i < options.warmup; ++i) {
+        load.execute(load.nextOperation());
+        load.trimLogs();
+    }
+    for (int op = 0; op < OP_COUNT; ++op) {
+        load.operations[op] = OperationStats();
+    }
+    Tracer::clear();
+
+    std::cerr << "Running " << (options.openLoop ? "open" : "closed") << "-loop load for "
+              << options.durationSec << "s on " << options.numNodes << " nodes / "
+              << options.numDrivers << " drivers..." << std::endl;
+
+    RunSummary summary;
+    if (options.openLoop) {
+        runOpenLoop(options, load, summary);
+    } else {
+        runClosedLoop(options, load, summary);
+    }
+
+    std::cerr << std::fixed << std::setprecision(1)
+              << "Throughput: " << (summary.requests / summary.wallSec) << " req/s"
+              << ", p50 " << summary.latencyUs.percentile(50.0) << "us"
+              << ", p99 " << summary.latencyUs.percentile(99.0) << "us"
+              << ", p999 " << summary.latencyUs.percentile(99.9) << "us" << std::endl;
+
+    if (!options.tracePath.empty()) {
+        if (!Tracer::isEnabled()) {
+            std::cerr << "Tracing was not compiled in (build with enable_tracing=true)" << std::endl;
+        } else if (!Tracer::writeChromeTraceFile(options.tracePath)) {
+            std::cerr << "Cannot write " << options.tracePath << std::endl;
+        }
+    }
+
+    if (options.outPath.empty()) {
+        writeReport(std::cout, options, matcher, load, summary);
+        return 0;
+    }
+
+    std::ofstream file(options.outPath);
+    if (!file) {
+        std::cerr << "Cannot write " << options.outPath << std::endl;
+        return 1;
+    }
+    writeReport(file, options, matcher, load, summary);
+    return 0;
+}
@@ -0,0 +1,214 @@
+/**
+ * perf_counters.h
+ *
+ * Optional hardware counter sampling for the native benchmarks, built on
+ * Linux perf_event_open: cycles, instructions, last-level cache misses and
+ * branch misses (plus page faults, a software event that also works in
+ * most VMs and containers)
+ *
+ * Each counter is opened separately, user space only, for the calling
+ * thread and (inherit) every thread it creates afterwards, so work done on
+ * ThreadPool workers is counted too. Construct PerfCounters before the
+ * pool: threads that already exist are not counted. Any counter the kernel, PMU or perf_event_paranoid setting refuses
+ * is reported as unavailable; on other platforms they all are. Readings
+ * are scaled when the kernel multiplexed a counter, by the enabled and
+ * running times of the measured section only (a reset clears the count
+ * but not those times, so they are read at start() and subtracted).
+ *
+ * Time Complexity: O(1) per start/stop (one syscall per counter)
+ * Space Complexity: O(1)
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace RideSharing {
+namespace Bench {
+
+enum CounterId {
+    COUNTER_CYCLES = 0,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_PAGE_FAULTS,
+    COUNTER_COUNT
+};
+
+// JSON keys, in CounterId order
+inline const char* counterName(int id) {
+    static const char* const names[COUNTER_COUNT] = {
+        "cycles", "instructions", "llcMisses", "branchMisses", "pageFaults"
+    };
+    return names[id];
+}
+
+// Counter deltas over one measured section
+struct CounterSample {
+    bool available[COUNTER_COUNT];
+    double values[COUNTER_COUNT];
+
+    CounterSample() {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            available[i] = false;
+            values[i] = 0.0;
+        }
+    }
+
+    bool any() const {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            if (available[i]) return true;
+        }
+        return false;
+    }
+};
+
+class PerfCounters {
+private:
+    int fds[COUNTER_COUNT];
+    std::string unavailableReason;
+
+#ifdef __linux__
+    struct ReadFormat {
+        uint64_t value;
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+    };
+
+    ReadFormat baseline[COUNTER_COUNT]; // Times when the section started
+
+    static int open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1; // Threads created later count too; read() sums them
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    bool readRaw(int id, ReadFormat& data) const {
+        return fds[id] >= 0 &&
+               ::read(fds[id], &data, sizeof(data)) == static_cast<ssize_t>(sizeof(data));
+    }
+
+    // Count since start(), scaled up for the part of the section the
+    // counter was not scheduled
+    bool read(int id, double& value) const {
+        ReadFormat data;
+        if (!readRaw(id, data)) {
+            return false;
+        }
+        uint64_t enabled = data.timeEnabled - baseline[id].timeEnabled;
+        uint64_t running = data.timeRunning - baseline[id].timeRunning;
+        if (running == 0) {
+            return false;
+        }
+        value = static_cast<double>(data.value);
+        if (running < enabled) {
+            value *= static_cast<double>(enabled) / running;
+        }
+        return true;
+    }
+#endif
+
+public:
+    PerfCounters() {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            fds[i] = -1;
+        }
+
+#ifdef __linux__
+        std::memset(baseline, 0, sizeof(baseline));
+        const uint32_t types[COUNTER_COUNT] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+        };
+        const uint64_t configs[COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS
+        };
+
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            fds[i] = open(types[i], configs[i]);
+            if (fds[i] < 0 && unavailableReason.empty()) {
+                unavailableReason = std::string(counterName(i)) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        unavailableReason = "perf_event_open is Linux-only";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            if (fds[i] >= 0) close(fds[i]);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool isOpen(int id) const { return fds[id] >= 0; }
+
+    bool anyOpen() const {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            if (fds[i] >= 0) return true;
+        }
+        return false;
+    }
+
+    // First counter that failed to open and why (empty if all opened)
+    const std::string& reason() const { return unavailableReason; }
+
+    // Reset and enable every open counter, noting its enabled and running
+    // times so far
+    void start() {
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            if (fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            if (!readRaw(i, baseline[i])) {
+                std::memset(&baseline[i], 0, sizeof(baseline[i]));
+            }
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Disable the counters and return what they counted since start()
+    CounterSample stop() {
+        CounterSample sample;
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            if (fds[i] >= 0) ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            sample.available[i] = read(i, sample.values[i]);
+        }
+#endif
+        return sample;
+    }
+};
+
+} // namespace Bench
+} // namespace RideSharing
+
+#endif // PERF_COUNTERS_H
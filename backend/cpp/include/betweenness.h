@@ -0,0 +1,77 @@
+/**
+ * betweenness.h
+ *
+ * Betweenness centrality of every node and road: the share of shortest
+ * paths between pairs of nodes that pass through it. Roads with a high
+ * score carry a large share of the city's routes, so they are the ones
+ * worth precomputing detours and warming caches around
+ *
+ * Brandes' algorithm over a RoutingGraph: one Dijkstra per source counts
+ * the shortest paths to every node (sigma), then a pass over the nodes in
+ * reverse settle order accumulates each node's and edge's dependency on
+ * the source. Sources are independent, so they are split across the
+ * ThreadPool; each chunk sums into its own score arrays, merged at the end
+ *
+ * Exact scores need a search from every node. The sampled mode searches
+ * from k distinct random sources and scales by n / k; by Hoeffding's
+ * inequality (which also holds for sampling without replacement) every
+ * score is then within errorBound of its exact value with probability
+ * 1 - delta
+ *
+ * Scores are normalised over ordered pairs (s, t): a node's by
+ * (n - 1)(n - 2) pairs not including it, an edge's by n(n - 1), so both
+ * lie in [0, 1]. Paths that tie within floating-point equality all count;
+ * edge weights are assumed positive
+ *
+ * Time Complexity: O(k (V + E) log V) for k sources (k = V when exact)
+ * Space Complexity: O(V + E) per chunk of sources
+ */
+
+#ifndef BETWEENNESS_H
+#define BETWEENNESS_H
+
+#include "graph.h"
+#include <vector>
+
+namespace RideSharing {
+
+class ThreadPool;
+
+struct BetweennessOptions {
+    int samples;       // Sources to search; 0 (or at least n) for exact scores
+    double delta;      // Probability that a sampled score misses errorBound
+    unsigned int seed; // Source sampling seed
+
+    BetweennessOptions() : samples(0), delta(0.05), seed(1) {}
+};
+
+struct BetweennessResult {
+    std::vector<double> nodeScores;  // Indexed by vertex
+    std::vector<int> edgeSources;    // Directed edges in adjacency-list order
+    std::vector<int> edgeTargets;
+    std::vector<double> edgeScores;
+    int sourcesSearched;
+    bool exact;
+    double errorBound;               // Largest error of any score (0 when exact)
+
+    BetweennessResult() : sourcesSearched(0), exact(true), errorBound(0.0) {}
+};
+
+class Betweenness {
+public:
+    // Scores of every node and edge of graph, with the searches spread
+    // over pool. Throws std::invalid_argument if delta is not in (0, 1)
+    static BetweennessResult compute(const Graph& graph, const BetweennessOptions& options,
+                                     ThreadPool& pool);
+
+    // Same, on the calling thread only
+    static BetweennessResult compute(const Graph& graph, const BetweennessOptions& options);
+
+    // Sources needed for an errorBound of at most epsilon with probability
+    // 1 - delta (at least 1, at most the node count)
+    static int samplesFor(const Graph& graph, double epsilon, double delta);
+};
+
+} // namespace RideSharing
+
+#endif // BETWEENNESS_H
@@ -0,0 +1,75 @@
+/**
+ * cbor_encoder.h
+ *
+ * Compact binary encoding (CBOR, RFC 8949) of ride matches, driver lists
+ * and graph exports, written directly into a byte buffer
+ *
+ * Numeric columns of the graph export use RFC 8746 typed-array tags
+ * (little-endian int32 / float64), so they decode straight into typed arrays.
+ *
+ * Time Complexity: O(n) in the size of the encoded value
+ * Space Complexity: O(n) output buffer
+ */
+
+#ifndef CBOR_ENCODER_H
+#define CBOR_ENCODER_H
+
+#include "graph.h"
+#include "driver_manager.h"
+#include "ride_matcher.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace RideSharing {
+
+class CborWriter {
+private:
+    std::vector<uint8_t> buffer;
+
+    // Write a major type with its argument in the shortest form
+    void writeHead(uint8_t majorType, uint64_t value);
+
+public:
+    CborWriter() { buffer.reserve(256); }
+
+    void beginMap(size_t pairs) { writeHead(5, pairs); }
+    void beginArray(size_t items) { writeHead(4, items); }
+
+    void writeString(const std::string& value);
+    void writeInt(int64_t value);
+    void writeDouble(double value);   // Uses float32 when that is lossless
+    void writeBool(bool value) { buffer.push_back(value ? 0xf5 : 0xf4); }
+    void writeNull() { buffer.push_back(0xf6); }
+
+    // RFC 8746 typed arrays (tag 64: uint8, tag 78: sint32 LE, tag 86: float64 LE)
+    void writeUint8Array(const std::vector<uint8_t>& values);
+    void writeInt32Array(const std::vector<int>& values);
+    void writeFloat64Array(const std::vector<double>& values);
+
+    // Plain CBOR array of integers
+    void writeIntArray(const std::vector<int>& values);
+
+    const std::vector<uint8_t>& data() const { return buffer; }
+    std::vector<uint8_t> release() { return std::move(buffer); }
+};
+
+class CborEncoder {
+public:
+    // Driver as a map with the same keys as Driver::toJSON
+    static void writeDriver(CborWriter& writer, const Driver& driver);
+
+    // Ride match with the same keys as the findRide() result object
+    static std::vector<uint8_t> encodeRideMatch(const RideMatch& match);
+
+    // Array of drivers
+    static std::vector<uint8_t> encodeDrivers(const std::vector<Driver>& drivers);
+
+    // Columnar graph export with the same keys as exportGraph()
+    static std::vector<uint8_t> encodeGraph(const GraphColumns& columns, int numVertices);
+};
+
+} // namespace RideSharing
+
+#endif // CBOR_ENCODER_H
@@ -34,6 +34,18 @@ public:
      */
     static CityData* generateCityGraph(int numNodes = 50);
 
+    /**
+     * Reseed the generator so later graphs are reproducible
+     * (benchmarks, tooling); by default it is seeded from std::random_device
+     */
+    static void seed(unsigned int value);
+
+    /**
+     * Haversine distance in km between two points given in degrees
+     * (scalar reference; see GeoDistance for the batch kernel)
+     */
+    static double calculateDistance(double lat1, double lon1, double lat2, double lon2);
+
 private:
     static void createHighways(Graph* graph, const std::vector<NodeData>& nodeData, int numNodes);
     static void createArterialRoads(Graph* graph, const std::vector<NodeData>& nodeData, int numNodes);
@@ -42,7 +54,6 @@ private:
     static void createShortcuts(Graph* graph, const std::vector<NodeData>& nodeData, int numNodes);
     static void ensureConnectivity(Graph* graph);
 
-    static double calculateDistance(double lat1, double lon1, double lat2, double lon2);
     static double toRad(double degrees);
     static std::string getOrdinal(int n);
 
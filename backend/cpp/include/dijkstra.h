@@ -6,6 +6,12 @@
  *
  * Time Complexity: O((V + E) log V) with binary heap
  * Space Complexity: O(V)
+ *
+ * Distance, predecessor and heap storage comes from the memory resource
+ * given at construction and is reused by every search on the same
+ * instance, so a caller running many searches per request (one per
+ * driver) can keep them all in one arena. A quiet instance skips the
+ * execution and heap logs.
  */
 
 #ifndef DIJKSTRA_H
@@ -15,9 +21,14 @@
 #include "min_heap.h"
 #include <vector>
 #include <string>
+#include <memory_resource>
+#include <utility>
+#include <cstddef>
 
 namespace RideSharing {
 
+class ThreadPool;
+
 // Result structure for Dijkstra's algorithm
 struct DijkstraResult {
     std::vector<double> distances;      // Shortest distances from source
@@ -43,12 +54,24 @@ struct PathResult {
 class Dijkstra {
 private:
     const Graph& graph;
+    std::pmr::memory_resource* memory;
+    bool verbose;
     std::vector<std::string> executionLogs;
 
-    void logStep(const std::string& message);
+    // Scratch of the last search, kept to reuse its capacity
+    std::pmr::vector<double> distances;
+    std::pmr::vector<int> predecessors;
+
+    void logStep(std::string message);
+
+    // Fill distances/predecessors from source; heap logs are collected
+    // only when heapLogs is non-null (and the instance is verbose)
+    bool runSearch(int source, std::string& errorMessage, std::vector<std::string>* heapLogs);
 
 public:
-    explicit Dijkstra(const Graph& g);
+    explicit Dijkstra(const Graph& g,
+                      std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+                      bool verbose = true);
 
     // Run Dijkstra's algorithm from a source node
     DijkstraResult findShortestPaths(int source);
@@ -56,9 +79,16 @@ public:
     // Find shortest path between two specific nodes
     PathResult findShortestPath(int source, int destination);
 
+    // Distance and node sequence only (no road names or ETA); allocates
+    // nothing outside the memory resource once its buffers are warm
+    bool findRoute(int source, int destination, double& distance, std::pmr::vector<int>& path);
+
     // Get execution logs for visualization
     std::vector<std::string> getLogs() const { return executionLogs; }
 
+    // Move the execution logs out, leaving them empty
+    std::vector<std::string> takeLogs() { return std::move(executionLogs); }
+
     // Clear execution logs
     void clearLogs() { executionLogs.clear(); }
 
@@ -68,6 +98,11 @@ public:
 
     // Calculate estimated time based on distance and average speed
     static double calculateETA(double distance, double avgSpeedKmh = 40.0);
+
+    // Shortest distance for each (sources[i], targets[i]) pair, searched in
+    // parallel on the pool; unreachable or unknown pairs get infinity
+    static void findRouteDistances(const Graph& graph, const int* sources, const int* targets,
+                                   size_t count, double* distances, ThreadPool& pool);
 };
 
 } // namespace RideSharing
@@ -0,0 +1,126 @@
+/**
+ * distance_table.h
+ *
+ * Dense all-pairs shortest-path table for small and medium cities: every
+ * distance is one array lookup, and paths are recovered by following
+ * next hops
+ *
+ * Built by running one Dijkstra per source node (over a RoutingGraph) in
+ * parallel on the ThreadPool. Rows are written straight into the table
+ * image, which can be saved to a file and later memory-mapped without
+ * parsing. Distances are stored as float, or as uint16 units quantised
+ * over [0, longest distance] (error at most maxError()). Next hops are
+ * uint16 node ids, which caps a table at MAX_VERTICES nodes
+ *
+ * File layout (native byte order, 64-byte header):
+ *   "RSDTABLE", version, precision, numVertices, reserved,
+ *   graph fingerprint, scale, distances offset, next hops offset, file size
+ *   then V * V distances and V * V next hops, both row-major by source
+ *
+ * A table carries a fingerprint of its graph's edges and weights, so a
+ * stale file is recognised (matches()) rather than silently used
+ *
+ * Time Complexity:
+ *   - Build: O(V (V + E) log V), spread over the pool
+ *   - Lookup: O(1); path: O(path length)
+ * Space Complexity: O(V^2), 6 bytes (float) or 4 bytes (uint16) per pair
+ */
+
+#ifndef DISTANCE_TABLE_H
+#define DISTANCE_TABLE_H
+
+#include "graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RideSharing {
+
+class ThreadPool;
+
+class DistanceTable {
+public:
+    enum class Precision : uint32_t {
+        Float32 = 0,
+        UInt16 = 1
+    };
+
+    static constexpr int MAX_VERTICES = 65535;
+    static constexpr uint16_t NO_HOP = 0xffff;           // Next hop of unreachable or equal pairs
+    static constexpr uint16_t UNREACHABLE_UNITS = 0xffff; // Quantised distance of unreachable pairs
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    std::vector<uint8_t> storage; // Table image, when built or read rather than mapped
+    void* mapping;
+    size_t mappingBytes;
+
+    const uint8_t* image;
+    size_t imageBytes;
+    int vertices;
+    Precision precision;
+    double scale;                 // UInt16: units per graph distance unit
+    uint64_t graphFingerprint;
+    const float* floatDistances;
+    const uint16_t* unitDistances;
+    const uint16_t* nextHops;
+
+    DistanceTable();
+
+    // Validate the header of an image and point the accessors into it
+    // Throws std::runtime_error if the image is not a valid table
+    void attach(const uint8_t* data, size_t bytes);
+
+public:
+    ~DistanceTable();
+    DistanceTable(const DistanceTable&) = delete;
+    DistanceTable& operator=(const DistanceTable&) = delete;
+
+    // All-pairs distances and next hops of graph, one search per source on
+    // pool. Throws std::invalid_argument above MAX_VERTICES nodes
+    static std::shared_ptr<const DistanceTable> build(const Graph& graph, Precision precision,
+                                                      ThreadPool& pool);
+
+    // Map a saved table (read into memory where mmap is unavailable)
+    // Throws std::runtime_error if the file cannot be read or is not a table
+    static std::shared_ptr<const DistanceTable> open(const std::string& path);
+
+    // Write the table image to path + ".tmp", then rename it over path, so
+    // processes mapping the old file keep a valid mapping. Throws
+    // std::runtime_error on I/O failure
+    void save(const std::string& path) const;
+
+    // Hash of the graph's vertex count, which vertices have nodes, and
+    // every edge and weight
+    static uint64_t fingerprint(const Graph& graph);
+
+    // True if the table was built from a graph with the same edges
+    bool matches(const Graph& graph) const;
+
+    int numVertices() const { return vertices; }
+    Precision getPrecision() const { return precision; }
+
+    // Shortest distance (infinity if unreachable or out of range)
+    double distance(int source, int target) const;
+
+    // Node after source on a shortest path to target (-1 if none)
+    int nextHop(int source, int target) const;
+
+    // Node sequence from source to target; false if unreachable
+    bool path(int source, int target, std::vector<int>& out) const;
+
+    // Largest quantisation error of a stored distance: about half a unit
+    // for UInt16; 0 for Float32, which only rounds (relative error 6e-8)
+    double maxError() const;
+
+    bool isMapped() const { return mapping != nullptr; }
+
+    // Bytes of the table image (mapped or held)
+    size_t sizeBytes() const { return imageBytes; }
+};
+
+} // namespace RideSharing
+
+#endif // DISTANCE_TABLE_H
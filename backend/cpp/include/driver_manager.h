@@ -4,9 +4,20 @@
  * Driver Management System using HashMap
  * Efficiently stores and retrieves driver information
  *
+ * Drivers live in a slot table; each one is identified by a stable integer
+ * handle so batch updates can address drivers without string lookups. A
+ * handle packs the slot index with the slot's generation, which removal
+ * bumps: a handle saved before its driver was removed is rejected rather
+ * than addressing whichever driver reuses the slot (until the generation
+ * wraps, after MAX_GENERATION removals from the same slot).
+ *
+ * Fleet counters (total/available/busy, overall and per vehicle type) are
+ * maintained incrementally, so fleet statistics are O(1) to read.
+ *
  * Time Complexity:
  *   - Add Driver: O(1) average
- *   - Get Driver: O(1) average
+ *   - Get Driver: O(1) average (by ID), O(1) (by handle)
+ *   - Batch Update: O(k) for k drivers
  *   - Find Nearest: O(D) where D is number of drivers
  * Space Complexity: O(D)
  */
@@ -14,9 +25,15 @@
 #ifndef DRIVER_MANAGER_H
 #define DRIVER_MANAGER_H
 
+#include "memory_usage.h"
+#include "json_writer.h"
+#include "flat_hash_map.h"
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace RideSharing {
 
@@ -36,6 +53,7 @@ struct Driver {
           isAvailable(true), vehicleType(vehicle), rating(rate), completedRides(0) {}
 
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
 };
 
 // Structure for nearest driver result
@@ -48,13 +66,58 @@ struct NearestDriverResult {
     NearestDriverResult() : distance(0.0), found(false) {}
 };
 
+// Driver counts for one vehicle type
+struct VehicleClassCounts {
+    int total;
+    int available;
+
+    VehicleClassCounts() : total(0), available(0) {}
+};
+
+// Snapshot of the incrementally maintained fleet counters
+struct FleetStats {
+    int totalDrivers;
+    int availableDrivers;
+    int busyDrivers;
+    std::unordered_map<std::string, VehicleClassCounts> byVehicleType;
+
+    FleetStats() : totalDrivers(0), availableDrivers(0), busyDrivers(0) {}
+};
+
 class DriverManager {
 private:
-    std::unordered_map<std::string, Driver> drivers; // HashMap: driver_id -> Driver
+    std::vector<Driver> driverTable;                  // Driver slots
+    std::vector<uint16_t> slotGenerations;            // Bumped each time a slot is released
+    FlatHashMap<std::string, int> driverIndex;        // HashMap: driver_id -> slot
+    std::vector<int> freeSlots;                       // Slots released by removeDriver
     std::vector<std::string> operationLogs;
 
+    // Fleet counters, kept in sync by every add/remove/availability change
+    int availableCount;
+    std::unordered_map<std::string, VehicleClassCounts> vehicleCounts;
+
     void logOperation(const std::string& operation);
 
+    // Handle layout: generation above HANDLE_SLOT_BITS bits of slot index,
+    // so handles stay non-negative 32-bit ints
+    static const int HANDLE_SLOT_BITS = 21;
+    static const int MAX_SLOTS = 1 << HANDLE_SLOT_BITS;
+    static const int MAX_GENERATION = 1 << (31 - HANDLE_SLOT_BITS);
+
+    int handleForSlot(int slot) const {
+        return (static_cast<int>(slotGenerations[slot]) << HANDLE_SLOT_BITS) | slot;
+    }
+
+    // Slot lookup; returns nullptr for out-of-range, released or stale handles
+    Driver* slotForHandle(int handle);
+
+    // Store a new driver in a free slot and index it; returns its handle, or
+    // -1 if the table already holds MAX_SLOTS drivers
+    int insertDriver(const Driver& driver);
+
+    // Change a driver's availability and adjust the fleet counters
+    void setAvailability(Driver& driver, bool available);
+
 public:
     DriverManager();
 
@@ -64,8 +127,19 @@ public:
     // Remove a driver from the system
     bool removeDriver(const std::string& driverId);
 
-    // Get driver by ID
-    Driver* getDriver(const std::string& driverId);
+    // Add many drivers at once; returns one handle per driver (-1 if rejected)
+    std::vector<int> addDrivers(const std::vector<Driver>& batch);
+
+    // Get driver by ID (pointer is invalidated by later additions).
+    // Change availability through updateDriverAvailability so the fleet
+    // counters stay consistent.
+    Driver* getDriver(std::string_view driverId);
+
+    // Get driver by handle
+    Driver* getDriverByHandle(int handle);
+
+    // Get the handle of a driver, or -1 if not found
+    int getDriverHandle(std::string_view driverId) const;
 
     // Update driver location
     bool updateDriverLocation(const std::string& driverId, int newLocation);
@@ -73,17 +147,40 @@ public:
     // Update driver availability
     bool updateDriverAvailability(const std::string& driverId, bool available);
 
+    // Batch location update from parallel arrays; returns number applied.
+    // Stale handles and locations outside [0, numLocations) are skipped
+    int updateDriverLocations(const int* handles, const int* locations, size_t count,
+                              int numLocations);
+
+    // Batch availability update from parallel arrays; returns number
+    // applied. Stale handles are skipped
+    int updateDriverAvailabilities(const int* handles, const uint8_t* available, size_t count);
+
     // Get all available drivers
     std::vector<Driver> getAvailableDrivers() const;
 
+    // Visit each available driver in place, without copying it
+    // fn must not add or remove drivers
+    template <typename Fn>
+    void forEachAvailableDriver(Fn&& fn) const {
+        for (const Driver& driver : driverTable) {
+            if (!driver.id.empty() && driver.isAvailable) {
+                fn(driver);
+            }
+        }
+    }
+
     // Get all drivers
     std::vector<Driver> getAllDrivers() const;
 
     // Get number of drivers
-    int getDriverCount() const { return drivers.size(); }
+    int getDriverCount() const { return driverIndex.size(); }
 
     // Get number of available drivers
-    int getAvailableDriverCount() const;
+    int getAvailableDriverCount() const { return availableCount; }
+
+    // Get total/available/busy counts, overall and per vehicle type
+    FleetStats getFleetStats() const;
 
     // Get operation logs
     std::vector<std::string> getLogs() const { return operationLogs; }
@@ -93,6 +190,10 @@ public:
 
     // Export to JSON
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
+
+    // Bytes held by the driver table, indexes, counters and logs
+    MemoryBreakdown memoryUsage() const;
 };
 
 } // namespace RideSharing
@@ -0,0 +1,330 @@
+/**
+ * flat_hash_map.h
+ *
+ * Open-addressing hash map for the core lookup tables
+ * Entries are stored densely in one vector (iteration is a linear scan in
+ * insertion order) and indexed by a Robin Hood hash table of 8-byte
+ * buckets holding an entry index and 32 bits of the key's hash, so a probe
+ * compares hashes within one cache line and touches the entry only on a
+ * hash match. Erase uses backward-shift deletion (no tombstones) and moves
+ * the last entry into the freed slot
+ *
+ * Lookups are heterogeneous when the hash and equality are transparent:
+ * FlatHashMap<std::string, V> can be queried with a std::string_view or a
+ * string literal without building a std::string
+ *
+ * Inserting may reallocate and erasing moves the last entry, so both
+ * invalidate iterators and references into the map
+ *
+ * Time Complexity:
+ *   - Find / Insert / Erase: O(1) average
+ *   - Iterate: O(n)
+ * Space Complexity: O(n) entries plus 8 bytes per bucket (load <= 7/8)
+ */
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace RideSharing {
+
+// Default hash: std::hash, except strings hash as string_view so that
+// lookups by string_view or const char* need no temporary std::string
+template <typename K>
+struct FlatHash : std::hash<K> {};
+
+template <>
+struct FlatHash<std::string> {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view value) const {
+        return std::hash<std::string_view>()(value);
+    }
+};
+
+// True when T declares is_transparent (heterogeneous lookup support)
+template <typename T, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename T>
+struct IsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+template <typename K, typename V, typename Hash = FlatHash<K>,
+          typename Equal = std::equal_to<>,
+          typename Allocator = std::allocator<std::pair<K, V>>>
+class FlatHashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+
+private:
+    struct Bucket {
+        uint32_t entry; // Index into entries, EMPTY_ENTRY when free
+        uint32_t hash;  // Mixed hash of the entry's key
+    };
+
+    using EntryVector = std::vector<value_type, Allocator>;
+    using BucketAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>;
+
+    static constexpr uint32_t EMPTY_ENTRY = 0xffffffffu;
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr size_t MIN_BUCKETS = 8;
+
+    EntryVector entries;
+    std::vector<Bucket, BucketAllocator> buckets; // Power-of-two size (or empty)
+    Hash hasher;
+    Equal equal;
+
+public:
+    using iterator = typename EntryVector::iterator;
+    using const_iterator = typename EntryVector::const_iterator;
+
+private:
+    // Iterators are excluded so erase(it) never resolves to erase(key)
+    template <typename Q>
+    using EnableIfTransparent = typename std::enable_if<
+        IsTransparent<Hash>::value && IsTransparent<Equal>::value &&
+        !std::is_convertible<const Q&, const_iterator>::value>::type;
+
+public:
+
+    explicit FlatHashMap(const Allocator& allocator = Allocator())
+        : entries(allocator), buckets(BucketAllocator(allocator)) {}
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Allocated entry slots and hash buckets (for memory accounting)
+    size_t capacity() const { return entries.capacity(); }
+    size_t bucket_count() const { return buckets.size(); }
+    static constexpr size_t bucketBytes() { return sizeof(Bucket); }
+
+    void clear() {
+        entries.clear();
+        for (Bucket& bucket : buckets) {
+            bucket.entry = EMPTY_ENTRY;
+        }
+    }
+
+    // Make room for count entries without rehashing
+    void reserve(size_t count) {
+        entries.reserve(count);
+        size_t needed = MIN_BUCKETS;
+        while (needed * 7 < count * 8) {
+            needed *= 2;
+        }
+        if (needed > buckets.size()) {
+            rehash(needed);
+        }
+    }
+
+    iterator find(const K& key) { return findEntry(key); }
+    const_iterator find(const K& key) const { return findEntry(key); }
+    bool contains(const K& key) const { return findBucket(key, hashOf(key)) != NOT_FOUND; }
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    // Heterogeneous lookups (e.g. by string_view), when Hash and Equal
+    // are both transparent
+    template <typename Q, typename = EnableIfTransparent<Q>>
+    iterator find(const Q& key) { return findEntry(key); }
+
+    template <typename Q, typename = EnableIfTransparent<Q>>
+    const_iterator find(const Q& key) const { return findEntry(key); }
+
+    template <typename Q, typename = EnableIfTransparent<Q>>
+    bool contains(const Q& key) const { return findBucket(key, hashOf(key)) != NOT_FOUND; }
+
+    V& at(const K& key) {
+        iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("FlatHashMap::at: key not found");
+        }
+        return it->second;
+    }
+
+    const V& at(const K& key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("FlatHashMap::at: key not found");
+        }
+        return it->second;
+    }
+
+    // Insert a value-initialised V if key is absent
+    V& operator[](const K& key) {
+        return try_emplace(key).first->second;
+    }
+
+    // Construct V from args only if key is absent
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        uint32_t hash = hashOf(key);
+        size_t bucket = findBucket(key, hash);
+        if (bucket != NOT_FOUND) {
+            return std::make_pair(entries.begin() + buckets[bucket].entry, false);
+        }
+
+        if ((entries.size() + 1) * 8 > buckets.size() * 7) {
+            rehash(buckets.empty() ? MIN_BUCKETS : buckets.size() * 2);
+        }
+        entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        placeBucket(static_cast<uint32_t>(entries.size() - 1), hash);
+        return std::make_pair(entries.end() - 1, true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+
+    size_t erase(const K& key) { return eraseKey(key); }
+
+    template <typename Q, typename = EnableIfTransparent<Q>>
+    size_t erase(const Q& key) { return eraseKey(key); }
+
+    // Returns an iterator to the entry that took the erased one's place
+    // (or end()), so erasing while iterating does not skip entries
+    iterator erase(const_iterator position) {
+        size_t index = position - entries.cbegin();
+        eraseBucket(findBucket(position->first, hashOf(position->first)));
+        return entries.begin() + index;
+    }
+
+private:
+    template <typename Q>
+    iterator findEntry(const Q& key) {
+        size_t bucket = findBucket(key, hashOf(key));
+        return bucket == NOT_FOUND ? entries.end() : entries.begin() + buckets[bucket].entry;
+    }
+
+    template <typename Q>
+    const_iterator findEntry(const Q& key) const {
+        size_t bucket = findBucket(key, hashOf(key));
+        return bucket == NOT_FOUND ? entries.end() : entries.begin() + buckets[bucket].entry;
+    }
+
+    template <typename Q>
+    size_t eraseKey(const Q& key) {
+        size_t bucket = findBucket(key, hashOf(key));
+        if (bucket == NOT_FOUND) {
+            return 0;
+        }
+        eraseBucket(bucket);
+        return 1;
+    }
+
+    template <typename Q>
+    uint32_t hashOf(const Q& key) const {
+        // Fibonacci mixing spreads weak hashes (std::hash<int> is the
+        // identity) over the high bits that are kept
+        uint64_t mixed = static_cast<uint64_t>(hasher(key)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<uint32_t>(mixed >> 32);
+    }
+
+    size_t mask() const { return buckets.size() - 1; }
+
+    // How far the bucket at position sits from its home bucket
+    size_t probeDistance(uint32_t hash, size_t position) const {
+        return (position - (hash & mask())) & mask();
+    }
+
+    template <typename Q>
+    size_t findBucket(const Q& key, uint32_t hash) const {
+        if (buckets.empty()) {
+            return NOT_FOUND;
+        }
+        size_t position = hash & mask();
+        for (size_t distance = 0;; ++distance, position = (position + 1) & mask()) {
+            const Bucket& bucket = buckets[position];
+            // Robin Hood invariant: the key would have displaced a bucket
+            // closer to its home than we are to ours
+            if (bucket.entry == EMPTY_ENTRY || probeDistance(bucket.hash, position) < distance) {
+                return NOT_FOUND;
+            }
+            if (bucket.hash == hash && equal(entries[bucket.entry].first, key)) {
+                return position;
+            }
+        }
+    }
+
+    void placeBucket(uint32_t entry, uint32_t hash) {
+        Bucket incoming = { entry, hash };
+        size_t position = hash & mask();
+        size_t distance = 0;
+        while (true) {
+            Bucket& bucket = buckets[position];
+            if (bucket.entry == EMPTY_ENTRY) {
+                bucket = incoming;
+                return;
+            }
+            size_t existing = probeDistance(bucket.hash, position);
+            if (existing < distance) {
+                std::swap(bucket, incoming);
+                distance = existing;
+            }
+            position = (position + 1) & mask();
+            ++distance;
+        }
+    }
+
+    void eraseBucket(size_t position) {
+        uint32_t entry = buckets[position].entry;
+
+        // Backward-shift the following displaced buckets into the gap
+        size_t next = (position + 1) & mask();
+        while (buckets[next].entry != EMPTY_ENTRY && probeDistance(buckets[next].hash, next) > 0) {
+            buckets[position] = buckets[next];
+            position = next;
+            next = (next + 1) & mask();
+        }
+        buckets[position].entry = EMPTY_ENTRY;
+
+        // Keep entries dense: move the last entry into the freed slot and
+        // repoint its bucket
+        uint32_t last = static_cast<uint32_t>(entries.size() - 1);
+        if (entry != last) {
+            size_t moved = hashOf(entries[last].first) & mask();
+            while (buckets[moved].entry != last) {
+                moved = (moved + 1) & mask();
+            }
+            buckets[moved].entry = entry;
+            entries[entry] = std::move(entries[last]);
+        }
+        entries.pop_back();
+    }
+
+    void rehash(size_t bucketCount) {
+        buckets.assign(bucketCount, Bucket{ EMPTY_ENTRY, 0 });
+        for (size_t i = 0; i < entries.size(); ++i) {
+            placeBucket(static_cast<uint32_t>(i), hashOf(entries[i].first));
+        }
+    }
+};
+
+// FlatHashMap drawing from a std::pmr::memory_resource
+template <typename K, typename V, typename Hash = FlatHash<K>, typename Equal = std::equal_to<>>
+using PmrFlatHashMap =
+    FlatHashMap<K, V, Hash, Equal, std::pmr::polymorphic_allocator<std::pair<K, V>>>;
+
+} // namespace RideSharing
+
+#endif // FLAT_HASH_MAP_H
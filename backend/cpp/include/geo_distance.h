@@ -0,0 +1,76 @@
+/**
+ * geo_distance.h
+ *
+ * Batch great-circle (haversine) distances from one point to many, for
+ * ranking candidates, snapping coordinates and search heuristics
+ *
+ * Points are stored as structure-of-arrays (GeoPoints): latitude and
+ * longitude in radians plus a precomputed cos(latitude). A batch query is
+ * then one branch-free pass over three contiguous arrays. sin and asin are
+ * polynomial fits (Chebyshev interpolants, about 1e-15 relative error)
+ * instead of library calls, so the compiler vectorizes the loop
+ *
+ * Longitudes are expected in [-180, 180] degrees. Against an extended
+ * precision reference the error is below 1e-10 km for points up to
+ * 18,000 km apart. Near antipodes asin is ill-conditioned and the error
+ * grows to MAX_ERROR_KM (the scalar CityGraphGenerator::calculateDistance
+ * reaches about 1e-5 km there)
+ *
+ * Time Complexity: O(N) per batch
+ * Space Complexity: O(N), 24 bytes per point
+ */
+
+#ifndef GEO_DISTANCE_H
+#define GEO_DISTANCE_H
+
+#include "graph.h"
+#include <cstddef>
+#include <vector>
+
+namespace RideSharing {
+
+// Coordinates of many points, in radians, one array per field
+struct GeoPoints {
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> cosLatitudes;
+
+    void reserve(size_t count);
+    void clear();
+    size_t size() const { return latitudes.size(); }
+
+    // Append a point given in degrees
+    void add(double latitude, double longitude);
+
+    // One point per vertex, indexed by node ID; vertices without a node
+    // get NaN coordinates (and so NaN distances)
+    static GeoPoints fromGraph(const Graph& graph);
+
+    size_t memoryBytes() const;
+};
+
+namespace GeoDistance {
+
+constexpr double EARTH_RADIUS_KM = 6371.0;
+
+// Error bound over the whole globe, reached only near antipodal points
+constexpr double MAX_ERROR_KM = 1e-4;
+
+// Distance in km between two points given in degrees
+double haversine(double lat1, double lon1, double lat2, double lon2);
+
+// distances[i] = distance in km from (latitude, longitude), in degrees, to
+// points[i]; distances must hold points.size() values
+void haversineBatch(double latitude, double longitude, const GeoPoints& points,
+                    double* distances);
+
+// Same, over raw arrays of count points (radians and cos(latitude))
+void haversineBatch(double latitude, double longitude, const double* latitudes,
+                    const double* longitudes, const double* cosLatitudes, size_t count,
+                    double* distances);
+
+} // namespace GeoDistance
+
+} // namespace RideSharing
+
+#endif // GEO_DISTANCE_H
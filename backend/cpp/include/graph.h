@@ -11,21 +11,45 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "memory_usage.h"
+#include "json_writer.h"
+#include "flat_hash_map.h"
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 #include <string>
 #include <memory>
 
 namespace RideSharing {
 
+class ComponentLabels;
+
+// Road hierarchy, most important first. Stored per edge so routing, tiling
+// and preprocessing can rank roads without parsing their names
+enum class RoadClass : uint8_t {
+    Highway = 0,
+    Ring = 1,
+    Arterial = 2,
+    Connector = 3,
+    Local = 4
+};
+
+constexpr int NUM_ROAD_CLASSES = 5;
+
+// Lower-case name of a road class ("highway", "ring", ...)
+const char* roadClassName(RoadClass roadClass);
+
+// Road class with the given lower-case name; false if there is none
+bool parseRoadClass(const std::string& name, RoadClass& roadClass);
+
 // Edge structure representing a road between two locations
 struct Edge {
     int destination;      // Destination node ID
+    RoadClass roadClass;  // Road hierarchy level (sits in padding before weight)
     double weight;        // Distance/time between nodes
     std::string roadName; // Optional road name for display
 
-    Edge(int dest, double w, const std::string& name = "")
-        : destination(dest), weight(w), roadName(name) {}
+    Edge(int dest, double w, const std::string& name = "", RoadClass cls = RoadClass::Local)
+        : destination(dest), roadClass(cls), weight(w), roadName(name) {}
 };
 
 // Node structure representing a location in the city
@@ -40,21 +64,46 @@ struct Node {
         : id(nodeId), name(nodeName), latitude(lat), longitude(lon) {}
 };
 
+// Columnar (structure-of-arrays) snapshot of the whole graph, used to
+// export it in one call. Node and road names are interned into a shared
+// string table and referenced by index.
+struct GraphColumns {
+    std::vector<int> nodeIds;           // Node IDs in ascending order
+    std::vector<double> latitudes;      // Latitude per node
+    std::vector<double> longitudes;     // Longitude per node
+    std::vector<int> nodeNameIds;       // Index into names per node
+
+    std::vector<int> edgeSources;       // Source node per edge
+    std::vector<int> edgeTargets;       // Destination node per edge
+    std::vector<double> edgeWeights;    // Weight per edge
+    std::vector<int> roadNameIds;       // Index into names per edge
+    std::vector<uint8_t> roadClasses;   // RoadClass per edge
+
+    std::vector<std::string> names;     // Interned node and road names
+};
+
 class Graph {
 private:
     int numVertices;
     std::vector<std::vector<Edge>> adjacencyList;
-    std::unordered_map<int, Node> nodes;
+    FlatHashMap<int, Node> nodes;
+    uint64_t edits;             // Edges and nodes added since construction
+
+    // Labels for the current edges, built on first use and dropped by
+    // every edge change; a built set is shared, never modified
+    mutable std::shared_ptr<const ComponentLabels> componentLabels;
 
 public:
     // Constructor
     explicit Graph(int vertices);
 
     // Add a bidirectional edge (road between two locations)
-    void addEdge(int src, int dest, double weight, const std::string& roadName = "");
+    void addEdge(int src, int dest, double weight, const std::string& roadName = "",
+                 RoadClass roadClass = RoadClass::Local);
 
     // Add a unidirectional edge (one-way road)
-    void addDirectedEdge(int src, int dest, double weight, const std::string& roadName = "");
+    void addDirectedEdge(int src, int dest, double weight, const std::string& roadName = "",
+                         RoadClass roadClass = RoadClass::Local);
 
     // Add node information
     void addNode(int id, const std::string& name, double lat, double lon);
@@ -68,17 +117,35 @@ public:
     // Check if node exists
     bool nodeExists(int id) const;
 
+    // Bumped by every addEdge, addDirectedEdge and addNode, so anything
+    // derived from the graph can tell it has gone stale
+    uint64_t getEditCount() const { return edits; }
+
     // Get total number of vertices
     int getNumVertices() const { return numVertices; }
 
     // Get all nodes
-    const std::unordered_map<int, Node>& getAllNodes() const { return nodes; }
+    const FlatHashMap<int, Node>& getAllNodes() const { return nodes; }
+
+    // Connected and strongly connected component labels (see
+    // graph_components.h). Safe to call from concurrent readers
+    std::shared_ptr<const ComponentLabels> components() const;
 
     // Validate graph integrity
     bool validate() const;
 
     // Export graph to JSON string
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
+
+    // Export graph as columnar arrays (each bidirectional edge once)
+    GraphColumns exportColumns() const;
+
+    // Number of directed adjacency entries (a two-way road counts twice)
+    size_t getNumDirectedEdges() const;
+
+    // Bytes held by the adjacency lists, node table and name strings
+    MemoryBreakdown memoryUsage() const;
 };
 
 } // namespace RideSharing
@@ -0,0 +1,76 @@
+/**
+ * graph_components.h
+ *
+ * Connected and strongly connected component labels of a Graph, so a
+ * query between nodes that cannot reach each other is rejected in O(1)
+ * instead of after searching the source's whole component
+ *
+ * Every vertex gets two labels:
+ *   - component: its weakly connected component (edges taken as two-way).
+ *     Different components never reach each other
+ *   - strongComponent: its strongly connected component, numbered in
+ *     topological order of the condensation (every edge between two SCCs
+ *     goes from a lower to a higher label). Source and target in the same
+ *     SCC always reach each other; a target with a lower label than its
+ *     source never can
+ * Neither test is complete (an SCC can reach some higher-numbered SCCs but
+ * not others), so mayReach() is a filter: false means certainly no path
+ *
+ * Labels are immutable once built. Graph::components() builds them on
+ * first use after the edges last changed and shares them, so readers of a
+ * published snapshot never see them change
+ *
+ * Time Complexity:
+ *   - Build: O(V + E) (union-find and an iterative Tarjan)
+ *   - mayReach: O(1)
+ * Space Complexity: O(V), two ints per vertex
+ */
+
+#ifndef GRAPH_COMPONENTS_H
+#define GRAPH_COMPONENTS_H
+
+#include "graph.h"
+#include <cstddef>
+#include <vector>
+
+namespace RideSharing {
+
+class ComponentLabels {
+private:
+    std::vector<int> component;
+    std::vector<int> strongComponent;
+    int numComponents;
+    int numStrongComponents;
+
+    ComponentLabels() : numComponents(0), numStrongComponents(0) {}
+
+public:
+    static ComponentLabels compute(const Graph& graph);
+
+    // False if no path can lead from source to target (or either id is out
+    // of range); true does not guarantee a path
+    bool mayReach(int source, int target) const {
+        if (source < 0 || target < 0 || static_cast<size_t>(source) >= component.size() ||
+            static_cast<size_t>(target) >= component.size()) {
+            return false;
+        }
+        return component[source] == component[target] &&
+               strongComponent[source] <= strongComponent[target];
+    }
+
+    int componentOf(int vertex) const { return component[vertex]; }
+    int strongComponentOf(int vertex) const { return strongComponent[vertex]; }
+
+    int getNumComponents() const { return numComponents; }
+    int getNumStrongComponents() const { return numStrongComponents; }
+
+    const std::vector<int>& getComponents() const { return component; }
+    const std::vector<int>& getStrongComponents() const { return strongComponent; }
+
+    // Bytes held by the label arrays
+    size_t memoryBytes() const;
+};
+
+} // namespace RideSharing
+
+#endif // GRAPH_COMPONENTS_H
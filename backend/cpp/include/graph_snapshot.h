@@ -0,0 +1,38 @@
+/**
+ * graph_snapshot.h
+ *
+ * Process-wide registry of immutable, reference-counted graph snapshots.
+ * A snapshot is published once and can then be opened by handle from any
+ * thread (e.g. every Node.js worker_thread's addon instance), so all of
+ * them route against one shared copy of the Graph.
+ *
+ * Time Complexity: O(1) average for publish/acquire/release
+ * Space Complexity: O(S) handles for S published snapshots
+ */
+
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include "graph.h"
+#include <memory>
+
+namespace RideSharing {
+
+class GraphSnapshotRegistry {
+public:
+    // Publish a graph; it must not be modified afterwards. Returns its handle.
+    static int publish(std::shared_ptr<const Graph> graph);
+
+    // Take a reference to a published graph (nullptr if the handle is unknown)
+    static std::shared_ptr<const Graph> acquire(int handle);
+
+    // Drop the registry's reference; holders keep the graph alive
+    static bool release(int handle);
+
+    // Number of published snapshots
+    static int size();
+};
+
+} // namespace RideSharing
+
+#endif // GRAPH_SNAPSHOT_H
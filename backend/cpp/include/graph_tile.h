@@ -0,0 +1,113 @@
+/**
+ * graph_tile.h
+ *
+ * Spatial index over graph edges for bounding-box, level-of-detail tile
+ * queries, so a map client fetches only the roads it can show
+ *
+ * Edges are bucketed into a uniform grid over the graph's bounds, one grid
+ * per detail level of the edges' RoadClass: level 0 holds highways and ring
+ * roads, level 1 adds arterials and connectors, level 2 adds local streets.
+ * A query at a given web-map zoom visits only the grids that zoom shows, and
+ * only the cells the box overlaps
+ *
+ * Below DETAIL_ZOOM, edges of one road class that meet end to end are joined
+ * into polylines and simplified (Douglas-Peucker, about one pixel). At
+ * DETAIL_ZOOM and above every edge is its own line and carries its weight
+ *
+ * Tile encoding (all integers are LEB128 varints, signed ones zigzag):
+ *   version, extent, flags (bit 0: lines carry weights), line count
+ *   per line: roadClass | (point count << 3), [weight * 10], then every
+ *   point as a signed (dx, dy) from the previous point of the tile
+ * Coordinates are quantised to [0, extent] across the requested box, x
+ * east and y south (canvas order); points of lines that leave the box fall
+ * outside that range
+ *
+ * Time Complexity:
+ *   - Build: O(V + E * c) for c cells covered per edge
+ *   - Query: O(cells in box + k log k) for k matching edges
+ * Space Complexity: O(V + E * c)
+ */
+
+#ifndef GRAPH_TILE_H
+#define GRAPH_TILE_H
+
+#include "graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RideSharing {
+
+// Axis-aligned box in degrees
+struct GeoBounds {
+    double minLat;
+    double minLon;
+    double maxLat;
+    double maxLon;
+
+    GeoBounds() : minLat(0.0), minLon(0.0), maxLat(0.0), maxLon(0.0) {}
+    GeoBounds(double south, double west, double north, double east)
+        : minLat(south), minLon(west), maxLat(north), maxLon(east) {}
+
+    bool isValid() const { return minLat < maxLat && minLon < maxLon; }
+};
+
+class GraphTileIndex {
+public:
+    static constexpr int LEVELS = 3;
+    static constexpr int MAJOR_ROADS_ZOOM = 10; // From here arterials and connectors appear
+    static constexpr int DETAIL_ZOOM = 12;      // From here local streets, and edges are not merged
+    static constexpr uint32_t EXTENT = 4096;
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_WEIGHTS = 1;
+
+private:
+    struct IndexedEdge {
+        int source;
+        int target;
+        float weight;
+        RoadClass roadClass;
+    };
+
+    // Edges of one detail level bucketed by grid cell (CSR)
+    struct EdgeGrid {
+        int cellsX;
+        int cellsY;
+        std::vector<uint32_t> offsets; // Edges of cell c are [offsets[c], offsets[c + 1])
+        std::vector<uint32_t> edgeIds;
+
+        EdgeGrid() : cellsX(1), cellsY(1) {}
+    };
+
+    GeoBounds bounds;
+    std::vector<double> latitudes;  // Per node ID (NaN if there is no node)
+    std::vector<double> longitudes;
+    std::vector<IndexedEdge> edges;
+    EdgeGrid grids[LEVELS];
+
+    void buildGrid(int level, const std::vector<uint32_t>& levelEdges);
+    int cellX(const EdgeGrid& grid, double lon) const;
+    int cellY(const EdgeGrid& grid, double lat) const;
+
+public:
+    // Index every edge of graph once (as exportColumns lists them)
+    explicit GraphTileIndex(const Graph& graph);
+
+    // Detail level shown at a zoom: 0 major roads only ... LEVELS - 1 all
+    static int levelForZoom(int zoom);
+    static int levelOf(RoadClass roadClass);
+
+    // IDs (positions in the index) of edges visible in box at zoom, sorted
+    std::vector<uint32_t> query(const GeoBounds& box, int zoom) const;
+
+    // Encoded tile of box at zoom (see the format above)
+    std::vector<uint8_t> encodeTile(const GeoBounds& box, int zoom) const;
+
+    const GeoBounds& getBounds() const { return bounds; }
+    size_t edgeCount() const { return edges.size(); }
+    size_t memoryBytes() const;
+};
+
+} // namespace RideSharing
+
+#endif // GRAPH_TILE_H
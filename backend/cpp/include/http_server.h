@@ -0,0 +1,124 @@
+/**
+ * http_server.h
+ *
+ * Minimal single-threaded HTTP/1.1 server built on Linux epoll
+ * Supports keep-alive connections and pipelined requests, which are
+ * answered strictly in order on each connection
+ *
+ * Buffers are bounded per connection: reading stops once the input holds
+ * a maximum-size request, and pipelined requests are held back (and the
+ * socket not read) while unsent output is above a high-water mark. Once a
+ * connection will be closed after its output (the peer half-closed, or
+ * asked to close) it is only polled for writing, so a peer that never
+ * reads cannot make EOF wake the loop over and over. A handler that throws
+ * anything is answered with a 500 instead of ending the server
+ *
+ * Time Complexity: O(1) per event plus O(n) to parse n bytes of input
+ * Space Complexity: O(C) buffers for C open connections
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <string>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <cstddef>
+
+namespace RideSharing {
+
+// Parsed HTTP request
+struct HttpRequest {
+    std::string method;
+    std::string path;        // Path without query string
+    std::string query;       // Raw query string (without '?')
+    std::string accept;      // Accept header, if any
+    std::string body;
+    bool keepAlive;
+
+    HttpRequest() : keepAlive(true) {}
+};
+
+// HTTP response produced by a request handler
+struct HttpResponse {
+    int status;
+    std::string contentType;
+    std::string body;
+
+    HttpResponse(int code = 200, const std::string& type = "application/json",
+                 std::string content = "")
+        : status(code), contentType(type), body(std::move(content)) {}
+};
+
+class HttpServer {
+public:
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+    HttpServer(int port, Handler handler);
+    ~HttpServer();
+
+    // Bind and listen; returns false and fills error on failure
+    bool start(std::string& error);
+
+    // Run the event loop until stop() is called
+    void run();
+
+    // Ask the event loop to exit (safe to call from a signal handler)
+    void stop() { running = false; }
+
+private:
+    // Per-connection state: unparsed input and unsent output
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        size_t outputOffset;
+        bool closeAfterWrite;
+        bool peerClosed;      // recv() saw EOF; no more input will arrive
+
+        Connection(int socket = -1)
+            : fd(socket), outputOffset(0), closeAfterWrite(false), peerClosed(false) {}
+    };
+
+    static const size_t MAX_HEADER_BYTES = 16 * 1024; // Request line and headers, with the blank line
+    static const size_t MAX_BODY_BYTES = 1024 * 1024;
+    static const size_t MAX_INPUT_BYTES = MAX_HEADER_BYTES + MAX_BODY_BYTES; // Holds any valid request
+    static const size_t OUTPUT_HIGH_WATER_BYTES = 1024 * 1024;
+
+    int port;
+    Handler handler;
+    int listenFd;
+    int epollFd;
+    std::atomic<bool> running;
+    std::unordered_map<int, Connection> connections;
+
+    void acceptConnections();
+    void handleReadable(Connection& conn);
+    bool handleWritable(Connection& conn);
+    void closeConnection(int fd);
+    void updateInterest(const Connection& conn);
+
+    // Bytes of output not yet sent
+    static size_t pendingOutput(const Connection& conn) { return conn.output.size() - conn.outputOffset; }
+
+    // Parse and answer every complete request in the input buffer; true if
+    // some were held back because the output is above the high-water mark
+    bool processInput(Connection& conn);
+
+    // Answer buffered requests and send the answers, repeating while held
+    // back requests can go out; false if the connection must be closed
+    bool serviceConnection(Connection& conn);
+
+    // Parse one request; returns bytes consumed, 0 if incomplete, -1 on error
+    long parseRequest(const std::string& input, size_t offset, HttpRequest& request,
+                      int& errorStatus) const;
+
+    static void appendResponse(std::string& out, const HttpResponse& response, bool keepAlive);
+    static const char* statusText(int status);
+};
+
+} // namespace RideSharing
+
+#endif // HTTP_SERVER_H
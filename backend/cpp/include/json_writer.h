@@ -0,0 +1,96 @@
+/**
+ * json_writer.h
+ *
+ * Buffered JSON writer shared by every toJSON method and the native server
+ * Numbers are formatted with std::to_chars (locale-independent, no
+ * iostreams), strings are escaped per RFC 8259, and output is appended to
+ * a std::string that callers can clear and reuse, so serializing into a
+ * warm buffer does not allocate
+ *
+ * Commas between members and elements are inserted automatically; keys
+ * and values are written in document order
+ *
+ * Time Complexity: O(n) in the size of the output
+ * Space Complexity: O(n) output buffer, O(1) nesting state
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RideSharing {
+
+class JsonWriter {
+public:
+    // Deepest nesting of objects/arrays the writer tracks
+    static const int MAX_DEPTH = 32;
+
+private:
+    std::string ownBuffer;
+    std::string& out;
+    bool hasMembers[MAX_DEPTH]; // Whether the open container needs a comma
+    int depth;
+    bool afterKey;              // A key was written; its value comes next
+
+    // Emit the comma (if any) that precedes the next value
+    void separate();
+
+public:
+    // Write into the writer's own buffer
+    JsonWriter();
+
+    // Append to a caller-owned buffer (clear it between documents to reuse it)
+    explicit JsonWriter(std::string& buffer);
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Object member name; the next write is its value
+    void writeKey(std::string_view key);
+
+    void writeString(std::string_view value);
+    void writeInt(int64_t value);
+    void writeBool(bool value);
+    void writeNull();
+
+    // Shortest representation that round-trips
+    void writeDouble(double value);
+
+    // Fixed notation with the given decimals (as std::fixed << setprecision)
+    void writeFixed(double value, int decimals);
+
+    // General notation with the given significant digits (as setprecision)
+    void writePrecision(double value, int significantDigits);
+
+    // Already-encoded JSON value, copied verbatim
+    void writeRaw(std::string_view json);
+
+    void writeIntArray(const std::vector<int>& values);
+    void writeStringArray(const std::vector<std::string>& values);
+
+    // Append number text to any string (e.g. to compose a message)
+    // Non-finite values have no JSON form; the write* methods emit null
+    static void appendInt(std::string& target, int64_t value);
+    static void appendFixed(std::string& target, double value, int decimals);
+
+    // Append value with JSON string escaping (without surrounding quotes)
+    static void appendEscaped(std::string& target, std::string_view value);
+
+    const std::string& data() const { return out; }
+    std::string release() { return std::move(out); }
+};
+
+} // namespace RideSharing
+
+#endif // JSON_WRITER_H
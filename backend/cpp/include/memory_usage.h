@@ -0,0 +1,106 @@
+/**
+ * memory_usage.h
+ *
+ * Explicit byte accounting for the core data structures
+ * Each subsystem walks its own containers and reports the heap bytes they
+ * hold, broken down by component, so memory can be attributed per node,
+ * per edge and per driver without a custom allocator
+ *
+ * Estimates follow the standard library's layout: vector capacity,
+ * out-of-line string buffers (beyond the small-string buffer), one node
+ * plus a bucket pointer per unordered_map entry, and a FlatHashMap's entry
+ * vector plus bucket array
+ *
+ * Time Complexity: O(n) in the number of elements walked
+ * Space Complexity: O(k) for k components
+ */
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include "flat_hash_map.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+namespace RideSharing {
+
+// Bytes held by one subsystem, per component
+struct MemoryBreakdown {
+    std::vector<std::pair<std::string, size_t>> components;
+
+    void add(const std::string& component, size_t bytes) {
+        components.push_back(std::make_pair(component, bytes));
+    }
+
+    // Bytes of one component, or 0 if it was not reported
+    size_t get(const std::string& component) const {
+        for (const auto& entry : components) {
+            if (entry.first == component) return entry.second;
+        }
+        return 0;
+    }
+
+    size_t total() const {
+        size_t sum = 0;
+        for (const auto& component : components) {
+            sum += component.second;
+        }
+        return sum;
+    }
+};
+
+namespace MemoryAccounting {
+
+// Heap buffer of a string; zero while it fits the small-string buffer
+inline size_t stringHeapBytes(const std::string& value) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return value.capacity() > inlineCapacity ? value.capacity() + 1 : 0;
+}
+
+template <typename T, typename A>
+size_t vectorBytes(const std::vector<T, A>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// Vector of strings including each string's own buffer
+inline size_t stringVectorBytes(const std::vector<std::string>& values) {
+    size_t bytes = vectorBytes(values);
+    for (const std::string& value : values) {
+        bytes += stringHeapBytes(value);
+    }
+    return bytes;
+}
+
+// Nodes (value plus next pointer and cached hash) and the bucket array
+template <typename K, typename V, typename H, typename E, typename A>
+size_t unorderedMapBytes(const std::unordered_map<K, V, H, E, A>& map) {
+    const size_t nodeBytes = sizeof(std::pair<const K, V>) + sizeof(void*) + sizeof(size_t);
+    return map.size() * nodeBytes + map.bucket_count() * sizeof(void*);
+}
+
+// Dense entry vector plus the bucket index
+template <typename K, typename V, typename H, typename E, typename A>
+size_t flatHashMapBytes(const FlatHashMap<K, V, H, E, A>& map) {
+    return map.capacity() * sizeof(std::pair<K, V>) +
+           map.bucket_count() * FlatHashMap<K, V, H, E, A>::bucketBytes();
+}
+
+// Deque storage, rounded up to whole blocks
+template <typename T>
+size_t dequeBytes(const std::deque<T>& values) {
+    const size_t blockBytes = sizeof(T) < 512 ? 512 : sizeof(T);
+    const size_t perBlock = blockBytes / sizeof(T);
+    const size_t blocks = values.size() / perBlock + 1;
+    return blocks * blockBytes + (blocks + 2) * sizeof(T*);
+}
+
+} // namespace MemoryAccounting
+
+} // namespace RideSharing
+
+#endif // MEMORY_USAGE_H
@@ -0,0 +1,134 @@
+/**
+ * metrics.h
+ *
+ * Process-wide metrics registry: counters, gauges and histograms rendered
+ * in the Prometheus text exposition format
+ *
+ * Counters and histograms are sharded: each thread updates its own
+ * cache-line-sized shard with relaxed atomics, and the shards are only
+ * summed when the registry is rendered, so hot paths never contend on a
+ * shared cache line. Metrics are registered once and live for the whole
+ * process; callers keep the returned reference.
+ *
+ * Time Complexity: O(1) per update, O(M * S) to render M metrics of S shards
+ * Space Complexity: O(M * S)
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RideSharing {
+
+// Shards per counter/histogram; threads beyond this share shards
+const size_t METRIC_SHARDS = 16;
+
+// Shard of the calling thread, assigned round-robin on first use
+inline size_t metricShard() {
+    static std::atomic<size_t> nextShard(0);
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
+}
+
+// Monotonically increasing count
+class Counter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value;
+        Shard() : value(0) {}
+    };
+
+    Shard shards[METRIC_SHARDS];
+
+public:
+    void inc(uint64_t amount = 1) {
+        shards[metricShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+};
+
+// Value that can go up and down (queue depth, fleet size)
+class Gauge {
+private:
+    std::atomic<double> current;
+
+public:
+    Gauge() : current(0.0) {}
+
+    void set(double value) { current.store(value, std::memory_order_relaxed); }
+    void add(double delta);
+    double value() const { return current.load(std::memory_order_relaxed); }
+};
+
+// Distribution over fixed upper bounds (plus an implicit +Inf bucket)
+class Histogram {
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<double> sum;
+
+        Shard() : sum(0.0) {}
+    };
+
+    std::vector<double> bounds;
+    Shard shards[METRIC_SHARDS];
+
+public:
+    explicit Histogram(const std::vector<double>& upperBounds);
+
+    void observe(double value);
+
+    const std::vector<double>& upperBounds() const { return bounds; }
+
+    // Per-bucket counts (not cumulative); the last entry is the +Inf bucket
+    std::vector<uint64_t> bucketCounts() const;
+    double sum() const;
+};
+
+class MetricsRegistry {
+public:
+    // Registry shared by the whole process (all addon instances and threads)
+    static MetricsRegistry& global();
+
+    // Register a metric, or return the existing one of the same name
+    // Throws std::invalid_argument if the name is taken by another type
+    Counter& counter(const std::string& name, const std::string& help);
+    Gauge& gauge(const std::string& name, const std::string& help);
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::vector<double>& upperBounds);
+
+    // Prometheus text exposition format (version 0.0.4), sorted by name
+    void writePrometheus(std::ostream& out) const;
+    std::string toPrometheusText() const;
+
+private:
+    enum MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        MetricType type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+
+    Entry& findOrAdd(const std::string& name, const std::string& help, MetricType type,
+                     const std::vector<double>* upperBounds);
+};
+
+} // namespace RideSharing
+
+#endif // METRICS_H
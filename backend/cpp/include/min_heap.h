@@ -9,15 +9,22 @@
  *   - ExtractMin: O(log n)
  *   - DecreaseKey: O(log n)
  * Space Complexity: O(n)
+ *
+ * The heap array and position map draw from a caller-supplied
+ * std::pmr::memory_resource, so a search can keep them in a per-request
+ * arena; operation logging can be switched off when nobody reads the logs
  */
 
 #ifndef MIN_HEAP_H
 #define MIN_HEAP_H
 
+#include "memory_usage.h"
+#include "flat_hash_map.h"
 #include <vector>
-#include <unordered_map>
+#include <memory_resource>
 #include <limits>
 #include <string>
+#include <cstddef>
 
 namespace RideSharing {
 
@@ -36,9 +43,10 @@ struct HeapNode {
 
 class MinHeap {
 private:
-    std::vector<HeapNode> heap;
-    std::unordered_map<int, int> positions; // Maps vertex to heap position
+    std::pmr::vector<HeapNode> heap;
+    PmrFlatHashMap<int, int> positions;     // Maps vertex to heap position
     std::vector<std::string> operationLogs; // Logs for visualization
+    bool logging;                            // Record operationLogs
 
     // Helper functions
     int parent(int i) const { return (i - 1) / 2; }
@@ -49,10 +57,12 @@ private:
     void heapifyUp(int i);
     void heapifyDown(int i);
 
-    void logOperation(const std::string& operation);
+    void logOperation(std::string operation);
 
 public:
-    MinHeap();
+    explicit MinHeap(std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+                     bool logging = true);
+    ~MinHeap();
 
     // Insert a new node into the heap
     void insert(int vertex, double distance);
@@ -80,6 +90,14 @@ public:
 
     // Get current heap state as string (for debugging)
     std::string toString() const;
+
+    // Bytes held by the heap array, position map and logs
+    MemoryBreakdown memoryUsage() const;
+
+    // Largest footprint of any heap destroyed so far (heaps live only
+    // for one Dijkstra run, so the high-water mark is what matters)
+    static size_t peakBytes();
+    static void resetPeakBytes();
 };
 
 } // namespace RideSharing
@@ -21,11 +21,14 @@
 #include "graph.h"
 #include "dijkstra.h"
 #include "driver_manager.h"
+#include "distance_table.h"
 #include <queue>
 #include <deque>
 #include <string>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <memory_resource>
 
 namespace RideSharing {
 
@@ -74,6 +77,7 @@ struct RideMatchResult {
                        pickupToDestinationETA(0.0), totalDistance(0.0), totalETA(0.0) {}
 
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
 };
 
 // Sliding window demand statistics
@@ -88,6 +92,7 @@ struct DemandStats {
                     failedMatches(0), avgWaitTime(0.0) {}
 
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
 };
 
 // Simple ride match structure for Node.js
@@ -106,9 +111,23 @@ struct RideMatch {
                   totalDistance(0.0), estimatedTime(0) {}
 };
 
+// Fleet counters plus matcher counters, read in O(1) for health checks
+struct MatcherStats {
+    FleetStats fleet;
+    int queueDepth;
+    long long totalRequests;
+    long long successfulMatches;
+    long long failedMatches;
+
+    MatcherStats() : queueDepth(0), totalRequests(0),
+                     successfulMatches(0), failedMatches(0) {}
+};
+
 class RideMatcher {
 private:
-    Graph* graph;
+    const Graph* graph;
+    std::shared_ptr<const DistanceTable> distanceTable; // Used for distances when set
+    uint64_t distanceTableEdits; // Graph edit count the table was checked against
     DriverManager driverManager;
     std::queue<RideRequest> rideRequestQueue;
     std::deque<RideRequest> recentRequests; // For sliding window analysis
@@ -116,16 +135,27 @@ private:
     const int SLIDING_WINDOW_SIZE = 20; // Number of recent requests to track
     std::vector<std::string> systemLogs;
 
-    void logOperation(const std::string& operation);
+    // Lifetime matching counters
+    long long totalRequests;
+    long long successfulMatches;
+    long long failedMatches;
+
+    void logOperation(std::string operation);
+
+    // The distance table, or nullptr if there is none or the graph has been
+    // edited since it was set (a stale table is released here)
+    const DistanceTable* currentDistanceTable();
 
-    // Find nearest available driver using greedy approach
-    NearestDriverResult findNearestDriver(int pickupLocation);
+    // Find nearest available driver using greedy approach; the per-driver
+    // searches run quietly on the request's scratch memory
+    NearestDriverResult findNearestDriver(int pickupLocation, std::pmr::memory_resource* memory);
 
     // Update sliding window with new request
     void updateSlidingWindow(const RideRequest& request);
 
 public:
-    RideMatcher(Graph* g);
+    RideMatcher(const Graph* g);
+    ~RideMatcher();
 
     // Node.js-friendly methods
     void addDriver(const Driver& driver);
@@ -135,6 +165,21 @@ public:
     void updateDriverLocation(const std::string& driverId, int newLocation);
     void setDriverAvailability(const std::string& driverId, bool isAvailable);
 
+    // Batch driver operations addressed by driver handle
+    std::vector<int> addDrivers(const std::vector<Driver>& drivers);
+    int getDriverHandle(const std::string& driverId) const;
+    int updateDriverLocations(const int* handles, const int* locations, size_t count);
+    int setDriverAvailabilities(const int* handles, const uint8_t* available, size_t count);
+
+    // Answer driver-to-pickup and trip distances from a precomputed table
+    // instead of searching. Returns false (and keeps the current table) if
+    // the table was built from a different graph; nullptr removes it. A
+    // table is dropped once the graph is edited after it was set
+    bool setDistanceTable(std::shared_ptr<const DistanceTable> table);
+    bool hasDistanceTable() const {
+        return distanceTable != nullptr && distanceTableEdits == graph->getEditCount();
+    }
+
     // Add ride request to queue
     void addRideRequest(const RideRequest& request);
 
@@ -150,6 +195,15 @@ public:
     // Analyze demand using sliding window
     DemandStats analyzeDemand() const;
 
+    // Fleet counters, queue depth and matching counters in O(1)
+    MatcherStats getStats() const;
+
+    // Bytes held by the request queue, sliding window, logs and distance table
+    MemoryBreakdown memoryUsage() const;
+
+    // Bytes held by the driver manager
+    MemoryBreakdown driverMemoryUsage() const { return driverManager.memoryUsage(); }
+
     // Get system logs
     std::vector<std::string> getLogs() const { return systemLogs; }
 
@@ -0,0 +1,87 @@
+/**
+ * route_coalescer.h
+ *
+ * Singleflight deduplication of point-to-point route queries
+ *
+ * During a burst (a stadium emptying towards one station) many threads ask
+ * for the same (source, destination) route at the same moment. The first
+ * caller of a query runs the search; callers that arrive while it is still
+ * in flight block on it and share the result instead of searching again.
+ * Nothing is cached: the entry is dropped as soon as the search finishes,
+ * so a later query searches afresh and sees any change to the graph
+ *
+ * Queries are keyed by graph address, which is safe because a graph cannot
+ * be freed while a caller is still searching it. A search that throws
+ * rethrows in every caller waiting on it
+ *
+ * Every query and every coalesced one is counted in the metrics registry
+ * (ridesharing_route_queries_total, ridesharing_route_queries_coalesced_total)
+ *
+ * Time Complexity: O(1) average bookkeeping per query, plus one search per
+ *                  distinct in-flight query
+ * Space Complexity: O(Q) for Q distinct queries in flight
+ */
+
+#ifndef ROUTE_COALESCER_H
+#define ROUTE_COALESCER_H
+
+#include "graph.h"
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RideSharing {
+
+// Result of one route search, shared by every caller that waited on it
+struct SharedRoute {
+    bool found;
+    double distance;
+    std::vector<int> path;
+
+    SharedRoute() : found(false), distance(0.0) {}
+};
+
+class RouteCoalescer {
+public:
+    typedef std::shared_ptr<const SharedRoute> RoutePtr;
+
+    // Search that fills in a route (run by the first caller of a query only)
+    typedef std::function<void(SharedRoute&)> Search;
+
+    // Coalescer shared by the whole process (all addon instances and threads)
+    static RouteCoalescer& global();
+
+    // Route from source to destination on graph: joins an identical query
+    // in flight, or runs search on the calling thread
+    RoutePtr route(const Graph& graph, int source, int destination, const Search& search);
+
+    // Distinct queries being searched right now
+    size_t inFlight() const;
+
+private:
+    struct QueryKey {
+        const Graph* graph;
+        int source;
+        int destination;
+
+        bool operator==(const QueryKey& other) const {
+            return graph == other.graph && source == other.source &&
+                   destination == other.destination;
+        }
+    };
+
+    struct QueryKeyHash {
+        size_t operator()(const QueryKey& key) const;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<QueryKey, std::shared_future<RoutePtr>, QueryKeyHash> pending;
+};
+
+} // namespace RideSharing
+
+#endif // ROUTE_COALESCER_H
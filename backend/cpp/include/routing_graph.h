@@ -0,0 +1,150 @@
+/**
+ * routing_graph.h
+ *
+ * Compact, immutable routing graph compiled from a Graph, parameterised on
+ * the node id type (uint32_t / uint64_t) and the edge weight type (float,
+ * uint32_t or double), plus a Dijkstra search over it
+ *
+ * Graph keeps names and stays editable; RoutingGraph keeps only what a
+ * search reads, in compressed sparse row (CSR) form: one offsets array and
+ * parallel target/weight arrays, so a node's edges are contiguous. A
+ * float/uint32_t graph with 32-bit ids needs 8 bytes per edge where Graph
+ * needs an Edge with a double and a std::string; 64-bit ids lift the
+ * 2^31 limit on node and edge counts
+ *
+ * Integer weights are quantised: each weight is multiplied by weightScale
+ * and rounded. Distances are accumulated in a wider type where needed
+ * (uint32_t weights sum into uint64_t)
+ *
+ * The common combinations are instantiated explicitly in
+ * routing_graph.cpp, so each compiles once to its own specialised loop
+ *
+ * Time Complexity:
+ *   - Build: O(V + E)
+ *   - Search: O((V + E) log V) with a binary heap
+ * Space Complexity: O(V) offsets plus O(E) targets and weights
+ */
+
+#ifndef ROUTING_GRAPH_H
+#define ROUTING_GRAPH_H
+
+#include "graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace RideSharing {
+
+// Type used to accumulate path lengths for each weight type
+template <typename WeightT>
+struct RoutingDistance;
+
+template <>
+struct RoutingDistance<float> { using Type = float; };
+
+template <>
+struct RoutingDistance<double> { using Type = double; };
+
+template <>
+struct RoutingDistance<uint32_t> { using Type = uint64_t; };
+
+template <typename IdT, typename WeightT>
+class RoutingGraph {
+public:
+    using Id = IdT;
+    using Weight = WeightT;
+    using Distance = typename RoutingDistance<WeightT>::Type;
+
+    // Marks "no node" (e.g. the predecessor of a source)
+    static constexpr IdT NO_NODE = std::numeric_limits<IdT>::max();
+
+private:
+    std::vector<IdT> offsets;     // Edges of v are [offsets[v], offsets[v + 1])
+    std::vector<IdT> targets;
+    std::vector<WeightT> weights;
+    double scale;                 // Stored weight = graph weight * scale
+
+public:
+    RoutingGraph() : scale(1.0) {}
+
+    // Compile graph; throws std::overflow_error if a node or edge count
+    // (or a quantised weight) does not fit the chosen types
+    static RoutingGraph fromGraph(const Graph& graph, double weightScale = 1.0);
+
+    IdT numVertices() const { return offsets.empty() ? 0 : static_cast<IdT>(offsets.size() - 1); }
+    size_t numEdges() const { return targets.size(); }
+
+    IdT edgesBegin(IdT vertex) const { return offsets[vertex]; }
+    IdT edgesEnd(IdT vertex) const { return offsets[vertex + 1]; }
+    IdT target(IdT edge) const { return targets[edge]; }
+    WeightT weight(IdT edge) const { return weights[edge]; }
+
+    double weightScale() const { return scale; }
+
+    // Convert a stored distance back to graph units
+    double toGraphUnits(Distance distance) const { return static_cast<double>(distance) / scale; }
+
+    // Bytes held by the offsets, targets and weights arrays
+    size_t memoryBytes() const;
+};
+
+template <typename IdT, typename WeightT>
+class RoutingSearch {
+public:
+    using SearchGraph = RoutingGraph<IdT, WeightT>;
+    using Distance = typename SearchGraph::Distance;
+
+    // Distance of nodes the last search did not reach
+    static constexpr Distance UNREACHABLE = std::numeric_limits<Distance>::max();
+
+private:
+    const SearchGraph& graph;
+    std::vector<Distance> distances;
+    std::vector<IdT> predecessors;
+    std::vector<std::pair<Distance, IdT>> heap; // Lazy-deletion min-heap
+    size_t settled;
+
+    // Search from source; stops once target is settled (NO_NODE: never)
+    void run(IdT source, IdT target);
+
+public:
+    explicit RoutingSearch(const SearchGraph& routingGraph);
+
+    // Distance from source to every node (UNREACHABLE if none); valid
+    // until the next search on this instance
+    const std::vector<Distance>& oneToAll(IdT source);
+
+    // Shortest distance from source to target, and the node sequence if
+    // path is non-null; false if target is unreachable or ids are invalid
+    bool route(IdT source, IdT target, Distance& distance, std::vector<IdT>* path = nullptr);
+
+    // Predecessor of each node on the last search's shortest-path tree
+    const std::vector<IdT>& getPredecessors() const { return predecessors; }
+
+    // Nodes settled by the last search
+    size_t settledCount() const { return settled; }
+};
+
+extern template class RoutingGraph<uint32_t, float>;
+extern template class RoutingGraph<uint32_t, uint32_t>;
+extern template class RoutingGraph<uint32_t, double>;
+extern template class RoutingGraph<uint64_t, float>;
+extern template class RoutingGraph<uint64_t, uint32_t>;
+extern template class RoutingGraph<uint64_t, double>;
+
+extern template class RoutingSearch<uint32_t, float>;
+extern template class RoutingSearch<uint32_t, uint32_t>;
+extern template class RoutingSearch<uint32_t, double>;
+extern template class RoutingSearch<uint64_t, float>;
+extern template class RoutingSearch<uint64_t, uint32_t>;
+extern template class RoutingSearch<uint64_t, double>;
+
+// City-sized default: 32-bit ids, float weights (8 bytes per edge)
+using CompactRoutingGraph = RoutingGraph<uint32_t, float>;
+using CompactRoutingSearch = RoutingSearch<uint32_t, float>;
+
+} // namespace RideSharing
+
+#endif // ROUTING_GRAPH_H
@@ -0,0 +1,217 @@
+/**
+ * thread_pool.h
+ *
+ * Work-stealing thread pool for the parallel native work (batch queries,
+ * table builds, preprocessing)
+ * Every worker owns a deque: it pushes and pops its own tasks at the back
+ * (LIFO, cache-warm) while idle workers steal from the front of the others
+ * (FIFO, oldest and usually largest work first). Tasks submitted from
+ * outside the pool are spread round-robin over the deques
+ *
+ * TaskGroup tracks a set of tasks; wait() runs queued tasks on the calling
+ * thread instead of blocking, so groups may be nested inside pool tasks.
+ * parallelFor splits an index range into chunks on top of a TaskGroup.
+ * A CancellationToken stops tasks that have not started yet and can be
+ * polled by running ones
+ *
+ * Each worker counts executed and stolen tasks and busy time, so
+ * utilisation can be reported per worker
+ *
+ * Time Complexity: O(1) submit / pop / steal (one short lock per deque)
+ * Space Complexity: O(W + T) for W workers and T queued tasks
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace RideSharing {
+
+// Shared cancellation flag; copies refer to the same flag
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag->store(true, std::memory_order_release); }
+    bool isCancelled() const { return flag->load(std::memory_order_acquire); }
+};
+
+// Counters of one worker thread since the pool started
+struct WorkerStats {
+    uint64_t tasksExecuted;
+    uint64_t tasksStolen;     // Executed tasks taken from another worker's deque
+    uint64_t busyNanoseconds; // Time spent running tasks
+    double utilisation;       // busyNanoseconds / pool uptime
+
+    WorkerStats() : tasksExecuted(0), tasksStolen(0), busyNanoseconds(0), utilisation(0.0) {}
+};
+
+struct ThreadPoolStats {
+    size_t workerCount;
+    uint64_t uptimeNanoseconds;
+    uint64_t tasksRunByCallers; // Tasks run by threads waiting on a TaskGroup
+    std::vector<WorkerStats> workers;
+
+    ThreadPoolStats() : workerCount(0), uptimeNanoseconds(0), tasksRunByCallers(0) {}
+};
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+        std::atomic<uint64_t> executed;
+        std::atomic<uint64_t> stolen;
+        std::atomic<uint64_t> busyNanoseconds;
+
+        Worker() : executed(0), stolen(0), busyNanoseconds(0) {}
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> pendingTasks; // Queued, not yet taken
+    std::atomic<size_t> nextQueue;    // Round-robin target for outside submits
+    std::atomic<uint64_t> callerTasks;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::chrono::steady_clock::time_point startTime;
+
+    void workerLoop(size_t index);
+
+    // Pop from the back of own deque, or steal from the front of another
+    bool takeTask(size_t self, Task& task, bool& wasStolen);
+    bool popBack(size_t index, Task& task);
+    bool stealFront(size_t index, Task& task);
+
+public:
+    // workerCount 0 sizes the pool from the available cores
+    explicit ThreadPool(size_t workerCount = 0);
+
+    // Runs every task still queued, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Enqueue a task (on the caller's own deque when called from a worker)
+    void submit(Task task);
+
+    // Run one queued task on the calling thread; false if none was found
+    bool runPendingTask();
+
+    // Index of the calling thread among this pool's workers, or -1
+    int currentWorker() const;
+
+    ThreadPoolStats stats() const;
+
+    // std::thread::hardware_concurrency(), at least 1
+    static size_t defaultWorkerCount();
+
+    /**
+     * Call body(chunkBegin, chunkEnd) over [begin, end) in chunks of grain
+     * indices (0 picks about four chunks per worker) and wait for all of
+     * them; the calling thread runs chunks too. Chunks not yet started are
+     * skipped once the token is cancelled. Returns false if it was
+     * cancelled; rethrows the first exception thrown by body
+     */
+    template <typename Fn>
+    bool parallelFor(size_t begin, size_t end, size_t grain, Fn&& body,
+                     const CancellationToken& token = CancellationToken());
+};
+
+// A set of tasks that can be waited on (and cancelled) together
+class TaskGroup {
+private:
+    ThreadPool& pool;
+    CancellationToken cancelToken;
+    std::atomic<size_t> outstanding;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr firstError;
+
+    void finishTask();
+
+public:
+    explicit TaskGroup(ThreadPool& threadPool, CancellationToken token = CancellationToken());
+
+    // Waits for outstanding tasks (errors are dropped; call wait() to see them)
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Queue fn; it is skipped if the group is cancelled before it starts.
+    // An exception from fn cancels the group and is rethrown by wait()
+    template <typename Fn>
+    void run(Fn&& fn) {
+        outstanding.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this, task = std::forward<Fn>(fn)]() mutable {
+            if (!cancelToken.isCancelled()) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!firstError) {
+                        firstError = std::current_exception();
+                    }
+                    cancelToken.cancel();
+                }
+            }
+            finishTask();
+        });
+    }
+
+    // Help run pool tasks until every task of the group has finished,
+    // then rethrow the first exception (if any)
+    void wait();
+
+    void cancel() { cancelToken.cancel(); }
+    bool isCancelled() const { return cancelToken.isCancelled(); }
+    const CancellationToken& token() const { return cancelToken; }
+};
+
+template <typename Fn>
+bool ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, Fn&& body,
+                             const CancellationToken& token) {
+    if (begin >= end) {
+        return !token.isCancelled();
+    }
+    if (grain == 0) {
+        grain = std::max<size_t>(1, (end - begin) / (size() * 4));
+    }
+
+    TaskGroup group(*this, token);
+    for (size_t chunk = begin; chunk < end; chunk += grain) {
+        size_t chunkEnd = std::min(end, chunk + grain);
+        group.run([&body, chunk, chunkEnd] { body(chunk, chunkEnd); });
+    }
+    group.wait();
+    return !group.isCancelled();
+}
+
+} // namespace RideSharing
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,98 @@
+/**
+ * trace.h
+ *
+ * Lightweight span tracing for hot paths
+ * TRACE_SPAN("category", "name") records the enclosing scope as one
+ * complete event in a per-thread buffer; the buffers are dumped as Chrome
+ * trace-event JSON, viewable in chrome://tracing or Perfetto
+ *
+ * Spans are compiled out unless RIDESHARING_ENABLE_TRACING is defined
+ * (build with `node-gyp rebuild --enable_tracing=true`)
+ *
+ * Time Complexity: O(1) per span, O(E) to dump E events
+ * Space Complexity: O(E), capped at MAX_EVENTS_PER_THREAD per thread
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace RideSharing {
+
+// One finished span; name and category must be string literals
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+class Tracer {
+public:
+    // Events beyond this per thread are counted as dropped
+    static const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+    // Whether spans were compiled in
+    static bool isEnabled();
+
+    // Monotonic clock in nanoseconds since the tracer's epoch
+    static int64_t nowNs();
+
+    // Append a span to the calling thread's buffer
+    static void record(const char* name, const char* category, int64_t startNs, int64_t endNs);
+
+    // Dump all threads' events as Chrome trace-event JSON
+    static void writeChromeTrace(std::ostream& out);
+    static std::string toChromeTraceJSON();
+    static bool writeChromeTraceFile(const std::string& path);
+
+    // Drop all recorded events (buffers stay registered)
+    static void clear();
+
+    static size_t eventCount();
+    static size_t droppedCount();
+};
+
+// RAII span: records [construction, destruction) on scope exit
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    int64_t startNs;
+
+public:
+    TraceSpan(const char* category, const char* name)
+        : name(name), category(category), startNs(Tracer::nowNs()) {}
+
+    ~TraceSpan() { Tracer::record(name, category, startNs, Tracer::nowNs()); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+} // namespace RideSharing
+
+#define RS_TRACE_CONCAT_INNER(a, b) a##b
+#define RS_TRACE_CONCAT(a, b) RS_TRACE_CONCAT_INNER(a, b)
+
+// TRACE_BEGIN/TRACE_END mark a section without opening a new scope;
+// an early return between them drops the span
+#ifdef RIDESHARING_ENABLE_TRACING
+#define TRACE_SPAN(category, name) \
+    ::RideSharing::TraceSpan RS_TRACE_CONCAT(traceSpan_, __LINE__)(category, name)
+#define TRACE_BEGIN(id) \
+    const int64_t RS_TRACE_CONCAT(traceStart_, id) = ::RideSharing::Tracer::nowNs()
+#define TRACE_END(id, category, name) \
+    ::RideSharing::Tracer::record(name, category, RS_TRACE_CONCAT(traceStart_, id), \
+                                  ::RideSharing::Tracer::nowNs())
+#else
+#define TRACE_SPAN(category, name) do { } while (0)
+#define TRACE_BEGIN(id) do { } while (0)
+#define TRACE_END(id, category, name) do { } while (0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,685 @@
+/**
+ * native_server.cpp
+ *
+ * Standalone dispatch server: embeds RideMatcher behind the epoll
+ * HttpServer, with no Node.js/N-API layer in between. Serves the same
+ * /api/ride/request, /api/path/shortest, /api/drivers and /metrics
+ * endpoints as backend/server.js so both paths can be compared head to head.
+ *
+ * Usage: uber_mini_server [--port 3001] [--nodes 50] [--trace trace.json]
+ *                         [--distance-table table.bin]
+ */
+
+#include "include/http_server.h"
+#include "include/ride_matcher.h"
+#include "include/city_graph_generator.h"
+#include "include/trace.h"
+#include "include/metrics.h"
+#include "include/json_writer.h"
+#include "include/distance_table.h"
+#include "include/thread_pool.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+
+using namespace RideSharing;
+
+namespace {
+
+HttpServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer != nullptr) {
+        activeServer->stop();
+    }
+}
+
+// Top-level members of a JSON object request body. The whole body is
+// tokenized, so keys inside string values or nested objects never match
+// and escaped quotes do not end a string. String values are decoded;
+// numbers, true, false and null keep their literal text; nested objects
+// and arrays are checked and skipped, since no endpoint reads them. As
+// with JSON.parse, a repeated key keeps its last value
+class JsonBody {
+public:
+    // False unless text is exactly one valid JSON object
+    bool parse(const std::string& text) {
+        input = &text;
+        pos = 0;
+        members.clear();
+        skipSpace();
+        if (peek() != '{' || !parseObject(0)) return false;
+        skipSpace();
+        return pos == text.size();
+    }
+
+    bool has(const char* key) const { return members.count(key) != 0; }
+
+    // An integer in int range, written as a number or a numeric string
+    // ("12", as the Express server accepts); false if missing, fractional,
+    // out of range or followed by anything else
+    bool readInt(const char* key, int& out) const {
+        auto it = members.find(key);
+        if (it == members.end() || it->second.text.empty()) return false;
+        const std::string& text = it->second.text;
+        const char* begin = text.c_str();
+        if (!(*begin == '-' || (*begin >= '0' && *begin <= '9'))) return false;
+        errno = 0;
+        char* end = nullptr;
+        long long parsed = std::strtoll(begin, &end, 10);
+        if (errno == ERANGE || *end != '\0' ||
+            parsed < std::numeric_limits<int>::min() || parsed > std::numeric_limits<int>::max()) {
+            return false;
+        }
+        out = static_cast<int>(parsed);
+        return true;
+    }
+
+    // A non-empty string value
+    bool readString(const char* key, std::string& out) const {
+        auto it = members.find(key);
+        if (it == members.end() || !it->second.isString || it->second.text.empty()) return false;
+        out = it->second.text;
+        return true;
+    }
+
+private:
+    struct Member {
+        bool isString;
+        std::string text;
+    };
+
+    static const int MAX_DEPTH = 64;
+
+    const std::string* input = nullptr;
+    size_t pos = 0;
+    std::unordered_map<std::string, Member> members;
+
+    char peek() const { return pos < input->size() ? (*input)[pos] : '\0'; }
+
+    void skipSpace() {
+        while (pos < input->size()) {
+            char c = (*input)[pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+            ++pos;
+        }
+    }
+
+    // Parse one value nested depth levels deep; out (if set) receives it
+    // when it is a string or literal
+    bool parseValue(int depth, Member* out) {
+        if (depth > MAX_DEPTH) return false;
+        char c = peek();
+        if (c == '{') return parseObject(depth);
+        if (c == '[') return parseArray(depth);
+        if (c == '"') {
+            std::string text;
+            if (!parseString(text)) return false;
+            if (out != nullptr) {
+                out->isString = true;
+                out->text.swap(text);
+            }
+            return true;
+        }
+        size_t begin = pos;
+        if (!parseLiteral()) return false;
+        if (out != nullptr) {
+            out->isString = false;
+            out->text.assign(*input, begin, pos - begin);
+        }
+        return true;
+    }
+
+    // Members of the top-level object (depth 0) are kept, deeper ones not
+    bool parseObject(int depth) {
+        ++pos; // '{'
+        skipSpace();
+        if (peek() == '}') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            std::string key;
+            if (peek() != '"' || !parseString(key)) return false;
+            skipSpace();
+            if (peek() != ':') return false;
+            ++pos;
+            skipSpace();
+            Member value = Member();
+            if (!parseValue(depth + 1, depth == 0 ? &value : nullptr)) return false;
+            if (depth == 0) {
+                members[key] = std::move(value);
+            }
+            skipSpace();
+            if (peek() == ',') {
+                ++pos;
+                skipSpace();
+                continue;
+            }
+            if (peek() != '}') return false;
+            ++pos;
+            return true;
+        }
+    }
+
+    bool parseArray(int depth) {
+        ++pos; // '['
+        skipSpace();
+        if (peek() == ']') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            if (!parseValue(depth + 1, nullptr)) return false;
+            skipSpace();
+            if (peek() == ',') {
+                ++pos;
+                skipSpace();
+                continue;
+            }
+            if (peek() != ']') return false;
+            ++pos;
+            return true;
+        }
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool parseHex4(unsigned& out) {
+        if (input->size() - pos < 4) return false;
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hexDigit((*input)[pos++]);
+            if (digit < 0) return false;
+            out = out * 16 + static_cast<unsigned>(digit);
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos; // opening quote
+        while (pos < input->size()) {
+            char c = (*input)[pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= input->size()) return false;
+            char escape = (*input)[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (!parseHex4(code)) return false;
+                    // A high surrogate must be followed by an escaped low one
+                    if (code >= 0xD800 && code <= 0xDBFF) {
+                        unsigned low = 0;
+                        if (input->compare(pos, 2, "\\u") != 0) return false;
+                        pos += 2;
+                        if (!parseHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                        return false;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false; // Unterminated
+    }
+
+    bool consumeDigits() {
+        size_t begin = pos;
+        while (peek() >= '0' && peek() <= '9') ++pos;
+        return pos > begin;
+    }
+
+    // true, false, null or a number in JSON's grammar
+    bool parseLiteral() {
+        static const char* const WORDS[] = {"true", "false", "null"};
+        for (const char* word : WORDS) {
+            size_t length = std::strlen(word);
+            if (input->compare(pos, length, word) == 0) {
+                pos += length;
+                return true;
+            }
+        }
+        if (peek() == '-') ++pos;
+        if (peek() == '0') {
+            ++pos;
+        } else if (!consumeDigits()) {
+            return false;
+        }
+        if (peek() == '.') {
+            ++pos;
+            if (!consumeDigits()) return false;
+        }
+        if (peek() == 'e' || peek() == 'E') {
+            ++pos;
+            if (peek() == '+' || peek() == '-') ++pos;
+            if (!consumeDigits()) return false;
+        }
+        return true;
+    }
+};
+
+HttpResponse errorResponse(int status, const std::string& message) {
+    JsonWriter writer;
+    writer.beginObject();
+    writer.writeKey("success");
+    writer.writeBool(false);
+    writer.writeKey("error");
+    writer.writeString(message);
+    writer.endObject();
+    return HttpResponse(status, "application/json", writer.release());
+}
+
+// Enough significant digits for coordinates and distances
+const int NUMBER_PRECISION = 12;
+
+void writeNode(JsonWriter& writer, const Node& node) {
+    writer.beginObject();
+    writer.writeKey("id");
+    writer.writeInt(node.id);
+    writer.writeKey("name");
+    writer.writeString(node.name);
+    writer.writeKey("latitude");
+    writer.writePrecision(node.latitude, NUMBER_PRECISION);
+    writer.writeKey("longitude");
+    writer.writePrecision(node.longitude, NUMBER_PRECISION);
+    writer.endObject();
+}
+
+// Log lines are composed in a reusable buffer before being written:
+// prefix, number, suffix
+const std::string& numberLine(std::string& line, const char* prefix, long long value,
+                              const char* suffix) {
+    line.assign(prefix);
+    JsonWriter::appendInt(line, value);
+    line += suffix;
+    return line;
+}
+
+// "Calculating shortest path from node <from> to node <to>"
+const std::string& routeLine(std::string& line, int from, int to) {
+    line.assign("Calculating shortest path from node ");
+    JsonWriter::appendInt(line, from);
+    line += " to node ";
+    JsonWriter::appendInt(line, to);
+    return line;
+}
+
+// prefix, distance with two decimals, " km"
+const std::string& kmLine(std::string& line, const char* prefix, double distance) {
+    line.assign(prefix);
+    JsonWriter::appendFixed(line, distance, 2);
+    line += " km";
+    return line;
+}
+
+class DispatchService {
+public:
+    explicit DispatchService(int numNodes)
+        : cityData(CityGraphGenerator::generateCityGraph(numNodes)),
+          matcher(cityData->graph) {
+        matcher.addDrivers(cityData->drivers);
+    }
+
+    HttpResponse handle(const HttpRequest& request) {
+        TRACE_SPAN("server", "handle");
+        if (request.path == "/api/ride/request") {
+            if (request.method != "POST") return errorResponse(405, "Method not allowed");
+            return requestRide(request);
+        }
+        if (request.path == "/api/path/shortest") {
+            if (request.method != "POST") return errorResponse(405, "Method not allowed");
+            return shortestPath(request);
+        }
+        if (request.path == "/api/drivers") {
+            if (request.method != "GET") return errorResponse(405, "Method not allowed");
+            return listDrivers();
+        }
+        if (request.path == "/api/health") {
+            return health();
+        }
+        if (request.path == "/metrics") {
+            return HttpResponse(200, "text/plain; version=0.0.4",
+                                MetricsRegistry::global().toPrometheusText());
+        }
+        return errorResponse(404, "Endpoint not found");
+    }
+
+    const Graph& graph() const { return *cityData->graph; }
+
+    // Match with the distance table at path: mapped if it was built from
+    // this graph, otherwise built (on a temporary pool) and saved there
+    void useDistanceTable(const std::string& path) {
+        std::shared_ptr<const DistanceTable> table;
+        try {
+            table = DistanceTable::open(path);
+        } catch (const std::exception&) {
+            // Missing or unreadable: rebuilt below
+        }
+        if (!table || !matcher.setDistanceTable(table)) {
+            ThreadPool pool;
+            table = DistanceTable::build(graph(), DistanceTable::Precision::Float32, pool);
+            table->save(path);
+            matcher.setDistanceTable(table);
+            std::cout << "Built distance table " << path << " (" << table->sizeBytes() << " bytes)" << std::endl;
+        } else {
+            std::cout << "Mapped distance table " << path << std::endl;
+        }
+    }
+
+private:
+    std::unique_ptr<CityData> cityData;
+    RideMatcher matcher;
+
+    HttpResponse requestRide(const HttpRequest& request) {
+        JsonBody body;
+        if (!body.parse(request.body)) {
+            return errorResponse(400, "Request body must be a JSON object");
+        }
+        if (!body.has("passengerId") || !body.has("pickupLocation") || !body.has("destinationLocation")) {
+            return errorResponse(400, "passengerId, pickupLocation, and destinationLocation are required");
+        }
+
+        std::string passengerId;
+        int pickup = 0;
+        int destination = 0;
+        if (!body.readString("passengerId", passengerId) ||
+            !body.readInt("pickupLocation", pickup) ||
+            !body.readInt("destinationLocation", destination)) {
+            return errorResponse(400, "passengerId must be a non-empty string and locations integers");
+        }
+        if (!graph().nodeExists(pickup) || !graph().nodeExists(destination)) {
+            return errorResponse(400, "Invalid pickup or destination location");
+        }
+
+        RideMatch match = matcher.findRide(RideRequest("", pickup, destination, passengerId));
+
+        JsonWriter writer;
+        writer.beginObject();
+        writer.writeKey("success");
+        writer.writeBool(match.success);
+        writer.writeKey("data");
+        writer.beginObject();
+        if (!match.success) {
+            writer.writeKey("success");
+            writer.writeBool(false);
+            writer.writeKey("message");
+            writer.writeString(match.message);
+            writer.endObject();
+            writer.endObject();
+            return HttpResponse(404, "application/json", writer.release());
+        }
+
+        const Driver& driver = match.driver;
+        writer.writeKey("assignedDriver");
+        driver.writeJSON(writer);
+        writer.writeKey("driverToPickup");
+        writer.beginObject();
+        writer.writeKey("distance");
+        writer.writePrecision(match.distanceToPickup, NUMBER_PRECISION);
+        writer.writeKey("path");
+        writer.writeIntArray(match.pathToPickup);
+        writer.writeKey("eta");
+        writer.writeInt(match.estimatedTime);
+        writer.endObject();
+        writer.writeKey("pickupToDestination");
+        writer.beginObject();
+        writer.writeKey("distance");
+        writer.writePrecision(match.distanceToDestination, NUMBER_PRECISION);
+        writer.writeKey("path");
+        writer.writeIntArray(match.pathToDestination);
+        writer.writeKey("eta");
+        writer.writeInt(match.estimatedTime);
+        writer.endObject();
+        writer.writeKey("totalDistance");
+        writer.writePrecision(match.totalDistance, NUMBER_PRECISION);
+        writer.writeKey("totalETA");
+        writer.writeInt(match.estimatedTime);
+
+        // Same visualisation log lines the Express server produces
+        std::string line;
+
+        writer.writeKey("logs");
+        writer.beginObject();
+        writer.writeKey("dijkstra");
+        writer.beginArray();
+        writer.writeString(routeLine(line, driver.currentLocation, pickup));
+        writer.writeString(kmLine(line, "Found path with distance: ", match.distanceToPickup));
+        writer.writeString(routeLine(line, pickup, destination));
+        writer.writeString(kmLine(line, "Found path with distance: ", match.distanceToDestination));
+        writer.endArray();
+
+        writer.writeKey("heap");
+        writer.beginArray();
+        writer.writeString("Min-Heap used for priority queue in Dijkstra's algorithm");
+        writer.writeString(numberLine(line, "Processed ",
+                                      static_cast<long long>(match.pathToPickup.size()),
+                                      " nodes for driver-to-pickup route"));
+        writer.writeString(numberLine(line, "Processed ",
+                                      static_cast<long long>(match.pathToDestination.size()),
+                                      " nodes for pickup-to-destination route"));
+        writer.endArray();
+
+        writer.writeKey("matching");
+        writer.beginArray();
+        writer.writeString(numberLine(line, "Searching for available drivers near pickup location (Node ",
+                                      pickup, ")"));
+        writer.writeString("Found driver: " + driver.name + " (" + driver.id + ")");
+        writer.writeString(numberLine(line, "Driver location: Node ", driver.currentLocation, ""));
+        writer.writeString(kmLine(line, "Driver to pickup distance: ", match.distanceToPickup));
+        writer.writeString(kmLine(line, "Total trip distance: ", match.totalDistance));
+        writer.writeString(numberLine(line, "Estimated time: ", match.estimatedTime, " minutes"));
+        writer.writeString("Driver " + driver.name + " assigned successfully");
+        writer.endArray();
+        writer.endObject();
+
+        writer.endObject();
+        writer.endObject();
+        return HttpResponse(200, "application/json", writer.release());
+    }
+
+    HttpResponse shortestPath(const HttpRequest& request) {
+        JsonBody body;
+        if (!body.parse(request.body)) {
+            return errorResponse(400, "Request body must be a JSON object");
+        }
+        if (!body.has("source") || !body.has("destination")) {
+            return errorResponse(400, "source and destination are required");
+        }
+
+        int source = 0;
+        int destination = 0;
+        if (!body.readInt("source", source) || !body.readInt("destination", destination)) {
+            return errorResponse(400, "source and destination must be integers");
+        }
+        if (!graph().nodeExists(source) || !graph().nodeExists(destination)) {
+            return errorResponse(400, "Invalid source or destination node");
+        }
+
+        // Plain Dijkstra: unlike the Express route this does not reserve a driver
+        Dijkstra dijkstra(graph());
+        PathResult path = dijkstra.findShortestPath(source, destination);
+        if (!path.found) {
+            return errorResponse(404, "No path found");
+        }
+
+        JsonWriter writer;
+        writer.beginObject();
+        writer.writeKey("success");
+        writer.writeBool(true);
+        writer.writeKey("data");
+        writer.beginObject();
+        writer.writeKey("path");
+        writer.writeIntArray(path.path);
+        writer.writeKey("distance");
+        writer.writePrecision(path.totalDistance, NUMBER_PRECISION);
+        writer.writeKey("source");
+        writer.writeInt(source);
+        writer.writeKey("destination");
+        writer.writeInt(destination);
+        writer.writeKey("sourceNode");
+        writeNode(writer, graph().getNode(source));
+        writer.writeKey("destinationNode");
+        writeNode(writer, graph().getNode(destination));
+        writer.endObject();
+        writer.endObject();
+
+        return HttpResponse(200, "application/json", writer.release());
+    }
+
+    HttpResponse listDrivers() {
+        std::vector<Driver> drivers = matcher.getAllDrivers();
+
+        JsonWriter writer;
+        writer.beginObject();
+        writer.writeKey("success");
+        writer.writeBool(true);
+        writer.writeKey("data");
+        writer.beginArray();
+        for (const Driver& driver : drivers) {
+            driver.writeJSON(writer);
+        }
+        writer.endArray();
+        writer.endObject();
+
+        return HttpResponse(200, "application/json", writer.release());
+    }
+
+    HttpResponse health() {
+        MatcherStats stats = matcher.getStats();
+
+        JsonWriter writer;
+        writer.beginObject();
+        writer.writeKey("status");
+        writer.writeString("healthy");
+        writer.writeKey("backend");
+        writer.writeString("C++ Native Server");
+        writer.writeKey("graphNodes");
+        writer.writeInt(graph().getNumVertices());
+        writer.writeKey("totalDrivers");
+        writer.writeInt(stats.fleet.totalDrivers);
+        writer.writeKey("availableDrivers");
+        writer.writeInt(stats.fleet.availableDrivers);
+        writer.writeKey("busyDrivers");
+        writer.writeInt(stats.fleet.busyDrivers);
+        writer.writeKey("totalRequests");
+        writer.writeInt(stats.totalRequests);
+        writer.writeKey("successfulMatches");
+        writer.writeInt(stats.successfulMatches);
+        writer.writeKey("failedMatches");
+        writer.writeInt(stats.failedMatches);
+        writer.endObject();
+
+        return HttpResponse(200, "application/json", writer.release());
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int port = 3001;
+    int numNodes = 50;
+    std::string tracePath;
+    std::string tablePath;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) {
+            port = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--nodes") == 0) {
+            numNodes = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            tracePath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--distance-table") == 0) {
+            tablePath = argv[i + 1];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port N] [--nodes N] [--trace FILE]"
+                      << " [--distance-table FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    DispatchService service(numNodes);
+    if (!tablePath.empty()) {
+        try {
+            service.useDistanceTable(tablePath);
+        } catch (const std::exception& error) {
+            std::cerr << "Distance table unavailable: " << error.what() << std::endl;
+            return 1;
+        }
+    }
+    HttpServer server(port, [&service](const HttpRequest& request) {
+        return service.handle(request);
+    });
+
+    std::string error;
+    if (!server.start(error)) {
+        std::cerr << "Failed to start server: " << error << std::endl;
+        return 1;
+    }
+
+    activeServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::cout << "Uber Mini native dispatch server listening on port " << port
+              << " (" << numNodes << " nodes)" << std::endl;
+    server.run();
+    std::cout << "Server stopped" << std::endl;
+
+    if (!tracePath.empty()) {
+        if (!Tracer::isEnabled()) {
+            std::cerr << "Tracing was not compiled in (build with enable_tracing=true)" << std::endl;
+        } else if (Tracer::writeChromeTraceFile(tracePath)) {
+            std::cout << "Wrote " << Tracer::eventCount() << " trace events to " << tracePath << std::endl;
+        } else {
+            std::cerr << "Cannot write " << tracePath << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * betweenness.cpp
+ *
+ * Implementation of parallel Brandes betweenness centrality
+ */
+
+#include "include/betweenness.h"
+#include "include/routing_graph.h"
+#include "include/thread_pool.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace RideSharing {
+
+namespace {
+
+typedef RoutingGraph<uint32_t, double> SearchGraph;
+typedef std::function<void(size_t, size_t)> SourceChunk;
+typedef std::function<void(size_t, const SourceChunk&)> ChunkRunner;
+
+// Per-chunk search state and score sums
+class BrandesWorker {
+    const SearchGraph& graph;
+    std::vector<double> distance;
+    std::vector<double> sigma;      // Shortest paths from the source
+    std::vector<double> dependency; // Brandes' delta
+    std::vector<uint32_t> settled;  // In settle order
+
+public:
+    std::vector<double> nodeSums;
+    std::vector<double> edgeSums;
+
+    explicit BrandesWorker(const SearchGraph& routing)
+        : graph(routing),
+          distance(routing.numVertices(), std::numeric_limits<double>::infinity()),
+          sigma(routing.numVertices(), 0.0),
+          dependency(routing.numVertices(), 0.0),
+          nodeSums(routing.numVertices(), 0.0),
+          edgeSums(routing.numEdges(), 0.0) {
+        settled.reserve(routing.numVertices());
+    }
+
+    void addSource(uint32_t source) {
+        typedef std::pair<double, uint32_t> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+        settled.clear();
+        distance[source] = 0.0;
+        sigma[source] = 1.0;
+        heap.push(Entry(0.0, source));
+
+        while (!heap.empty()) {
+            Entry top = heap.top();
+            heap.pop();
+            uint32_t v = top.second;
+            if (top.first > distance[v]) {
+                continue;
+            }
+            settled.push_back(v);
+            // Every predecessor of v settled earlier, so sigma[v] is final
+            for (uint32_t e = graph.edgesBegin(v); e < graph.edgesEnd(v); ++e) {
+                uint32_t w = graph.target(e);
+                double candidate = top.first + graph.weight(e);
+                if (candidate < distance[w]) {
+                    distance[w] = candidate;
+                    sigma[w] = sigma[v];
+                    heap.push(Entry(candidate, w));
+                } else if (candidate == distance[w]) {
+                    sigma[w] += sigma[v];
+                }
+            }
+        }
+
+        // Reverse settle order: every successor's dependency is final
+        // before its predecessors read it
+        for (size_t i = settled.size(); i-- > 0;) {
+            uint32_t v = settled[i];
+            double sum = 0.0;
+            for (uint32_t e = graph.edgesBegin(v); e < graph.edgesEnd(v); ++e) {
+                uint32_t w = graph.target(e);
+                if (distance[v] + graph.weight(e) == distance[w]) {
+                    double share = sigma[v] / sigma[w] * (1.0 + dependency[w]);
+                    edgeSums[e] += share;
+                    sum += share;
+                }
+            }
+            dependency[v] = sum;
+            if (v != source) {
+                nodeSums[v] += sum;
+            }
+        }
+
+        // Reset only what this search touched
+        for (uint32_t v : settled) {
+            distance[v] = std::numeric_limits<double>::infinity();
+            sigma[v] = 0.0;
+            dependency[v] = 0.0;
+        }
+    }
+};
+
+// Hoeffding half-width for k samples, union-bounded over that many scores
+double hoeffdingEpsilon(size_t items, int samples, double delta) {
+    return std::sqrt(std::log(2.0 * static_cast<double>(items) / delta) / (2.0 * samples));
+}
+
+void checkDelta(double delta) {
+    if (!(delta > 0.0 && delta < 1.0)) {
+        throw std::invalid_argument("delta must be between 0 and 1");
+    }
+}
+
+// Sum the dependencies of sources [0, count) and normalise them; run
+// calls chunk(begin, end) over the sources, serially or on a pool
+BetweennessResult computeScores(const Graph& graph, const BetweennessOptions& options,
+                                const ChunkRunner& run) {
+    TRACE_SPAN("routing", "Betweenness::compute");
+    checkDelta(options.delta);
+
+    const SearchGraph routing = SearchGraph::fromGraph(graph);
+    const uint32_t numVertices = routing.numVertices();
+    const size_t numEdges = routing.numEdges();
+
+    std::vector<uint32_t> sources;
+    for (uint32_t v = 0; v < numVertices; ++v) {
+        if (graph.nodeExists(static_cast<int>(v))) {
+            sources.push_back(v);
+        }
+    }
+    const size_t n = sources.size();
+
+    BetweennessResult result;
+    result.exact = options.samples <= 0 || static_cast<size_t>(options.samples) >= n;
+    if (!result.exact) {
+        // Partial Fisher-Yates: the first k entries are a uniform sample
+        std::mt19937 rng(options.seed);
+        for (size_t i = 0; i < static_cast<size_t>(options.samples); ++i) {
+            std::uniform_int_distribution<size_t> pick(i, n - 1);
+            std::swap(sources[i], sources[pick(rng)]);
+        }
+        sources.resize(static_cast<size_t>(options.samples));
+    }
+    result.sourcesSearched = static_cast<int>(sources.size());
+
+    std::vector<double> nodeSums(numVertices, 0.0);
+    std::vector<double> edgeSums(numEdges, 0.0);
+    std::mutex mergeMutex;
+
+    run(sources.size(), [&](size_t begin, size_t end) {
+        BrandesWorker worker(routing);
+        for (size_t i = begin; i < end; ++i) {
+            worker.addSource(sources[i]);
+        }
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        for (uint32_t v = 0; v < numVertices; ++v) {
+            nodeSums[v] += worker.nodeSums[v];
+        }
+        for (size_t e = 0; e < numEdges; ++e) {
+            edgeSums[e] += worker.edgeSums[e];
+        }
+    });
+
+    // Sampled sums estimate the full sums once scaled by n / k
+    const double nodes = static_cast<double>(n);
+    const double scale = result.sourcesSearched > 0 ? nodes / result.sourcesSearched : 0.0;
+    const double nodePairs = (nodes - 1.0) * (nodes - 2.0);
+    const double edgePairs = nodes * (nodes - 1.0);
+
+    result.nodeScores.resize(numVertices);
+    for (uint32_t v = 0; v < numVertices; ++v) {
+        result.nodeScores[v] = nodePairs > 0.0 ? nodeSums[v] * scale / nodePairs : 0.0;
+    }
+    result.edgeSources.resize(numEdges);
+    result.edgeTargets.resize(numEdges);
+    result.edgeScores.resize(numEdges);
+    for (uint32_t v = 0; v < numVertices; ++v) {
+        for (uint32_t e = routing.edgesBegin(v); e < routing.edgesEnd(v); ++e) {
+            result.edgeSources[e] = static_cast<int>(v);
+            result.edgeTargets[e] = static_cast<int>(routing.target(e));
+            result.edgeScores[e] = edgePairs > 0.0 ? edgeSums[e] * scale / edgePairs : 0.0;
+        }
+    }
+
+    if (!result.exact) {
+        // One source adds at most n - 2 to a node and n - 1 to an edge, so
+        // per-source terms lie in [0, 1] once divided by those; the node
+        // estimate is n / (n - 1) times their mean
+        result.errorBound = nodes / (nodes - 1.0) *
+                            hoeffdingEpsilon(n + numEdges, result.sourcesSearched, options.delta);
+    }
+    return result;
+}
+
+} // namespace
+
+BetweennessResult Betweenness::compute(const Graph& graph, const BetweennessOptions& options,
+                                       ThreadPool& pool) {
+    return computeScores(graph, options, [&pool](size_t count, const SourceChunk& chunk) {
+        pool.parallelFor(0, count, 0, chunk);
+    });
+}
+
+BetweennessResult Betweenness::compute(const Graph& graph, const BetweennessOptions& options) {
+    return computeScores(graph, options, [](size_t count, const SourceChunk& chunk) {
+        if (count > 0) {
+            chunk(0, count);
+        }
+    });
+}
+
+int Betweenness::samplesFor(const Graph& graph, double epsilon, double delta) {
+    checkDelta(delta);
+    if (!(epsilon > 0.0)) {
+        throw std::invalid_argument("epsilon must be positive");
+    }
+    size_t n = 0;
+    for (int v = 0; v < graph.getNumVertices(); ++v) {
+        if (graph.nodeExists(v)) {
+            ++n;
+        }
+    }
+    if (n < 3) {
+        return static_cast<int>(std::max<size_t>(n, 1));
+    }
+    // Invert errorBound = n / (n - 1) * sqrt(ln(2 (n + E) / delta) / (2 k))
+    double nodes = static_cast<double>(n);
+    double target = epsilon * (nodes - 1.0) / nodes;
+    double items = static_cast<double>(n + graph.getNumDirectedEdges());
+    double samples = std::ceil(std::log(2.0 * items / delta) / (2.0 * target * target));
+    return static_cast<int>(std::min(samples, nodes));
+}
+
+} // namespace RideSharing
@@ -0,0 +1,206 @@
+/**
+ * cbor_encoder.cpp
+ *
+ * Implementation of the CBOR encoder
+ */
+
+#include "include/cbor_encoder.h"
+#include "include/trace.h"
+#include <cstring>
+
+namespace RideSharing {
+
+void CborWriter::writeHead(uint8_t majorType, uint64_t value) {
+    uint8_t major = static_cast<uint8_t>(majorType << 5);
+
+    if (value < 24) {
+        buffer.push_back(major | static_cast<uint8_t>(value));
+    } else if (value <= 0xff) {
+        buffer.push_back(major | 24);
+        buffer.push_back(static_cast<uint8_t>(value));
+    } else if (value <= 0xffff) {
+        buffer.push_back(major | 25);
+        buffer.push_back(static_cast<uint8_t>(value >> 8));
+        buffer.push_back(static_cast<uint8_t>(value));
+    } else if (value <= 0xffffffffULL) {
+        buffer.push_back(major | 26);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            buffer.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    } else {
+        buffer.push_back(major | 27);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            buffer.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+}
+
+void CborWriter::writeString(const std::string& value) {
+    writeHead(3, value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void CborWriter::writeInt(int64_t value) {
+    if (value >= 0) {
+        writeHead(0, static_cast<uint64_t>(value));
+    } else {
+        // Negative integers encode -1 - n
+        writeHead(1, static_cast<uint64_t>(-1 - value));
+    }
+}
+
+void CborWriter::writeDouble(double value) {
+    float narrow = static_cast<float>(value);
+    if (static_cast<double>(narrow) == value) {
+        uint32_t bits;
+        std::memcpy(&bits, &narrow, sizeof(bits));
+        buffer.push_back(0xfa);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            buffer.push_back(static_cast<uint8_t>(bits >> shift));
+        }
+        return;
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    buffer.push_back(0xfb);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        buffer.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+void CborWriter::writeUint8Array(const std::vector<uint8_t>& values) {
+    writeHead(6, 64);
+    writeHead(2, values.size());
+    buffer.insert(buffer.end(), values.begin(), values.end());
+}
+
+void CborWriter::writeInt32Array(const std::vector<int>& values) {
+    writeHead(6, 78);
+    writeHead(2, values.size() * 4);
+    for (int value : values) {
+        uint32_t bits = static_cast<uint32_t>(value);
+        for (int shift = 0; shift < 32; shift += 8) {
+            buffer.push_back(static_cast<uint8_t>(bits >> shift));
+        }
+    }
+}
+
+void CborWriter::writeFloat64Array(const std::vector<double>& values) {
+    writeHead(6, 86);
+    writeHead(2, values.size() * 8);
+    for (double value : values) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int shift = 0; shift < 64; shift += 8) {
+            buffer.push_back(static_cast<uint8_t>(bits >> shift));
+        }
+    }
+}
+
+void CborWriter::writeIntArray(const std::vector<int>& values) {
+    beginArray(values.size());
+    for (int value : values) {
+        writeInt(value);
+    }
+}
+
+void CborEncoder::writeDriver(CborWriter& writer, const Driver& driver) {
+    writer.beginMap(7);
+    writer.writeString("id");
+    writer.writeString(driver.id);
+    writer.writeString("name");
+    writer.writeString(driver.name);
+    writer.writeString("currentLocation");
+    writer.writeInt(driver.currentLocation);
+    writer.writeString("isAvailable");
+    writer.writeBool(driver.isAvailable);
+    writer.writeString("vehicleType");
+    writer.writeString(driver.vehicleType);
+    writer.writeString("rating");
+    writer.writeDouble(driver.rating);
+    writer.writeString("completedRides");
+    writer.writeInt(driver.completedRides);
+}
+
+std::vector<uint8_t> CborEncoder::encodeRideMatch(const RideMatch& match) {
+    TRACE_SPAN("serialize", "CborEncoder::encodeRideMatch");
+    CborWriter writer;
+
+    if (!match.success) {
+        writer.beginMap(2);
+        writer.writeString("success");
+        writer.writeBool(false);
+        writer.writeString("message");
+        writer.writeString(match.message);
+        return writer.release();
+    }
+
+    writer.beginMap(9);
+    writer.writeString("success");
+    writer.writeBool(true);
+    writer.writeString("message");
+    writer.writeString(match.message);
+    writer.writeString("driver");
+    writeDriver(writer, match.driver);
+    writer.writeString("distanceToPickup");
+    writer.writeDouble(match.distanceToPickup);
+    writer.writeString("distanceToDestination");
+    writer.writeDouble(match.distanceToDestination);
+    writer.writeString("totalDistance");
+    writer.writeDouble(match.totalDistance);
+    writer.writeString("estimatedTime");
+    writer.writeInt(match.estimatedTime);
+    writer.writeString("pathToPickup");
+    writer.writeIntArray(match.pathToPickup);
+    writer.writeString("pathToDestination");
+    writer.writeIntArray(match.pathToDestination);
+
+    return writer.release();
+}
+
+std::vector<uint8_t> CborEncoder::encodeDrivers(const std::vector<Driver>& drivers) {
+    TRACE_SPAN("serialize", "CborEncoder::encodeDrivers");
+    CborWriter writer;
+    writer.beginArray(drivers.size());
+    for (const Driver& driver : drivers) {
+        writeDriver(writer, driver);
+    }
+    return writer.release();
+}
+
+std::vector<uint8_t> CborEncoder::encodeGraph(const GraphColumns& columns, int numVertices) {
+    TRACE_SPAN("serialize", "CborEncoder::encodeGraph");
+    CborWriter writer;
+
+    writer.beginMap(11);
+    writer.writeString("numVertices");
+    writer.writeInt(numVertices);
+    writer.writeString("nodeIds");
+    writer.writeInt32Array(columns.nodeIds);
+    writer.writeString("latitudes");
+    writer.writeFloat64Array(columns.latitudes);
+    writer.writeString("longitudes");
+    writer.writeFloat64Array(columns.longitudes);
+    writer.writeString("nodeNameIds");
+    writer.writeInt32Array(columns.nodeNameIds);
+    writer.writeString("edgeSources");
+    writer.writeInt32Array(columns.edgeSources);
+    writer.writeString("edgeTargets");
+    writer.writeInt32Array(columns.edgeTargets);
+    writer.writeString("edgeWeights");
+    writer.writeFloat64Array(columns.edgeWeights);
+    writer.writeString("roadNameIds");
+    writer.writeInt32Array(columns.roadNameIds);
+    writer.writeString("roadClasses");
+    writer.writeUint8Array(columns.roadClasses);
+    writer.writeString("names");
+    writer.beginArray(columns.names.size());
+    for (const std::string& name : columns.names) {
+        writer.writeString(name);
+    }
+
+    return writer.release();
+}
+
+} // namespace RideSharing
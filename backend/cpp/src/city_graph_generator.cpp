@@ -14,6 +14,10 @@ namespace RideSharing {
 static std::random_device rd;
 static std::mt19937 gen(rd());
 
+void CityGraphGenerator::seed(unsigned int value) {
+    gen.seed(value);
+}
+
 std::vector<std::string> CityGraphGenerator::getAllLocationNames() {
     std::vector<std::string> allNames = {
         // Downtown
@@ -177,6 +181,9 @@ CityData* CityGraphGenerator::generateCityGraph(int numNodes) {
     // Ensure connectivity
     ensureConnectivity(cityData->graph);
 
+    // Label components now, so the first query does not pay for it
+    cityData->graph->components();
+
     // Add drivers
     cityData->drivers = generateDrivers();
 
@@ -195,7 +202,7 @@ void CityGraphGenerator::createHighways(Graph* graph, const std::vector<NodeData
         );
         double weight = distance * 80;
         std::string roadName = highwayNames[dis(gen)];
-        graph->addEdge(i, i + 5, weight, roadName);
+        graph->addEdge(i, i + 5, weight, roadName, RoadClass::Highway);
     }
 
     // Vertical highway
@@ -207,7 +214,7 @@ void CityGraphGenerator::createHighways(Graph* graph, const std::vector<NodeData
                 nodeData[i + verticalStep].lat, nodeData[i + verticalStep].lon
             );
             double weight = distance * 80;
-            graph->addEdge(i, i + verticalStep, weight, "Highway North-South");
+            graph->addEdge(i, i + verticalStep, weight, "Highway North-South", RoadClass::Highway);
         }
     }
 }
@@ -227,7 +234,7 @@ void CityGraphGenerator::createArterialRoads(Graph* graph, const std::vector<Nod
             if (distance > 1.0 && distance < 4.0 && probGen(gen) < 0.3) {
                 double weight = distance * 100;
                 std::string roadName = arterialNames[nameGen(gen)];
-                graph->addEdge(i, j, weight, roadName);
+                graph->addEdge(i, j, weight, roadName, RoadClass::Arterial);
             }
         }
     }
@@ -250,7 +257,7 @@ void CityGraphGenerator::createLocalStreets(Graph* graph, const std::vector<Node
                 double weight = distance * 120;
                 int streetNumber = numGen(gen);
                 std::string roadName = std::to_string(streetNumber) + getOrdinal(streetNumber) + " " + streetNames[nameGen(gen)];
-                graph->addEdge(i, j, weight, roadName);
+                graph->addEdge(i, j, weight, roadName, RoadClass::Local);
             }
         }
     }
@@ -289,7 +296,7 @@ void CityGraphGenerator::createRingRoads(Graph* graph, const std::vector<NodeDat
 
         if (distance < 3.0) {
             double weight = distance * 90;
-            graph->addEdge(nodeId1, nodeId2, weight, "Inner Ring Road");
+            graph->addEdge(nodeId1, nodeId2, weight, "Inner Ring Road", RoadClass::Ring);
         }
     }
 
@@ -306,7 +313,7 @@ void CityGraphGenerator::createRingRoads(Graph* graph, const std::vector<NodeDat
 
         if (distance < 4.0) {
             double weight = distance * 90;
-            graph->addEdge(nodeId1, nodeId2, weight, "Outer Ring Road");
+            graph->addEdge(nodeId1, nodeId2, weight, "Outer Ring Road", RoadClass::Ring);
         }
     }
 }
@@ -331,7 +338,7 @@ void CityGraphGenerator::createShortcuts(Graph* graph, const std::vector<NodeDat
             if (distance > 2.0 && distance < 6.0) {
                 double weight = distance * 85;
                 std::string roadName = shortcutNames[nameDis(gen)] + " " + std::to_string(i + 1);
-                graph->addEdge(node1, node2, weight, roadName);
+                graph->addEdge(node1, node2, weight, roadName, RoadClass::Connector);
             }
         }
     }
@@ -390,7 +397,8 @@ void CityGraphGenerator::ensureConnectivity(Graph* graph) {
         double distance = calculateDistance(n1.latitude, n1.longitude, n2.latitude, n2.longitude);
         double weight = distance * 100;
 
-        graph->addEdge(node1, node2, weight, "Connector Highway " + std::to_string(i + 1));
+        graph->addEdge(node1, node2, weight, "Connector Highway " + std::to_string(i + 1),
+                       RoadClass::Connector);
     }
 }
 
@@ -5,6 +5,11 @@
  */
 
 #include "include/dijkstra.h"
+#include "include/trace.h"
+#include "include/metrics.h"
+#include "include/thread_pool.h"
+#include "include/route_coalescer.h"
+#include "include/graph_components.h"
 #include <limits>
 #include <algorithm>
 #include <sstream>
@@ -12,53 +17,86 @@
 
 namespace RideSharing {
 
-Dijkstra::Dijkstra(const Graph& g) : graph(g) {}
+namespace {
 
-void Dijkstra::logStep(const std::string& message) {
-    executionLogs.push_back(message);
+// Nodes settled per search; the count doubles as the number of searches
+Histogram& nodesSettledHistogram() {
+    static Histogram& histogram = MetricsRegistry::global().histogram(
+        "ridesharing_dijkstra_nodes_settled", "Nodes settled per Dijkstra search",
+        {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000});
+    return histogram;
 }
 
-DijkstraResult Dijkstra::findShortestPaths(int source) {
-    DijkstraResult result;
-    executionLogs.clear();
+// Point-to-point queries answered from component labels without a search
+Counter& rejectedRoutesCounter() {
+    static Counter& counter = MetricsRegistry::global().counter(
+        "ridesharing_routes_rejected_unreachable_total",
+        "Route queries rejected by component labels without searching");
+    return counter;
+}
 
-    // Validate source
-    if (!graph.nodeExists(source)) {
-        result.success = false;
-        result.errorMessage = "Source node does not exist";
-        return result;
+// Backtrack from destination to source, then reverse into travel order
+template <typename Predecessors, typename Path>
+void tracePath(int source, int destination, const Predecessors& predecessors, Path& path) {
+    path.clear();
+    int current = destination;
+    while (current != -1) {
+        path.push_back(current);
+        if (current == source) break;
+        current = predecessors[current];
     }
+    std::reverse(path.begin(), path.end());
+}
+
+} // namespace
 
+Dijkstra::Dijkstra(const Graph& g, std::pmr::memory_resource* memory, bool verbose)
+    : graph(g), memory(memory), verbose(verbose), distances(memory), predecessors(memory) {
+    nodesSettledHistogram();
+    rejectedRoutesCounter();
+}
+
+void Dijkstra::logStep(std::string message) {
+    executionLogs.push_back(std::move(message));
+}
+
+bool Dijkstra::runSearch(int source, std::string& errorMessage,
+                         std::vector<std::string>* heapLogs) {
     int n = graph.getNumVertices();
-    result.distances.assign(n, std::numeric_limits<double>::infinity());
-    result.predecessors.assign(n, -1);
+    distances.assign(n, std::numeric_limits<double>::infinity());
+    predecessors.assign(n, -1);
 
     // Initialize
-    result.distances[source] = 0.0;
-    MinHeap pq;
+    distances[source] = 0.0;
+    MinHeap pq(memory, verbose && heapLogs != nullptr);
     pq.insert(source, 0.0);
 
     std::ostringstream log;
-    log << "Starting Dijkstra from node " << source;
-    logStep(log.str());
+    if (verbose) {
+        log << "Starting Dijkstra from node " << source;
+        logStep(log.str());
+    }
 
     int nodesProcessed = 0;
 
+    TRACE_BEGIN(settleLoop);
     while (!pq.isEmpty()) {
         HeapNode current = pq.extractMin();
         int u = current.vertex;
         double dist = current.distance;
 
         // Skip if we've already found a better path
-        if (dist > result.distances[u]) {
+        if (dist > distances[u]) {
             continue;
         }
 
         nodesProcessed++;
-        log.str("");
-        log << "Processing node " << u << " with distance "
-            << std::fixed << std::setprecision(2) << dist;
-        logStep(log.str());
+        if (verbose) {
+            log.str("");
+            log << "Processing node " << u << " with distance "
+                << std::fixed << std::setprecision(2) << dist;
+            logStep(log.str());
+        }
 
         // Explore neighbors
         try {
@@ -67,41 +105,72 @@ DijkstraResult Dijkstra::findShortestPaths(int source) {
             for (const Edge& edge : neighbors) {
                 int v = edge.destination;
                 double weight = edge.weight;
-                double newDist = result.distances[u] + weight;
-
-                if (newDist < result.distances[v]) {
-                    log.str("");
-                    log << "  Relaxing edge " << u << " -> " << v
-                        << ": distance updated from "
-                        << std::fixed << std::setprecision(2) << result.distances[v]
-                        << " to " << newDist;
-                    logStep(log.str());
-
-                    result.distances[v] = newDist;
-                    result.predecessors[v] = u;
+                double newDist = distances[u] + weight;
+
+                if (newDist < distances[v]) {
+                    if (verbose) {
+                        log.str("");
+                        log << "  Relaxing edge " << u << " -> " << v
+                            << ": distance updated from "
+                            << std::fixed << std::setprecision(2) << distances[v]
+                            << " to " << newDist;
+                        logStep(log.str());
+                    }
+
+                    distances[v] = newDist;
+                    predecessors[v] = u;
                     pq.decreaseKey(v, newDist);
                 }
             }
         } catch (const std::exception& e) {
-            result.success = false;
-            result.errorMessage = std::string("Error processing node: ") + e.what();
-            return result;
+            errorMessage = std::string("Error processing node: ") + e.what();
+            return false;
         }
     }
+    TRACE_END(settleLoop, "heap", "dijkstra.settleLoop");
+    nodesSettledHistogram().observe(nodesProcessed);
 
-    log.str("");
-    log << "Dijkstra completed. Processed " << nodesProcessed << " nodes.";
-    logStep(log.str());
+    if (verbose) {
+        log.str("");
+        log << "Dijkstra completed. Processed " << nodesProcessed << " nodes.";
+        logStep(log.str());
+    }
+
+    if (heapLogs != nullptr) {
+        *heapLogs = pq.getLogs();
+    }
+    return true;
+}
+
+DijkstraResult Dijkstra::findShortestPaths(int source) {
+    TRACE_SPAN("dijkstra", "findShortestPaths");
+    DijkstraResult result;
+    executionLogs.clear();
+
+    // Validate source
+    if (!graph.nodeExists(source)) {
+        result.success = false;
+        result.errorMessage = "Source node does not exist";
+        return result;
+    }
+
+    std::vector<std::string> heapLogs;
+    result.success = runSearch(source, result.errorMessage, &heapLogs);
+    result.distances.assign(distances.begin(), distances.end());
+    result.predecessors.assign(predecessors.begin(), predecessors.end());
+    if (!result.success) {
+        return result;
+    }
 
     // Copy heap logs
     result.logs = executionLogs;
-    auto heapLogs = pq.getLogs();
     result.logs.insert(result.logs.end(), heapLogs.begin(), heapLogs.end());
 
     return result;
 }
 
 PathResult Dijkstra::findShortestPath(int source, int destination) {
+    TRACE_SPAN("dijkstra", "findShortestPath");
     PathResult pathResult;
     executionLogs.clear();
 
@@ -115,26 +184,41 @@ PathResult Dijkstra::findShortestPath(int source, int destination) {
         return pathResult;
     }
 
-    // Run Dijkstra
-    DijkstraResult dijkstraResult = findShortestPaths(source);
+    // Endpoints in different components (or a destination upstream of
+    // the source's SCC) cannot be connected: skip the search
+    if (!graph.components()->mayReach(source, destination)) {
+        rejectedRoutesCounter().inc();
+        pathResult.found = false;
+        if (verbose) {
+            std::ostringstream log;
+            log << "No path found from " << source << " to " << destination
+                << " (not reachable by component labels)";
+            logStep(log.str());
+        }
+        return pathResult;
+    }
 
-    if (!dijkstraResult.success) {
+    // Run Dijkstra (the heap's logs are not part of a path result)
+    std::string errorMessage;
+    if (!runSearch(source, errorMessage, nullptr)) {
         pathResult.found = false;
         return pathResult;
     }
 
     // Check if destination is reachable
-    if (dijkstraResult.distances[destination] == std::numeric_limits<double>::infinity()) {
+    if (distances[destination] == std::numeric_limits<double>::infinity()) {
         pathResult.found = false;
-        std::ostringstream log;
-        log << "No path found from " << source << " to " << destination;
-        logStep(log.str());
+        if (verbose) {
+            std::ostringstream log;
+            log << "No path found from " << source << " to " << destination;
+            logStep(log.str());
+        }
         return pathResult;
     }
 
     // Reconstruct path
-    pathResult.path = reconstructPath(source, destination, dijkstraResult.predecessors);
-    pathResult.totalDistance = dijkstraResult.distances[destination];
+    tracePath(source, destination, predecessors, pathResult.path);
+    pathResult.totalDistance = distances[destination];
     pathResult.estimatedTime = calculateETA(pathResult.totalDistance);
     pathResult.found = true;
 
@@ -152,35 +236,50 @@ PathResult Dijkstra::findShortestPath(int source, int destination) {
         }
     }
 
-    std::ostringstream log;
-    log << "Path found: ";
-    for (size_t i = 0; i < pathResult.path.size(); ++i) {
-        if (i > 0) log << " -> ";
-        log << pathResult.path[i];
+    if (verbose) {
+        std::ostringstream log;
+        log << "Path found: ";
+        for (size_t i = 0; i < pathResult.path.size(); ++i) {
+            if (i > 0) log << " -> ";
+            log << pathResult.path[i];
+        }
+        log << " (Distance: " << std::fixed << std::setprecision(2)
+            << pathResult.totalDistance << " km, ETA: "
+            << std::setprecision(1) << pathResult.estimatedTime << " min)";
+        logStep(log.str());
     }
-    log << " (Distance: " << std::fixed << std::setprecision(2)
-        << pathResult.totalDistance << " km, ETA: "
-        << std::setprecision(1) << pathResult.estimatedTime << " min)";
-    logStep(log.str());
 
     return pathResult;
 }
 
-std::vector<int> Dijkstra::reconstructPath(int source, int destination,
-                                           const std::vector<int>& predecessors) {
-    std::vector<int> path;
+bool Dijkstra::findRoute(int source, int destination, double& distance,
+                         std::pmr::vector<int>& path) {
+    TRACE_SPAN("dijkstra", "findRoute");
+    executionLogs.clear();
 
-    // Backtrack from destination to source
-    int current = destination;
-    while (current != -1) {
-        path.push_back(current);
-        if (current == source) break;
-        current = predecessors[current];
+    if (!graph.nodeExists(source) || !graph.nodeExists(destination)) {
+        return false;
+    }
+    if (!graph.components()->mayReach(source, destination)) {
+        rejectedRoutesCounter().inc();
+        return false;
     }
 
-    // Reverse to get path from source to destination
-    std::reverse(path.begin(), path.end());
+    std::string errorMessage;
+    if (!runSearch(source, errorMessage, nullptr) ||
+        distances[destination] == std::numeric_limits<double>::infinity()) {
+        return false;
+    }
+
+    distance = distances[destination];
+    tracePath(source, destination, predecessors, path);
+    return true;
+}
 
+std::vector<int> Dijkstra::reconstructPath(int source, int destination,
+                                           const std::vector<int>& predecessors) {
+    std::vector<int> path;
+    tracePath(source, destination, predecessors, path);
     return path;
 }
 
@@ -189,4 +288,29 @@ double Dijkstra::calculateETA(double distance, double avgSpeedKmh) {
     return (distance / avgSpeedKmh) * 60.0;
 }
 
+void Dijkstra::findRouteDistances(const Graph& graph, const int* sources, const int* targets,
+                                  size_t count, double* distances, ThreadPool& pool) {
+    TRACE_SPAN("dijkstra", "findRouteDistances");
+    pool.parallelFor(0, count, 0, [&](size_t begin, size_t end) {
+        // One quiet search instance per chunk, reusing its scratch
+        std::pmr::unsynchronized_pool_resource arena;
+        Dijkstra dijkstra(graph, &arena, false);
+        std::pmr::vector<int> path(&arena);
+        for (size_t i = begin; i < end; ++i) {
+            // Identical pairs searched at the same time by other workers
+            // (or other callers) share one search
+            int source = sources[i];
+            int destination = targets[i];
+            RouteCoalescer::RoutePtr route = RouteCoalescer::global().route(
+                graph, source, destination, [&](SharedRoute& shared) {
+                    shared.found = dijkstra.findRoute(source, destination, shared.distance, path);
+                    if (shared.found) {
+                        shared.path.assign(path.begin(), path.end());
+                    }
+                });
+            distances[i] = route->found ? route->distance : std::numeric_limits<double>::infinity();
+        }
+    });
+}
+
 } // namespace RideSharing
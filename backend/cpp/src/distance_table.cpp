@@ -0,0 +1,378 @@
+/**
+ * distance_table.cpp
+ *
+ * Implementation of the all-pairs distance table: parallel build, file
+ * image and lookups
+ */
+
+#include "include/distance_table.h"
+#include "include/routing_graph.h"
+#include "include/thread_pool.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace RideSharing {
+
+namespace {
+
+const char MAGIC[8] = {'R', 'S', 'D', 'T', 'A', 'B', 'L', 'E'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t precision;
+    uint32_t numVertices;
+    uint32_t reserved;
+    uint64_t fingerprint;
+    double scale;
+    uint64_t distancesOffset;
+    uint64_t nextHopsOffset;
+    uint64_t fileBytes;
+};
+
+static_assert(sizeof(FileHeader) == 64, "Distance table header must be 64 bytes");
+
+size_t distanceBytes(DistanceTable::Precision precision) {
+    return precision == DistanceTable::Precision::Float32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+// Header for a table of numVertices nodes, with the arrays laid out after it
+FileHeader makeHeader(int numVertices, DistanceTable::Precision precision) {
+    size_t pairs = static_cast<size_t>(numVertices) * numVertices;
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = DistanceTable::VERSION;
+    header.precision = static_cast<uint32_t>(precision);
+    header.numVertices = static_cast<uint32_t>(numVertices);
+    header.scale = 1.0;
+    header.distancesOffset = sizeof(FileHeader);
+    // Keep the next hops 8-byte aligned whatever the distance width
+    header.nextHopsOffset = (header.distancesOffset + pairs * distanceBytes(precision) + 7) & ~uint64_t(7);
+    header.fileBytes = header.nextHopsOffset + pairs * sizeof(uint16_t);
+    return header;
+}
+
+// First hop from source towards every node, from the search's
+// shortest-path tree (each node's hop is its ancestor just below source)
+template <typename Search>
+void fillNextHops(uint32_t source, const Search& search,
+                  const std::vector<typename Search::Distance>& distances,
+                  std::vector<uint32_t>& firstHop, std::vector<uint32_t>& chain, uint16_t* row) {
+    typedef typename Search::SearchGraph SearchGraph;
+    const std::vector<uint32_t>& predecessors = search.getPredecessors();
+    const uint32_t n = static_cast<uint32_t>(distances.size());
+    firstHop.assign(n, SearchGraph::NO_NODE);
+
+    for (uint32_t target = 0; target < n; ++target) {
+        if (target == source || distances[target] == Search::UNREACHABLE) {
+            row[target] = DistanceTable::NO_HOP;
+            continue;
+        }
+        // Climb until a node whose hop is known, or a child of source
+        uint32_t v = target;
+        chain.clear();
+        while (firstHop[v] == SearchGraph::NO_NODE && predecessors[v] != source) {
+            chain.push_back(v);
+            v = predecessors[v];
+        }
+        uint32_t hop = firstHop[v] != SearchGraph::NO_NODE ? firstHop[v] : v;
+        firstHop[v] = hop;
+        for (uint32_t u : chain) {
+            firstHop[u] = hop;
+        }
+        row[target] = static_cast<uint16_t>(hop);
+    }
+}
+
+} // namespace
+
+DistanceTable::DistanceTable()
+    : mapping(nullptr), mappingBytes(0), image(nullptr), imageBytes(0), vertices(0),
+      precision(Precision::Float32), scale(1.0), graphFingerprint(0),
+      floatDistances(nullptr), unitDistances(nullptr), nextHops(nullptr) {}
+
+DistanceTable::~DistanceTable() {
+#ifndef _WIN32
+    if (mapping != nullptr) {
+        munmap(mapping, mappingBytes);
+    }
+#endif
+}
+
+void DistanceTable::attach(const uint8_t* data, size_t bytes) {
+    if (bytes < sizeof(FileHeader)) {
+        throw std::runtime_error("Distance table is truncated");
+    }
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a distance table");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("Unsupported distance table version");
+    }
+    if (header.precision > static_cast<uint32_t>(Precision::UInt16) ||
+        header.numVertices > static_cast<uint32_t>(MAX_VERTICES)) {
+        throw std::runtime_error("Corrupt distance table header");
+    }
+
+    Precision tablePrecision = static_cast<Precision>(header.precision);
+    FileHeader expected = makeHeader(static_cast<int>(header.numVertices), tablePrecision);
+    if (header.distancesOffset != expected.distancesOffset ||
+        header.nextHopsOffset != expected.nextHopsOffset ||
+        header.fileBytes != expected.fileBytes || header.fileBytes != bytes) {
+        throw std::runtime_error("Distance table size does not match its header");
+    }
+
+    image = data;
+    imageBytes = bytes;
+    vertices = static_cast<int>(header.numVertices);
+    precision = tablePrecision;
+    scale = header.scale;
+    graphFingerprint = header.fingerprint;
+    const uint8_t* distances = data + header.distancesOffset;
+    floatDistances = precision == Precision::Float32 ? reinterpret_cast<const float*>(distances) : nullptr;
+    unitDistances = precision == Precision::UInt16 ? reinterpret_cast<const uint16_t*>(distances) : nullptr;
+    nextHops = reinterpret_cast<const uint16_t*>(data + header.nextHopsOffset);
+}
+
+std::shared_ptr<const DistanceTable> DistanceTable::build(const Graph& graph, Precision precision,
+                                                          ThreadPool& pool) {
+    TRACE_SPAN("routing", "DistanceTable::build");
+    typedef RoutingGraph<uint32_t, double> SearchGraph;
+    typedef RoutingSearch<uint32_t, double> Search;
+
+    const int n = graph.getNumVertices();
+    if (n > MAX_VERTICES) {
+        throw std::invalid_argument("Distance tables are limited to 65535 nodes");
+    }
+    const size_t pairs = static_cast<size_t>(n) * n;
+
+    std::shared_ptr<DistanceTable> table(new DistanceTable());
+    FileHeader header = makeHeader(n, precision);
+    header.fingerprint = fingerprint(graph);
+    table->storage.assign(header.fileBytes, 0);
+    uint8_t* data = table->storage.data();
+    uint16_t* hops = reinterpret_cast<uint16_t*>(data + header.nextHopsOffset);
+
+    // Float rows go straight into the image; quantised rows need the
+    // longest distance first, so they are staged as float
+    std::vector<float> staged(precision == Precision::UInt16 ? pairs : 0);
+    float* rows = precision == Precision::Float32 ? reinterpret_cast<float*>(data + header.distancesOffset)
+                                                  : staged.data();
+
+    // Endpoints without a node are unreachable, as in Dijkstra::findRoute
+    std::vector<char> exists(n);
+    for (int v = 0; v < n; ++v) {
+        exists[v] = graph.nodeExists(v) ? 1 : 0;
+    }
+
+    const SearchGraph routing = SearchGraph::fromGraph(graph);
+    const float unreachable = std::numeric_limits<float>::infinity();
+    std::vector<double> rowLongest(n, 0.0);
+
+    pool.parallelFor(0, static_cast<size_t>(n), 0, [&](size_t begin, size_t end) {
+        Search search(routing);
+        std::vector<uint32_t> firstHop;
+        std::vector<uint32_t> chain;
+        for (size_t s = begin; s < end; ++s) {
+            float* row = rows + s * n;
+            uint16_t* hopRow = hops + s * n;
+            if (!exists[s]) {
+                std::fill(row, row + n, unreachable);
+                std::fill(hopRow, hopRow + n, NO_HOP);
+                continue;
+            }
+
+            const std::vector<Search::Distance>& distances = search.oneToAll(static_cast<uint32_t>(s));
+            fillNextHops(static_cast<uint32_t>(s), search, distances, firstHop, chain, hopRow);
+            double longest = 0.0;
+            for (int t = 0; t < n; ++t) {
+                if (!exists[t] || distances[t] == Search::UNREACHABLE) {
+                    row[t] = unreachable;
+                    hopRow[t] = NO_HOP;
+                } else {
+                    row[t] = static_cast<float>(distances[t]);
+                    longest = std::max(longest, distances[t]);
+                }
+            }
+            rowLongest[s] = longest;
+        }
+    });
+
+    if (precision == Precision::UInt16) {
+        double longest = n > 0 ? *std::max_element(rowLongest.begin(), rowLongest.end()) : 0.0;
+        // UNREACHABLE_UNITS is reserved, so the longest distance maps to one below it
+        header.scale = longest > 0.0 ? (UNREACHABLE_UNITS - 1) / longest : 1.0;
+        uint16_t* units = reinterpret_cast<uint16_t*>(data + header.distancesOffset);
+        const double unitScale = header.scale;
+        pool.parallelFor(0, pairs, 0, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double value = staged[i];
+                units[i] = std::isinf(value)
+                    ? UNREACHABLE_UNITS
+                    : static_cast<uint16_t>(std::min<double>(UNREACHABLE_UNITS - 1,
+                                                             std::lround(value * unitScale)));
+            }
+        });
+    }
+
+    std::memcpy(data, &header, sizeof(header));
+    table->attach(data, table->storage.size());
+    return table;
+}
+
+std::shared_ptr<const DistanceTable> DistanceTable::open(const std::string& path) {
+    TRACE_SPAN("routing", "DistanceTable::open");
+    std::shared_ptr<DistanceTable> table(new DistanceTable());
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open distance table " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read distance table " + path);
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map distance table " + path);
+    }
+    table->mapping = mapped;
+    table->mappingBytes = bytes;
+    table->attach(static_cast<const uint8_t*>(mapped), bytes);
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open distance table " + path);
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    table->storage.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t read = std::fread(table->storage.data(), 1, table->storage.size(), file);
+    std::fclose(file);
+    if (size <= 0 || read != table->storage.size()) {
+        throw std::runtime_error("Cannot read distance table " + path);
+    }
+    table->attach(table->storage.data(), table->storage.size());
+#endif
+    return table;
+}
+
+void DistanceTable::save(const std::string& path) const {
+    TRACE_SPAN("routing", "DistanceTable::save");
+    // Write beside the target and rename over it, so tables already mapped
+    // from path keep their (unlinked) file instead of seeing it truncated
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot create distance table " + temporary);
+    }
+    size_t written = std::fwrite(image, 1, imageBytes, file);
+    bool closed = std::fclose(file) == 0;
+    if (written != imageBytes || !closed) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write distance table " + temporary);
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file here (and nothing is mapped)
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot replace distance table " + path);
+    }
+}
+
+uint64_t DistanceTable::fingerprint(const Graph& graph) {
+    // FNV-1a over the vertex count and every (source, destination, weight)
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            hash ^= (value >> shift) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+
+    mix(static_cast<uint64_t>(graph.getNumVertices()));
+    for (int v = 0; v < graph.getNumVertices(); ++v) {
+        mix(graph.nodeExists(v) ? 1 : 0);
+        for (const Edge& edge : graph.getAdjacentNodes(v)) {
+            uint64_t weightBits;
+            std::memcpy(&weightBits, &edge.weight, sizeof(weightBits));
+            mix((static_cast<uint64_t>(v) << 32) | static_cast<uint32_t>(edge.destination));
+            mix(weightBits);
+        }
+    }
+    return hash;
+}
+
+bool DistanceTable::matches(const Graph& graph) const {
+    return graph.getNumVertices() == vertices && fingerprint(graph) == graphFingerprint;
+}
+
+double DistanceTable::distance(int source, int target) const {
+    if (source < 0 || source >= vertices || target < 0 || target >= vertices) {
+        return std::numeric_limits<double>::infinity();
+    }
+    size_t index = static_cast<size_t>(source) * vertices + target;
+    if (precision == Precision::Float32) {
+        return floatDistances[index];
+    }
+    uint16_t units = unitDistances[index];
+    return units == UNREACHABLE_UNITS ? std::numeric_limits<double>::infinity() : units / scale;
+}
+
+int DistanceTable::nextHop(int source, int target) const {
+    if (source < 0 || source >= vertices || target < 0 || target >= vertices) {
+        return -1;
+    }
+    uint16_t hop = nextHops[static_cast<size_t>(source) * vertices + target];
+    return hop == NO_HOP ? -1 : hop;
+}
+
+bool DistanceTable::path(int source, int target, std::vector<int>& out) const {
+    out.clear();
+    if (std::isinf(distance(source, target))) {
+        return false;
+    }
+    out.push_back(source);
+    // Every hop lies on a shortest path, so at most V - 1 steps are needed
+    for (int v = source; v != target;) {
+        v = nextHop(v, target);
+        if (v < 0 || out.size() >= static_cast<size_t>(vertices)) {
+            out.clear();
+            return false;
+        }
+        out.push_back(v);
+    }
+    return true;
+}
+
+double DistanceTable::maxError() const {
+    if (precision != Precision::UInt16) {
+        return 0.0;
+    }
+    // Half a unit, plus the float rounding of the staged distances (at
+    // most 2^-24 of the longest one, which is UNREACHABLE_UNITS - 1 units)
+    return (0.5 + (UNREACHABLE_UNITS - 1) * std::ldexp(1.0, -24)) / scale;
+}
+
+} // namespace RideSharing
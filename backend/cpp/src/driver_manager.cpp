@@ -5,39 +5,136 @@
  */
 
 #include "include/driver_manager.h"
+#include "include/trace.h"
+#include "include/metrics.h"
 #include <sstream>
 #include <iomanip>
 
 namespace RideSharing {
 
+namespace {
+
+// Update rates come from rate() over these counters
+struct DriverMetrics {
+    Counter& locationUpdates;
+    Counter& availabilityUpdates;
+
+    DriverMetrics()
+        : locationUpdates(MetricsRegistry::global().counter(
+              "ridesharing_driver_location_updates_total", "Driver location updates applied")),
+          availabilityUpdates(MetricsRegistry::global().counter(
+              "ridesharing_driver_availability_updates_total", "Driver availability updates applied")) {}
+};
+
+DriverMetrics& driverMetrics() {
+    static DriverMetrics metrics;
+    return metrics;
+}
+
+} // namespace
+
 std::string Driver::toJSON() const {
-    std::ostringstream oss;
-    oss << "{\"id\":\"" << id << "\""
-        << ",\"name\":\"" << name << "\""
-        << ",\"currentLocation\":" << currentLocation
-        << ",\"isAvailable\":" << (isAvailable ? "true" : "false")
-        << ",\"vehicleType\":\"" << vehicleType << "\""
-        << ",\"rating\":" << std::fixed << std::setprecision(1) << rating
-        << ",\"completedRides\":" << completedRides << "}";
-    return oss.str();
+    JsonWriter writer;
+    writeJSON(writer);
+    return writer.release();
 }
 
-DriverManager::DriverManager() {}
+void Driver::writeJSON(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.writeKey("id");
+    writer.writeString(id);
+    writer.writeKey("name");
+    writer.writeString(name);
+    writer.writeKey("currentLocation");
+    writer.writeInt(currentLocation);
+    writer.writeKey("isAvailable");
+    writer.writeBool(isAvailable);
+    writer.writeKey("vehicleType");
+    writer.writeString(vehicleType);
+    writer.writeKey("rating");
+    writer.writeFixed(rating, 1);
+    writer.writeKey("completedRides");
+    writer.writeInt(completedRides);
+    writer.endObject();
+}
+
+DriverManager::DriverManager() : availableCount(0) {
+    driverMetrics(); // register before the first update so scrapes see zeros
+}
 
 void DriverManager::logOperation(const std::string& operation) {
     operationLogs.push_back(operation);
 }
 
+Driver* DriverManager::slotForHandle(int handle) {
+    if (handle < 0) {
+        return nullptr;
+    }
+    int slot = handle & (MAX_SLOTS - 1);
+    if (slot >= static_cast<int>(driverTable.size()) ||
+        slotGenerations[slot] != (handle >> HANDLE_SLOT_BITS)) {
+        return nullptr;
+    }
+    Driver* driver = &driverTable[slot];
+    // Released slots keep an empty ID until they are reused
+    return driver->id.empty() ? nullptr : driver;
+}
+
+int DriverManager::insertDriver(const Driver& driver) {
+    // Reuse a released slot before growing the table
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        driverTable[slot] = driver;
+    } else if (driverTable.size() < static_cast<size_t>(MAX_SLOTS)) {
+        slot = static_cast<int>(driverTable.size());
+        driverTable.push_back(driver);
+        slotGenerations.push_back(0);
+    } else {
+        return -1;
+    }
+    driverIndex[driver.id] = slot;
+
+    VehicleClassCounts& counts = vehicleCounts[driver.vehicleType];
+    counts.total++;
+    if (driver.isAvailable) {
+        counts.available++;
+        availableCount++;
+    }
+
+    return handleForSlot(slot);
+}
+
+void DriverManager::setAvailability(Driver& driver, bool available) {
+    if (driver.isAvailable == available) {
+        return;
+    }
+
+    int delta = available ? 1 : -1;
+    availableCount += delta;
+    vehicleCounts[driver.vehicleType].available += delta;
+    driver.isAvailable = available;
+}
+
 bool DriverManager::addDriver(const Driver& driver) {
+    if (driver.id.empty()) {
+        logOperation("Failed to add driver: empty ID");
+        return false;
+    }
+
     // Check if driver already exists
-    if (drivers.find(driver.id) != drivers.end()) {
+    if (driverIndex.find(driver.id) != driverIndex.end()) {
         std::ostringstream log;
         log << "Failed to add driver " << driver.id << ": already exists";
         logOperation(log.str());
         return false;
     }
 
-    drivers[driver.id] = driver;
+    if (insertDriver(driver) < 0) {
+        logOperation("Failed to add driver " + driver.id + ": driver table is full");
+        return false;
+    }
 
     std::ostringstream log;
     log << "Added driver " << driver.id << " (" << driver.name
@@ -47,16 +144,60 @@ bool DriverManager::addDriver(const Driver& driver) {
     return true;
 }
 
+std::vector<int> DriverManager::addDrivers(const std::vector<Driver>& batch) {
+    std::vector<int> handles;
+    handles.reserve(batch.size());
+    driverTable.reserve(driverTable.size() + batch.size());
+    slotGenerations.reserve(slotGenerations.size() + batch.size());
+    driverIndex.reserve(driverIndex.size() + batch.size());
+
+    int added = 0;
+    for (const Driver& driver : batch) {
+        if (driver.id.empty() || driverIndex.find(driver.id) != driverIndex.end()) {
+            handles.push_back(-1);
+            continue;
+        }
+
+        int handle = insertDriver(driver);
+        handles.push_back(handle);
+        if (handle >= 0) {
+            added++;
+        }
+    }
+
+    std::ostringstream log;
+    log << "Batch added " << added << " of " << batch.size() << " drivers";
+    logOperation(log.str());
+
+    return handles;
+}
+
 bool DriverManager::removeDriver(const std::string& driverId) {
-    auto it = drivers.find(driverId);
-    if (it == drivers.end()) {
+    auto it = driverIndex.find(driverId);
+    if (it == driverIndex.end()) {
         std::ostringstream log;
         log << "Failed to remove driver " << driverId << ": not found";
         logOperation(log.str());
         return false;
     }
 
-    drivers.erase(it);
+    int slot = it->second;
+    Driver& driver = driverTable[slot];
+
+    auto counts = vehicleCounts.find(driver.vehicleType);
+    if (driver.isAvailable) {
+        availableCount--;
+        counts->second.available--;
+    }
+    if (--counts->second.total == 0) {
+        vehicleCounts.erase(counts);
+    }
+
+    // Outstanding handles to this slot no longer match its generation
+    driver = Driver();
+    slotGenerations[slot] = static_cast<uint16_t>((slotGenerations[slot] + 1) % MAX_GENERATION);
+    freeSlots.push_back(slot);
+    driverIndex.erase(it);
 
     std::ostringstream log;
     log << "Removed driver " << driverId;
@@ -65,25 +206,38 @@ bool DriverManager::removeDriver(const std::string& driverId) {
     return true;
 }
 
-Driver* DriverManager::getDriver(const std::string& driverId) {
-    auto it = drivers.find(driverId);
-    if (it == drivers.end()) {
+Driver* DriverManager::getDriver(std::string_view driverId) {
+    auto it = driverIndex.find(driverId);
+    if (it == driverIndex.end()) {
         return nullptr;
     }
-    return &(it->second);
+    return &driverTable[it->second];
+}
+
+Driver* DriverManager::getDriverByHandle(int handle) {
+    return slotForHandle(handle);
+}
+
+int DriverManager::getDriverHandle(std::string_view driverId) const {
+    auto it = driverIndex.find(driverId);
+    if (it == driverIndex.end()) {
+        return -1;
+    }
+    return handleForSlot(it->second);
 }
 
 bool DriverManager::updateDriverLocation(const std::string& driverId, int newLocation) {
-    auto it = drivers.find(driverId);
-    if (it == drivers.end()) {
+    Driver* driver = getDriver(driverId);
+    if (driver == nullptr) {
         std::ostringstream log;
         log << "Failed to update location for driver " << driverId << ": not found";
         logOperation(log.str());
         return false;
     }
 
-    int oldLocation = it->second.currentLocation;
-    it->second.currentLocation = newLocation;
+    int oldLocation = driver->currentLocation;
+    driver->currentLocation = newLocation;
+    driverMetrics().locationUpdates.inc();
 
     std::ostringstream log;
     log << "Updated driver " << driverId << " location from "
@@ -94,15 +248,16 @@ bool DriverManager::updateDriverLocation(const std::string& driverId, int newLoc
 }
 
 bool DriverManager::updateDriverAvailability(const std::string& driverId, bool available) {
-    auto it = drivers.find(driverId);
-    if (it == drivers.end()) {
+    Driver* driver = getDriver(driverId);
+    if (driver == nullptr) {
         std::ostringstream log;
         log << "Failed to update availability for driver " << driverId << ": not found";
         logOperation(log.str());
         return false;
     }
 
-    it->second.isAvailable = available;
+    setAvailability(*driver, available);
+    driverMetrics().availabilityUpdates.inc();
 
     std::ostringstream log;
     log << "Updated driver " << driverId << " availability to "
@@ -112,11 +267,48 @@ bool DriverManager::updateDriverAvailability(const std::string& driverId, bool a
     return true;
 }
 
+int DriverManager::updateDriverLocations(const int* handles, const int* locations, size_t count,
+                                         int numLocations) {
+    int applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Driver* driver = slotForHandle(handles[i]);
+        if (driver != nullptr && locations[i] >= 0 && locations[i] < numLocations) {
+            driver->currentLocation = locations[i];
+            applied++;
+        }
+    }
+    driverMetrics().locationUpdates.inc(applied);
+
+    std::ostringstream log;
+    log << "Batch updated location for " << applied << " of " << count << " drivers";
+    logOperation(log.str());
+
+    return applied;
+}
+
+int DriverManager::updateDriverAvailabilities(const int* handles, const uint8_t* available, size_t count) {
+    int applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Driver* driver = slotForHandle(handles[i]);
+        if (driver != nullptr) {
+            setAvailability(*driver, available[i] != 0);
+            applied++;
+        }
+    }
+    driverMetrics().availabilityUpdates.inc(applied);
+
+    std::ostringstream log;
+    log << "Batch updated availability for " << applied << " of " << count << " drivers";
+    logOperation(log.str());
+
+    return applied;
+}
+
 std::vector<Driver> DriverManager::getAvailableDrivers() const {
     std::vector<Driver> available;
-    for (const auto& pair : drivers) {
-        if (pair.second.isAvailable) {
-            available.push_back(pair.second);
+    for (const Driver& driver : driverTable) {
+        if (!driver.id.empty() && driver.isAvailable) {
+            available.push_back(driver);
         }
     }
     return available;
@@ -124,37 +316,74 @@ std::vector<Driver> DriverManager::getAvailableDrivers() const {
 
 std::vector<Driver> DriverManager::getAllDrivers() const {
     std::vector<Driver> allDrivers;
-    for (const auto& pair : drivers) {
-        allDrivers.push_back(pair.second);
+    allDrivers.reserve(driverIndex.size());
+    for (const Driver& driver : driverTable) {
+        if (!driver.id.empty()) {
+            allDrivers.push_back(driver);
+        }
     }
     return allDrivers;
 }
 
-int DriverManager::getAvailableDriverCount() const {
-    int count = 0;
-    for (const auto& pair : drivers) {
-        if (pair.second.isAvailable) {
-            count++;
-        }
-    }
-    return count;
+FleetStats DriverManager::getFleetStats() const {
+    FleetStats stats;
+    stats.totalDrivers = static_cast<int>(driverIndex.size());
+    stats.availableDrivers = availableCount;
+    stats.busyDrivers = stats.totalDrivers - availableCount;
+    stats.byVehicleType = vehicleCounts;
+    return stats;
 }
 
 std::string DriverManager::toJSON() const {
-    std::ostringstream oss;
-    oss << "{\"totalDrivers\":" << drivers.size()
-        << ",\"availableDrivers\":" << getAvailableDriverCount()
-        << ",\"drivers\":[";
+    JsonWriter writer;
+    writeJSON(writer);
+    return writer.release();
+}
+
+void DriverManager::writeJSON(JsonWriter& writer) const {
+    TRACE_SPAN("serialize", "DriverManager::toJSON");
+    writer.beginObject();
+    writer.writeKey("totalDrivers");
+    writer.writeInt(static_cast<int64_t>(driverIndex.size()));
+    writer.writeKey("availableDrivers");
+    writer.writeInt(getAvailableDriverCount());
+    writer.writeKey("drivers");
+    writer.beginArray();
+    for (const Driver& driver : driverTable) {
+        if (driver.id.empty()) continue;
+        driver.writeJSON(writer);
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+MemoryBreakdown DriverManager::memoryUsage() const {
+    using namespace MemoryAccounting;
+
+    size_t tableBytes = vectorBytes(driverTable);
+    for (const Driver& driver : driverTable) {
+        tableBytes += stringHeapBytes(driver.id) + stringHeapBytes(driver.name) +
+                      stringHeapBytes(driver.vehicleType);
+    }
+
+    size_t indexBytes = flatHashMapBytes(driverIndex);
+    for (const auto& pair : driverIndex) {
+        indexBytes += stringHeapBytes(pair.first);
+    }
 
-    bool first = true;
-    for (const auto& pair : drivers) {
-        if (!first) oss << ",";
-        first = false;
-        oss << pair.second.toJSON();
+    size_t counterBytes = unorderedMapBytes(vehicleCounts);
+    for (const auto& pair : vehicleCounts) {
+        counterBytes += stringHeapBytes(pair.first);
     }
 
-    oss << "]}";
-    return oss.str();
+    MemoryBreakdown usage;
+    usage.add("driverTable", tableBytes);
+    usage.add("driverIndex", indexBytes);
+    usage.add("slotGenerations", vectorBytes(slotGenerations));
+    usage.add("freeSlots", vectorBytes(freeSlots));
+    usage.add("vehicleCounts", counterBytes);
+    usage.add("logs", stringVectorBytes(operationLogs));
+    return usage;
 }
 
 } // namespace RideSharing
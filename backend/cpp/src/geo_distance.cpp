@@ -0,0 +1,148 @@
+/**
+ * geo_distance.cpp
+ *
+ * Implementation of the structure-of-arrays haversine kernel
+ */
+
+#include "include/geo_distance.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace RideSharing {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double HALF_PI = PI / 2;
+constexpr double DEG_TO_RAD = PI / 180.0;
+
+// sin(x) for |x| <= pi/2: x + x^3 * P(x^2)
+inline double sinPoly(double x) {
+    double t = x * x;
+    double p = -7.4193491715405504e-13;
+    p = p * t + 1.6051937228907879e-10;
+    p = p * t - 2.5052005252660071e-08;
+    p = p * t + 2.755731859104909e-06;
+    p = p * t - 0.00019841269840978587;
+    p = p * t + 0.0083333333333434605;
+    p = p * t - 0.16666666666666871;
+    return x + x * t * p;
+}
+
+// asin(x) for 0 <= x <= 0.5: x + x^3 * P(x^2)
+inline double asinPoly(double x) {
+    double t = x * x;
+    double p = 0.028267788613349096;
+    p = p * t - 0.0073871813649454303;
+    p = p * t + 0.015793292329673601;
+    p = p * t + 0.010168416588434087;
+    p = p * t + 0.014167115599380907;
+    p = p * t + 0.017333577555055033;
+    p = p * t + 0.0223733274577507;
+    p = p * t + 0.030381900520387549;
+    p = p * t + 0.044642858077958987;
+    p = p * t + 0.074999999990852578;
+    p = p * t + 0.16666666666668595;
+    return x + x * t * p;
+}
+
+// Distance from point 0 to point 1 (radians); every branch is a select
+inline double haversineKernel(double lat0, double lon0, double cosLat0,
+                              double lat1, double lon1, double cosLat1) {
+    double sinLat = sinPoly((lat1 - lat0) * 0.5);
+
+    // |dLon / 2| <= pi; sin^2 is symmetric about pi/2, so fold onto [0, pi/2]
+    double halfLon = std::fabs((lon1 - lon0) * 0.5);
+    double sinLon = sinPoly(std::min(halfLon, PI - halfLon));
+
+    // a >= 0 by construction; rounding can push it just past 1, which the
+    // fabs below absorbs (a clamp here would be a branch)
+    double a = sinLat * sinLat + cosLat0 * cosLat1 * sinLon * sinLon;
+
+    // asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)) keeps the fit on [0, 0.5]:
+    // the smaller of x and the reduced argument is always <= 0.5. The fold
+    // only selects constants, so the loop has no branches to vectorize around
+    double x = std::sqrt(a);
+    double reduced = std::sqrt(std::fabs(1.0 - x) * 0.5);
+    bool folded = reduced < x;
+    double offset = folded ? HALF_PI : 0.0;
+    double factor = folded ? -2.0 : 1.0;
+    double angle = offset + factor * asinPoly(std::min(x, reduced));
+    return 2.0 * GeoDistance::EARTH_RADIUS_KM * angle;
+}
+
+} // namespace
+
+void GeoPoints::reserve(size_t count) {
+    latitudes.reserve(count);
+    longitudes.reserve(count);
+    cosLatitudes.reserve(count);
+}
+
+void GeoPoints::clear() {
+    latitudes.clear();
+    longitudes.clear();
+    cosLatitudes.clear();
+}
+
+void GeoPoints::add(double latitude, double longitude) {
+    double lat = latitude * DEG_TO_RAD;
+    latitudes.push_back(lat);
+    longitudes.push_back(longitude * DEG_TO_RAD);
+    cosLatitudes.push_back(std::cos(lat));
+}
+
+GeoPoints GeoPoints::fromGraph(const Graph& graph) {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    GeoPoints points;
+    points.reserve(graph.getNumVertices());
+    for (int v = 0; v < graph.getNumVertices(); ++v) {
+        if (graph.nodeExists(v)) {
+            const Node& node = graph.getNode(v);
+            points.add(node.latitude, node.longitude);
+        } else {
+            points.add(missing, missing);
+        }
+    }
+    return points;
+}
+
+size_t GeoPoints::memoryBytes() const {
+    return (latitudes.capacity() + longitudes.capacity() + cosLatitudes.capacity()) * sizeof(double);
+}
+
+namespace GeoDistance {
+
+double haversine(double lat1, double lon1, double lat2, double lon2) {
+    double lat1Rad = lat1 * DEG_TO_RAD;
+    double lat2Rad = lat2 * DEG_TO_RAD;
+    return haversineKernel(lat1Rad, lon1 * DEG_TO_RAD, std::cos(lat1Rad),
+                           lat2Rad, lon2 * DEG_TO_RAD, std::cos(lat2Rad));
+}
+
+void haversineBatch(double latitude, double longitude, const GeoPoints& points,
+                    double* distances) {
+    haversineBatch(latitude, longitude, points.latitudes.data(), points.longitudes.data(),
+                   points.cosLatitudes.data(), points.size(), distances);
+}
+
+void haversineBatch(double latitude, double longitude, const double* latitudes,
+                    const double* longitudes, const double* cosLatitudes, size_t count,
+                    double* distances) {
+    const double lat0 = latitude * DEG_TO_RAD;
+    const double lon0 = longitude * DEG_TO_RAD;
+    const double cosLat0 = std::cos(lat0);
+
+    const double* __restrict lat = latitudes;
+    const double* __restrict lon = longitudes;
+    const double* __restrict cosLat = cosLatitudes;
+    double* __restrict out = distances;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = haversineKernel(lat0, lon0, cosLat0, lat[i], lon[i], cosLat[i]);
+    }
+}
+
+} // namespace GeoDistance
+
+} // namespace RideSharing
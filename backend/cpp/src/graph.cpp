@@ -5,17 +5,40 @@
  */
 
 #include "include/graph.h"
-#include <sstream>
+#include "include/graph_components.h"
+#include "include/trace.h"
+#include <atomic>
 #include <stdexcept>
-#include <iomanip>
 
 namespace RideSharing {
 
-Graph::Graph(int vertices) : numVertices(vertices) {
+const char* roadClassName(RoadClass roadClass) {
+    switch (roadClass) {
+        case RoadClass::Highway: return "highway";
+        case RoadClass::Ring: return "ring";
+        case RoadClass::Arterial: return "arterial";
+        case RoadClass::Connector: return "connector";
+        default: return "local";
+    }
+}
+
+bool parseRoadClass(const std::string& name, RoadClass& roadClass) {
+    for (int i = 0; i < NUM_ROAD_CLASSES; ++i) {
+        if (name == roadClassName(static_cast<RoadClass>(i))) {
+            roadClass = static_cast<RoadClass>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Graph::Graph(int vertices) : numVertices(vertices), edits(0) {
     adjacencyList.resize(vertices);
+    nodes.reserve(vertices);
 }
 
-void Graph::addEdge(int src, int dest, double weight, const std::string& roadName) {
+void Graph::addEdge(int src, int dest, double weight, const std::string& roadName,
+                    RoadClass roadClass) {
     // Validate input
     if (src < 0 || src >= numVertices || dest < 0 || dest >= numVertices) {
         throw std::out_of_range("Invalid vertex index");
@@ -25,11 +48,14 @@ void Graph::addEdge(int src, int dest, double weight, const std::string& roadNam
     }
 
     // Add bidirectional edge
-    adjacencyList[src].emplace_back(dest, weight, roadName);
-    adjacencyList[dest].emplace_back(src, weight, roadName);
+    adjacencyList[src].emplace_back(dest, weight, roadName, roadClass);
+    adjacencyList[dest].emplace_back(src, weight, roadName, roadClass);
+    std::atomic_store(&componentLabels, std::shared_ptr<const ComponentLabels>());
+    ++edits;
 }
 
-void Graph::addDirectedEdge(int src, int dest, double weight, const std::string& roadName) {
+void Graph::addDirectedEdge(int src, int dest, double weight, const std::string& roadName,
+                            RoadClass roadClass) {
     // Validate input
     if (src < 0 || src >= numVertices || dest < 0 || dest >= numVertices) {
         throw std::out_of_range("Invalid vertex index");
@@ -39,7 +65,9 @@ void Graph::addDirectedEdge(int src, int dest, double weight, const std::string&
     }
 
     // Add unidirectional edge
-    adjacencyList[src].emplace_back(dest, weight, roadName);
+    adjacencyList[src].emplace_back(dest, weight, roadName, roadClass);
+    std::atomic_store(&componentLabels, std::shared_ptr<const ComponentLabels>());
+    ++edits;
 }
 
 void Graph::addNode(int id, const std::string& name, double lat, double lon) {
@@ -47,6 +75,7 @@ void Graph::addNode(int id, const std::string& name, double lat, double lon) {
         throw std::out_of_range("Invalid node ID");
     }
     nodes[id] = Node(id, name, lat, lon);
+    ++edits;
 }
 
 const std::vector<Edge>& Graph::getAdjacentNodes(int vertex) const {
@@ -84,41 +113,152 @@ bool Graph::validate() const {
 }
 
 std::string Graph::toJSON() const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(6);
-    oss << "{\"numVertices\":" << numVertices << ",\"nodes\":[";
+    JsonWriter writer;
+    writeJSON(writer);
+    return writer.release();
+}
 
-    bool firstNode = true;
-    for (const auto& pair : nodes) {
-        if (!firstNode) oss << ",";
-        firstNode = false;
+void Graph::writeJSON(JsonWriter& writer) const {
+    TRACE_SPAN("serialize", "Graph::toJSON");
+    writer.beginObject();
+    writer.writeKey("numVertices");
+    writer.writeInt(numVertices);
 
+    // Coordinates and weights keep six decimals
+    writer.writeKey("nodes");
+    writer.beginArray();
+    for (const auto& pair : nodes) {
         const Node& node = pair.second;
-        oss << "{\"id\":" << node.id
-            << ",\"name\":\"" << node.name << "\""
-            << ",\"latitude\":" << node.latitude
-            << ",\"longitude\":" << node.longitude << "}";
+        writer.beginObject();
+        writer.writeKey("id");
+        writer.writeInt(node.id);
+        writer.writeKey("name");
+        writer.writeString(node.name);
+        writer.writeKey("latitude");
+        writer.writeFixed(node.latitude, 6);
+        writer.writeKey("longitude");
+        writer.writeFixed(node.longitude, 6);
+        writer.endObject();
     }
+    writer.endArray();
 
-    oss << "],\"edges\":[";
-    bool firstEdge = true;
+    writer.writeKey("edges");
+    writer.beginArray();
     for (int i = 0; i < numVertices; ++i) {
         for (const auto& edge : adjacencyList[i]) {
             // Only add each edge once (avoid duplicates for bidirectional edges)
             if (i < edge.destination) {
-                if (!firstEdge) oss << ",";
-                firstEdge = false;
+                writer.beginObject();
+                writer.writeKey("source");
+                writer.writeInt(i);
+                writer.writeKey("destination");
+                writer.writeInt(edge.destination);
+                writer.writeKey("weight");
+                writer.writeFixed(edge.weight, 6);
+                writer.writeKey("roadName");
+                writer.writeString(edge.roadName);
+                writer.writeKey("roadClass");
+                writer.writeInt(static_cast<int>(edge.roadClass));
+                writer.endObject();
+            }
+        }
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+GraphColumns Graph::exportColumns() const {
+    TRACE_SPAN("serialize", "Graph::exportColumns");
+    GraphColumns columns;
+    std::unordered_map<std::string, int> nameIds;
+
+    auto internName = [&](const std::string& name) {
+        auto it = nameIds.find(name);
+        if (it != nameIds.end()) {
+            return it->second;
+        }
+        int id = static_cast<int>(columns.names.size());
+        columns.names.push_back(name);
+        nameIds.emplace(name, id);
+        return id;
+    };
+
+    columns.nodeIds.reserve(nodes.size());
+    columns.latitudes.reserve(nodes.size());
+    columns.longitudes.reserve(nodes.size());
+    columns.nodeNameIds.reserve(nodes.size());
 
-                oss << "{\"source\":" << i
-                    << ",\"destination\":" << edge.destination
-                    << ",\"weight\":" << edge.weight
-                    << ",\"roadName\":\"" << edge.roadName << "\"}";
+    // Walk IDs in order so the node columns come out sorted
+    for (int i = 0; i < numVertices; ++i) {
+        auto it = nodes.find(i);
+        if (it == nodes.end()) continue;
+
+        const Node& node = it->second;
+        columns.nodeIds.push_back(node.id);
+        columns.latitudes.push_back(node.latitude);
+        columns.longitudes.push_back(node.longitude);
+        columns.nodeNameIds.push_back(internName(node.name));
+    }
+
+    for (int i = 0; i < numVertices; ++i) {
+        for (const auto& edge : adjacencyList[i]) {
+            // Only add each edge once (avoid duplicates for bidirectional edges)
+            if (i < edge.destination) {
+                columns.edgeSources.push_back(i);
+                columns.edgeTargets.push_back(edge.destination);
+                columns.edgeWeights.push_back(edge.weight);
+                columns.roadNameIds.push_back(internName(edge.roadName));
+                columns.roadClasses.push_back(static_cast<uint8_t>(edge.roadClass));
             }
         }
     }
 
-    oss << "]}";
-    return oss.str();
+    return columns;
+}
+
+size_t Graph::getNumDirectedEdges() const {
+    size_t edges = 0;
+    for (const std::vector<Edge>& adjacent : adjacencyList) {
+        edges += adjacent.size();
+    }
+    return edges;
+}
+
+std::shared_ptr<const ComponentLabels> Graph::components() const {
+    std::shared_ptr<const ComponentLabels> labels = std::atomic_load(&componentLabels);
+    if (!labels) {
+        // Readers racing here build identical labels; one set is kept
+        labels = std::make_shared<const ComponentLabels>(ComponentLabels::compute(*this));
+        std::atomic_store(&componentLabels, labels);
+    }
+    return labels;
+}
+
+MemoryBreakdown Graph::memoryUsage() const {
+    using namespace MemoryAccounting;
+
+    size_t adjacencyBytes = vectorBytes(adjacencyList);
+    size_t roadNameBytes = 0;
+    for (const std::vector<Edge>& adjacent : adjacencyList) {
+        adjacencyBytes += vectorBytes(adjacent);
+        for (const Edge& edge : adjacent) {
+            roadNameBytes += stringHeapBytes(edge.roadName);
+        }
+    }
+
+    size_t nodeNameBytes = 0;
+    for (const auto& pair : nodes) {
+        nodeNameBytes += stringHeapBytes(pair.second.name);
+    }
+
+    MemoryBreakdown usage;
+    usage.add("adjacency", adjacencyBytes);
+    usage.add("nodes", flatHashMapBytes(nodes));
+    usage.add("nodeNames", nodeNameBytes);
+    usage.add("roadNames", roadNameBytes);
+    std::shared_ptr<const ComponentLabels> labels = std::atomic_load(&componentLabels);
+    usage.add("componentLabels", labels ? labels->memoryBytes() : 0);
+    return usage;
 }
 
 } // namespace RideSharing
@@ -0,0 +1,127 @@
+/**
+ * graph_components.cpp
+ *
+ * Implementation of connected and strongly connected component labelling
+ */
+
+#include "include/graph_components.h"
+#include "include/memory_usage.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <utility>
+
+namespace RideSharing {
+
+namespace {
+
+int findRoot(std::vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+} // namespace
+
+ComponentLabels ComponentLabels::compute(const Graph& graph) {
+    TRACE_SPAN("graph", "ComponentLabels::compute");
+    const int n = graph.getNumVertices();
+    ComponentLabels labels;
+
+    // Weak components: union-find over every edge, then number the roots
+    // in vertex order
+    std::vector<int> parent(n);
+    for (int v = 0; v < n; ++v) {
+        parent[v] = v;
+    }
+    for (int v = 0; v < n; ++v) {
+        for (const Edge& edge : graph.getAdjacentNodes(v)) {
+            int a = findRoot(parent, v);
+            int b = findRoot(parent, edge.destination);
+            if (a != b) {
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+    labels.component.assign(n, -1);
+    for (int v = 0; v < n; ++v) {
+        int root = findRoot(parent, v);
+        if (labels.component[root] < 0) {
+            labels.component[root] = labels.numComponents++;
+        }
+        labels.component[v] = labels.component[root];
+    }
+
+    // Strong components: Tarjan with an explicit call stack. An SCC is
+    // completed only after every SCC it reaches, so completion order is
+    // reverse topological; labels are flipped at the end
+    const int UNVISITED = -1;
+    std::vector<int> index(n, UNVISITED);
+    std::vector<int> lowLink(n, 0);
+    std::vector<char> onStack(n, 0);
+    std::vector<int> stack;
+    std::vector<std::pair<int, size_t>> calls; // (vertex, next edge)
+    std::vector<int> completed(n, -1);
+    int nextIndex = 0;
+    int completedCount = 0;
+
+    for (int root = 0; root < n; ++root) {
+        if (index[root] != UNVISITED) {
+            continue;
+        }
+        calls.emplace_back(root, 0);
+        index[root] = lowLink[root] = nextIndex++;
+        stack.push_back(root);
+        onStack[root] = 1;
+
+        while (!calls.empty()) {
+            int v = calls.back().first;
+            size_t& next = calls.back().second;
+            const std::vector<Edge>& edges = graph.getAdjacentNodes(v);
+
+            if (next < edges.size()) {
+                int w = edges[next++].destination;
+                if (index[w] == UNVISITED) {
+                    index[w] = lowLink[w] = nextIndex++;
+                    stack.push_back(w);
+                    onStack[w] = 1;
+                    calls.emplace_back(w, 0);
+                } else if (onStack[w]) {
+                    lowLink[v] = std::min(lowLink[v], index[w]);
+                }
+                continue;
+            }
+
+            // All edges of v done: close its SCC if v is the root
+            if (lowLink[v] == index[v]) {
+                int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = 0;
+                    completed[w] = completedCount;
+                } while (w != v);
+                ++completedCount;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                int parentVertex = calls.back().first;
+                lowLink[parentVertex] = std::min(lowLink[parentVertex], lowLink[v]);
+            }
+        }
+    }
+
+    labels.numStrongComponents = completedCount;
+    labels.strongComponent.resize(n);
+    for (int v = 0; v < n; ++v) {
+        labels.strongComponent[v] = completedCount - 1 - completed[v];
+    }
+    return labels;
+}
+
+size_t ComponentLabels::memoryBytes() const {
+    return MemoryAccounting::vectorBytes(component) + MemoryAccounting::vectorBytes(strongComponent);
+}
+
+} // namespace RideSharing
@@ -0,0 +1,71 @@
+/**
+ * graph_snapshot.cpp
+ *
+ * Implementation of the shared graph snapshot registry
+ */
+
+#include "include/graph_snapshot.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace RideSharing {
+
+namespace {
+
+struct SnapshotTable {
+    std::mutex mutex;
+    std::unordered_map<int, std::shared_ptr<const Graph>> snapshots;
+    int nextHandle = 1;
+};
+
+// Function-local static so initialisation is thread-safe
+SnapshotTable& snapshotTable() {
+    static SnapshotTable table;
+    return table;
+}
+
+} // namespace
+
+int GraphSnapshotRegistry::publish(std::shared_ptr<const Graph> graph) {
+    // Readers of the snapshot then share one set of component labels
+    graph->components();
+
+    SnapshotTable& table = snapshotTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    // Publishing the same graph twice returns its existing handle
+    for (const auto& pair : table.snapshots) {
+        if (pair.second == graph) {
+            return pair.first;
+        }
+    }
+
+    int handle = table.nextHandle++;
+    table.snapshots.emplace(handle, std::move(graph));
+    return handle;
+}
+
+std::shared_ptr<const Graph> GraphSnapshotRegistry::acquire(int handle) {
+    SnapshotTable& table = snapshotTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto it = table.snapshots.find(handle);
+    if (it == table.snapshots.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool GraphSnapshotRegistry::release(int handle) {
+    SnapshotTable& table = snapshotTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.snapshots.erase(handle) > 0;
+}
+
+int GraphSnapshotRegistry::size() {
+    SnapshotTable& table = snapshotTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return static_cast<int>(table.snapshots.size());
+}
+
+} // namespace RideSharing
@@ -0,0 +1,396 @@
+/**
+ * graph_tile.cpp
+ *
+ * Implementation of the edge grid index and the tile encoder
+ */
+
+#include "include/graph_tile.h"
+#include "include/flat_hash_map.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <utility>
+
+namespace RideSharing {
+
+namespace {
+
+typedef std::pair<int64_t, int64_t> TilePoint;
+
+struct TileLine {
+    RoadClass roadClass;
+    float weight;
+    std::vector<TilePoint> points;
+};
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeSignedVarint(std::vector<uint8_t>& out, int64_t value) {
+    writeVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+// Squared distance from p to the segment a-b
+double segmentDistanceSquared(const TilePoint& p, const TilePoint& a, const TilePoint& b) {
+    double dx = static_cast<double>(b.first - a.first);
+    double dy = static_cast<double>(b.second - a.second);
+    double px = static_cast<double>(p.first - a.first);
+    double py = static_cast<double>(p.second - a.second);
+    double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared > 0.0 ? std::max(0.0, std::min(1.0, (px * dx + py * dy) / lengthSquared)) : 0.0;
+    double ex = px - t * dx;
+    double ey = py - t * dy;
+    return ex * ex + ey * ey;
+}
+
+// Douglas-Peucker: keep the points that deviate more than tolerance
+void simplify(std::vector<TilePoint>& points, double tolerance) {
+    if (points.size() <= 2) {
+        return;
+    }
+
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+    std::vector<std::pair<size_t, size_t>> ranges(1, std::make_pair(size_t(0), points.size() - 1));
+    const double toleranceSquared = tolerance * tolerance;
+    while (!ranges.empty()) {
+        std::pair<size_t, size_t> range = ranges.back();
+        ranges.pop_back();
+
+        double farthest = 0.0;
+        size_t farthestIndex = range.first;
+        for (size_t i = range.first + 1; i < range.second; ++i) {
+            double distance = segmentDistanceSquared(points[i], points[range.first], points[range.second]);
+            if (distance > farthest) {
+                farthest = distance;
+                farthestIndex = i;
+            }
+        }
+        if (farthest > toleranceSquared) {
+            keep[farthestIndex] = true;
+            ranges.push_back(std::make_pair(range.first, farthestIndex));
+            ranges.push_back(std::make_pair(farthestIndex, range.second));
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) {
+            points[kept++] = points[i];
+        }
+    }
+    points.resize(kept);
+}
+
+// Drop repeated points; false if fewer than two distinct points remain
+bool dedupe(std::vector<TilePoint>& points) {
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    return points.size() >= 2;
+}
+
+} // namespace
+
+int GraphTileIndex::levelOf(RoadClass roadClass) {
+    switch (roadClass) {
+        case RoadClass::Highway:
+        case RoadClass::Ring:
+            return 0;
+        case RoadClass::Arterial:
+        case RoadClass::Connector:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+int GraphTileIndex::levelForZoom(int zoom) {
+    if (zoom >= DETAIL_ZOOM) return 2;
+    if (zoom >= MAJOR_ROADS_ZOOM) return 1;
+    return 0;
+}
+
+GraphTileIndex::GraphTileIndex(const Graph& graph) {
+    TRACE_SPAN("tiles", "GraphTileIndex::build");
+    const int numVertices = graph.getNumVertices();
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    latitudes.assign(numVertices, missing);
+    longitudes.assign(numVertices, missing);
+
+    bool first = true;
+    for (int v = 0; v < numVertices; ++v) {
+        if (!graph.nodeExists(v)) continue;
+        const Node& node = graph.getNode(v);
+        latitudes[v] = node.latitude;
+        longitudes[v] = node.longitude;
+        if (first) {
+            bounds = GeoBounds(node.latitude, node.longitude, node.latitude, node.longitude);
+            first = false;
+        } else {
+            bounds.minLat = std::min(bounds.minLat, node.latitude);
+            bounds.maxLat = std::max(bounds.maxLat, node.latitude);
+            bounds.minLon = std::min(bounds.minLon, node.longitude);
+            bounds.maxLon = std::max(bounds.maxLon, node.longitude);
+        }
+    }
+
+    std::vector<uint32_t> levelEdges[LEVELS];
+    for (int v = 0; v < numVertices; ++v) {
+        for (const Edge& edge : graph.getAdjacentNodes(v)) {
+            // Each two-way road once, as in exportColumns
+            if (v >= edge.destination) continue;
+
+            IndexedEdge indexed;
+            indexed.source = v;
+            indexed.target = edge.destination;
+            indexed.weight = static_cast<float>(edge.weight);
+            indexed.roadClass = edge.roadClass;
+            // Edges without coordinates at both ends cannot be placed
+            if (!std::isnan(latitudes[v]) && !std::isnan(latitudes[edge.destination])) {
+                levelEdges[levelOf(indexed.roadClass)].push_back(static_cast<uint32_t>(edges.size()));
+            }
+            edges.push_back(indexed);
+        }
+    }
+
+    for (int level = 0; level < LEVELS; ++level) {
+        buildGrid(level, levelEdges[level]);
+    }
+}
+
+int GraphTileIndex::cellX(const EdgeGrid& grid, double lon) const {
+    double span = bounds.maxLon - bounds.minLon;
+    if (span <= 0.0) return 0;
+    double cell = (lon - bounds.minLon) / span * grid.cellsX;
+    return static_cast<int>(std::max(0.0, std::min(grid.cellsX - 1.0, cell)));
+}
+
+int GraphTileIndex::cellY(const EdgeGrid& grid, double lat) const {
+    double span = bounds.maxLat - bounds.minLat;
+    if (span <= 0.0) return 0;
+    double cell = (lat - bounds.minLat) / span * grid.cellsY;
+    return static_cast<int>(std::max(0.0, std::min(grid.cellsY - 1.0, cell)));
+}
+
+void GraphTileIndex::buildGrid(int level, const std::vector<uint32_t>& levelEdges) {
+    EdgeGrid& grid = grids[level];
+
+    // About four edges per cell, shaped like the bounds
+    double width = std::max(bounds.maxLon - bounds.minLon, 1e-9);
+    double height = std::max(bounds.maxLat - bounds.minLat, 1e-9);
+    double cells = std::max(1.0, static_cast<double>(levelEdges.size()) / 4.0);
+    grid.cellsX = std::max(1, std::min(1024, static_cast<int>(std::sqrt(cells * width / height))));
+    grid.cellsY = std::max(1, std::min(1024, static_cast<int>(cells / grid.cellsX)));
+
+    // Count, prefix-sum, then fill: every cell an edge's box overlaps
+    const size_t cellCount = static_cast<size_t>(grid.cellsX) * grid.cellsY;
+    grid.offsets.assign(cellCount + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint32_t> cursor;
+        if (pass == 1) {
+            for (size_t c = 0; c < cellCount; ++c) {
+                grid.offsets[c + 1] += grid.offsets[c];
+            }
+            grid.edgeIds.resize(grid.offsets[cellCount]);
+            cursor.assign(grid.offsets.begin(), grid.offsets.end() - 1);
+        }
+
+        for (uint32_t id : levelEdges) {
+            const IndexedEdge& edge = edges[id];
+            int x0 = cellX(grid, longitudes[edge.source]);
+            int x1 = cellX(grid, longitudes[edge.target]);
+            int y0 = cellY(grid, latitudes[edge.source]);
+            int y1 = cellY(grid, latitudes[edge.target]);
+            for (int y = std::min(y0, y1); y <= std::max(y0, y1); ++y) {
+                for (int x = std::min(x0, x1); x <= std::max(x0, x1); ++x) {
+                    size_t cell = static_cast<size_t>(y) * grid.cellsX + x;
+                    if (pass == 0) {
+                        ++grid.offsets[cell + 1];
+                    } else {
+                        grid.edgeIds[cursor[cell]++] = id;
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> GraphTileIndex::query(const GeoBounds& box, int zoom) const {
+    std::vector<uint32_t> result;
+    if (!box.isValid() || edges.empty() || box.maxLat < bounds.minLat || box.minLat > bounds.maxLat ||
+        box.maxLon < bounds.minLon || box.minLon > bounds.maxLon) {
+        return result;
+    }
+
+    const int maxLevel = levelForZoom(zoom);
+    for (int level = 0; level <= maxLevel; ++level) {
+        const EdgeGrid& grid = grids[level];
+        int x0 = cellX(grid, box.minLon);
+        int x1 = cellX(grid, box.maxLon);
+        int y0 = cellY(grid, box.minLat);
+        int y1 = cellY(grid, box.maxLat);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                size_t cell = static_cast<size_t>(y) * grid.cellsX + x;
+                for (uint32_t i = grid.offsets[cell]; i < grid.offsets[cell + 1]; ++i) {
+                    const IndexedEdge& edge = edges[grid.edgeIds[i]];
+                    // Cells are coarse: keep edges whose own box meets the query
+                    double south = std::min(latitudes[edge.source], latitudes[edge.target]);
+                    double north = std::max(latitudes[edge.source], latitudes[edge.target]);
+                    double west = std::min(longitudes[edge.source], longitudes[edge.target]);
+                    double east = std::max(longitudes[edge.source], longitudes[edge.target]);
+                    if (north >= box.minLat && south <= box.maxLat && east >= box.minLon && west <= box.maxLon) {
+                        result.push_back(grid.edgeIds[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // An edge spanning several cells was found once per cell
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<uint8_t> GraphTileIndex::encodeTile(const GeoBounds& box, int zoom) const {
+    TRACE_SPAN("tiles", "GraphTileIndex::encodeTile");
+    std::vector<uint32_t> ids = query(box, zoom);
+    const bool detailed = levelForZoom(zoom) == LEVELS - 1;
+
+    auto quantise = [&](int node) {
+        double x = (longitudes[node] - box.minLon) / (box.maxLon - box.minLon) * EXTENT;
+        double y = (box.maxLat - latitudes[node]) / (box.maxLat - box.minLat) * EXTENT;
+        return TilePoint(std::llround(x), std::llround(y));
+    };
+
+    std::vector<TileLine> lines;
+    if (detailed) {
+        lines.reserve(ids.size());
+        for (uint32_t id : ids) {
+            const IndexedEdge& edge = edges[id];
+            TileLine line;
+            line.roadClass = edge.roadClass;
+            line.weight = edge.weight;
+            line.points.push_back(quantise(edge.source));
+            line.points.push_back(quantise(edge.target));
+            if (dedupe(line.points)) {
+                lines.push_back(std::move(line));
+            }
+        }
+    } else {
+        // Join same-class edges that meet end to end at nodes of degree 2,
+        // then drop detail finer than about a pixel of a 1024-pixel tile
+        std::stable_sort(ids.begin(), ids.end(), [this](uint32_t a, uint32_t b) {
+            return edges[a].roadClass < edges[b].roadClass;
+        });
+        const double tolerance = EXTENT / 1024.0;
+
+        size_t groupBegin = 0;
+        while (groupBegin < ids.size()) {
+            RoadClass roadClass = edges[ids[groupBegin]].roadClass;
+            size_t groupEnd = groupBegin;
+            while (groupEnd < ids.size() && edges[ids[groupEnd]].roadClass == roadClass) {
+                ++groupEnd;
+            }
+
+            FlatHashMap<int, std::vector<uint32_t>> incident;
+            for (size_t i = groupBegin; i < groupEnd; ++i) {
+                incident[edges[ids[i]].source].push_back(static_cast<uint32_t>(i));
+                incident[edges[ids[i]].target].push_back(static_cast<uint32_t>(i));
+            }
+
+            std::vector<bool> used(groupEnd - groupBegin, false);
+            // The other unused edge at a degree-2 node, or -1
+            auto continuation = [&](int node) -> int {
+                const std::vector<uint32_t>& at = incident.at(node);
+                if (at.size() != 2) return -1;
+                for (uint32_t i : at) {
+                    if (!used[i - groupBegin]) return static_cast<int>(i);
+                }
+                return -1;
+            };
+            auto otherEnd = [&](uint32_t i, int node) {
+                const IndexedEdge& edge = edges[ids[i]];
+                return edge.source == node ? edge.target : edge.source;
+            };
+
+            // Start at chain ends first (so chains are whole), then cycles
+            for (int pass = 0; pass < 2; ++pass) {
+                for (size_t i = groupBegin; i < groupEnd; ++i) {
+                    const IndexedEdge& edge = edges[ids[i]];
+                    if (used[i - groupBegin]) continue;
+                    if (pass == 0 && incident.at(edge.source).size() == 2 &&
+                        incident.at(edge.target).size() == 2) {
+                        continue;
+                    }
+
+                    used[i - groupBegin] = true;
+                    std::deque<int> chain;
+                    chain.push_back(edge.source);
+                    chain.push_back(edge.target);
+                    for (int next; (next = continuation(chain.back())) >= 0;) {
+                        used[next - groupBegin] = true;
+                        chain.push_back(otherEnd(next, chain.back()));
+                    }
+                    for (int next; (next = continuation(chain.front())) >= 0;) {
+                        used[next - groupBegin] = true;
+                        chain.push_front(otherEnd(next, chain.front()));
+                    }
+
+                    TileLine line;
+                    line.roadClass = roadClass;
+                    line.weight = 0.0f;
+                    line.points.reserve(chain.size());
+                    for (int node : chain) {
+                        line.points.push_back(quantise(node));
+                    }
+                    simplify(line.points, tolerance);
+                    if (dedupe(line.points)) {
+                        lines.push_back(std::move(line));
+                    }
+                }
+            }
+            groupBegin = groupEnd;
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(16 + lines.size() * 8);
+    writeVarint(out, VERSION);
+    writeVarint(out, EXTENT);
+    writeVarint(out, detailed ? FLAG_WEIGHTS : 0);
+    writeVarint(out, lines.size());
+
+    TilePoint cursor(0, 0);
+    for (const TileLine& line : lines) {
+        writeVarint(out, static_cast<uint64_t>(line.roadClass) | (static_cast<uint64_t>(line.points.size()) << 3));
+        if (detailed) {
+            writeVarint(out, static_cast<uint64_t>(std::llround(std::max(0.0f, line.weight) * 10.0)));
+        }
+        for (const TilePoint& point : line.points) {
+            writeSignedVarint(out, point.first - cursor.first);
+            writeSignedVarint(out, point.second - cursor.second);
+            cursor = point;
+        }
+    }
+    return out;
+}
+
+size_t GraphTileIndex::memoryBytes() const {
+    size_t bytes = (latitudes.capacity() + longitudes.capacity()) * sizeof(double) +
+                   edges.capacity() * sizeof(IndexedEdge);
+    for (const EdgeGrid& grid : grids) {
+        bytes += (grid.offsets.capacity() + grid.edgeIds.capacity()) * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+} // namespace RideSharing
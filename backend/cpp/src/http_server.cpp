@@ -0,0 +1,433 @@
+/**
+ * http_server.cpp
+ *
+ * Implementation of the epoll-based HTTP/1.1 server
+ */
+
+#include "include/http_server.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+namespace RideSharing {
+
+namespace {
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool equalsIgnoreCase(const char* a, size_t aLen, const char* b) {
+    size_t bLen = std::strlen(b);
+    if (aLen != bLen) return false;
+    for (size_t i = 0; i < aLen; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Trim spaces and tabs around a header value
+std::string trimValue(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string(begin, end);
+}
+
+} // namespace
+
+HttpServer::HttpServer(int listenPort, Handler requestHandler)
+    : port(listenPort), handler(std::move(requestHandler)),
+      listenFd(-1), epollFd(-1), running(false) {}
+
+HttpServer::~HttpServer() {
+    for (const auto& pair : connections) {
+        close(pair.first);
+    }
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool HttpServer::start(std::string& error) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        error = std::string("bind: ") + std::strerror(errno);
+        return false;
+    }
+    if (listen(listenFd, SOMAXCONN) < 0) {
+        error = std::string("listen: ") + std::strerror(errno);
+        return false;
+    }
+    if (!setNonBlocking(listenFd)) {
+        error = std::string("fcntl: ") + std::strerror(errno);
+        return false;
+    }
+
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        error = std::string("epoll_create1: ") + std::strerror(errno);
+        return false;
+    }
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+        error = std::string("epoll_ctl: ") + std::strerror(errno);
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void HttpServer::run() {
+    const int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+
+    while (running) {
+        // Wake up periodically so stop() takes effect without a new event
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, 500);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                handleReadable(it->second);
+                // The connection may have been closed while reading
+                it = connections.find(fd);
+                if (it == connections.end()) continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                Connection& conn = it->second;
+                bool open = handleWritable(conn);
+                // Output fell below the high-water mark: answer the
+                // pipelined requests held back meanwhile
+                if (open && !conn.input.empty() && pendingOutput(conn) < OUTPUT_HIGH_WATER_BYTES) {
+                    open = serviceConnection(conn);
+                }
+                if (!open) {
+                    closeConnection(fd);
+                }
+            }
+        }
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            // EAGAIN: backlog drained; anything else: drop this attempt
+            return;
+        }
+
+        setNonBlocking(fd);
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+
+        connections.emplace(fd, Connection(fd));
+    }
+}
+
+void HttpServer::handleReadable(Connection& conn) {
+    char buffer[16 * 1024];
+
+    // Stop once a whole maximum-size request is buffered; the rest stays in
+    // the socket until processInput has consumed some of it
+    while (!conn.peerClosed && conn.input.size() <= MAX_INPUT_BYTES) {
+        ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            conn.input.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            // Peer closed its side; flush what we can, then close
+            conn.peerClosed = true;
+            conn.closeAfterWrite = true;
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        closeConnection(conn.fd);
+        return;
+    }
+
+    if (!serviceConnection(conn)) {
+        closeConnection(conn.fd);
+    }
+}
+
+bool HttpServer::serviceConnection(Connection& conn) {
+    while (true) {
+        bool heldBack = processInput(conn);
+        if (!handleWritable(conn)) {
+            return false;
+        }
+        // Done unless requests wait and the socket took enough output to
+        // answer more (otherwise EPOLLOUT resumes them)
+        if (!heldBack || pendingOutput(conn) >= OUTPUT_HIGH_WATER_BYTES) {
+            return true;
+        }
+    }
+}
+
+bool HttpServer::processInput(Connection& conn) {
+    size_t offset = 0;
+    bool heldBack = false;
+
+    // Pipelining: answer every complete request already buffered, in order,
+    // until the peer falls behind reading the answers. Once the peer has
+    // closed no more input arrives, so what is left (bounded by
+    // MAX_INPUT_BYTES) is answered regardless
+    while (offset < conn.input.size()) {
+        if (!conn.peerClosed && pendingOutput(conn) >= OUTPUT_HIGH_WATER_BYTES) {
+            heldBack = true;
+            break;
+        }
+
+        HttpRequest request;
+        int errorStatus = 400;
+        long consumed = parseRequest(conn.input, offset, request, errorStatus);
+
+        if (consumed == 0) break;
+        if (consumed < 0) {
+            appendResponse(conn.output,
+                           HttpResponse(errorStatus, "application/json",
+                                        "{\"success\":false,\"error\":\"Bad request\"}"),
+                           false);
+            conn.closeAfterWrite = true;
+            offset = conn.input.size();
+            break;
+        }
+
+        offset += static_cast<size_t>(consumed);
+        HttpResponse response;
+        try {
+            response = handler(request);
+        } catch (...) {
+            // Whatever was thrown, std::exception or not
+            response = HttpResponse(500, "application/json",
+                                    "{\"success\":false,\"error\":\"Internal server error\"}");
+        }
+        appendResponse(conn.output, response, request.keepAlive);
+
+        if (!request.keepAlive) {
+            conn.closeAfterWrite = true;
+            offset = conn.input.size();
+            break;
+        }
+    }
+
+    conn.input.erase(0, offset);
+    return heldBack;
+}
+
+long HttpServer::parseRequest(const std::string& input, size_t offset,
+                              HttpRequest& request, int& errorStatus) const {
+    size_t headerEnd = input.find("\r\n\r\n", offset);
+    if (headerEnd == std::string::npos) {
+        if (input.size() - offset > MAX_HEADER_BYTES) {
+            errorStatus = 431;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (headerEnd + 4 - offset > MAX_HEADER_BYTES) {
+        errorStatus = 431;
+        return -1;
+    }
+
+    const char* data = input.data();
+    size_t lineEnd = input.find("\r\n", offset);
+
+    // Request line: METHOD SP TARGET SP VERSION
+    size_t methodEnd = input.find(' ', offset);
+    if (methodEnd == std::string::npos || methodEnd > lineEnd) return -1;
+    size_t targetEnd = input.find(' ', methodEnd + 1);
+    if (targetEnd == std::string::npos || targetEnd > lineEnd) return -1;
+
+    request.method.assign(data + offset, methodEnd - offset);
+    std::string target(data + methodEnd + 1, targetEnd - methodEnd - 1);
+    size_t queryStart = target.find('?');
+    if (queryStart != std::string::npos) {
+        request.query = target.substr(queryStart + 1);
+        target.resize(queryStart);
+    }
+    request.path = target;
+
+    // HTTP/1.0 defaults to close, HTTP/1.1 to keep-alive
+    std::string version(data + targetEnd + 1, lineEnd - targetEnd - 1);
+    request.keepAlive = (version != "HTTP/1.0");
+
+    size_t contentLength = 0;
+    size_t pos = lineEnd + 2;
+    while (pos < headerEnd) {
+        size_t end = input.find("\r\n", pos);
+        size_t colon = input.find(':', pos);
+        if (colon != std::string::npos && colon < end) {
+            const char* name = data + pos;
+            size_t nameLen = colon - pos;
+            std::string value = trimValue(data + colon + 1, data + end);
+
+            if (equalsIgnoreCase(name, nameLen, "content-length")) {
+                char* parseEnd = nullptr;
+                unsigned long long length = std::strtoull(value.c_str(), &parseEnd, 10);
+                if (parseEnd == value.c_str() || *parseEnd != '\0') return -1;
+                if (length > MAX_BODY_BYTES) {
+                    errorStatus = 413;
+                    return -1;
+                }
+                contentLength = static_cast<size_t>(length);
+            } else if (equalsIgnoreCase(name, nameLen, "connection")) {
+                if (equalsIgnoreCase(value.data(), value.size(), "close")) {
+                    request.keepAlive = false;
+                } else if (equalsIgnoreCase(value.data(), value.size(), "keep-alive")) {
+                    request.keepAlive = true;
+                }
+            } else if (equalsIgnoreCase(name, nameLen, "accept")) {
+                request.accept = value;
+            } else if (equalsIgnoreCase(name, nameLen, "transfer-encoding")) {
+                // Chunked request bodies are not supported
+                errorStatus = 501;
+                return -1;
+            }
+        }
+        pos = end + 2;
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (input.size() - bodyStart < contentLength) {
+        return 0;
+    }
+
+    request.body.assign(data + bodyStart, contentLength);
+    return static_cast<long>(bodyStart + contentLength - offset);
+}
+
+bool HttpServer::handleWritable(Connection& conn) {
+    while (conn.outputOffset < conn.output.size()) {
+        ssize_t n = send(conn.fd, conn.output.data() + conn.outputOffset,
+                         conn.output.size() - conn.outputOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outputOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(conn);
+            return true;
+        }
+        return false;
+    }
+
+    conn.output.clear();
+    conn.outputOffset = 0;
+
+    if (conn.closeAfterWrite) {
+        return false;
+    }
+    updateInterest(conn);
+    return true;
+}
+
+void HttpServer::updateInterest(const Connection& conn) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    // Not reading while the peer is not reading its answers, nor once no
+    // further request will be answered: after EOF, level-triggered EPOLLIN
+    // would fire on every wait until the output drains
+    bool wantInput = !conn.closeAfterWrite && pendingOutput(conn) < OUTPUT_HIGH_WATER_BYTES;
+    event.events = wantInput ? static_cast<uint32_t>(EPOLLIN) : 0u;
+    if (pendingOutput(conn) > 0) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.fd = conn.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+}
+
+void HttpServer::closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+void HttpServer::appendResponse(std::string& out, const HttpResponse& response, bool keepAlive) {
+    out += "HTTP/1.1 ";
+    out += std::to_string(response.status);
+    out += ' ';
+    out += statusText(response.status);
+    out += "\r\nContent-Type: ";
+    out += response.contentType;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(response.body.size());
+    out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    out += response.body;
+}
+
+const char* HttpServer::statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        default: return "Unknown";
+    }
+}
+
+} // namespace RideSharing
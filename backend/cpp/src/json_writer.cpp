@@ -0,0 +1,228 @@
+/**
+ * json_writer.cpp
+ *
+ * Implementation of the buffered JSON writer
+ */
+
+#include "include/json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace RideSharing {
+
+namespace {
+
+// Large enough for any int64 and for doubles in fixed notation up to 1e40;
+// longer fixed output falls back to the shortest form
+const size_t NUMBER_BUFFER_SIZE = 64;
+
+void appendChars(std::string& target, double value, std::chars_format format, int precision) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                                format, precision);
+    if (result.ec != std::errc()) {
+        result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    }
+    target.append(buffer, result.ptr);
+}
+
+// Index of the first byte in [from, size) that needs escaping (control
+// character, quote or backslash), or size if there is none. Eight bytes
+// are tested per step with the usual SWAR "has byte less than / equal to"
+// tricks, which keeps log-heavy payloads close to memcpy speed
+size_t findEscape(std::string_view value, size_t from) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highBits = 0x8080808080808080ULL;
+    size_t i = from;
+    for (; i + 8 <= value.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, value.data() + i, sizeof(word));
+        uint64_t quotes = word ^ (ones * '"');
+        uint64_t backslashes = word ^ (ones * '\\');
+        uint64_t special = ((word - ones * 0x20) | (quotes - ones) | (backslashes - ones)) &
+                           ~word & highBits;
+        if (special != 0) {
+            break;
+        }
+    }
+    for (; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return i;
+        }
+    }
+    return value.size();
+}
+
+} // namespace
+
+JsonWriter::JsonWriter() : out(ownBuffer), depth(0), afterKey(false) {
+    hasMembers[0] = false;
+    ownBuffer.reserve(256);
+}
+
+JsonWriter::JsonWriter(std::string& buffer) : out(buffer), depth(0), afterKey(false) {
+    hasMembers[0] = false;
+}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (hasMembers[depth]) {
+        out += ',';
+    }
+    hasMembers[depth] = true;
+}
+
+void JsonWriter::beginObject() {
+    separate();
+    out += '{';
+    if (depth + 1 < MAX_DEPTH) {
+        hasMembers[++depth] = false;
+    }
+}
+
+void JsonWriter::endObject() {
+    out += '}';
+    if (depth > 0) {
+        --depth;
+    }
+}
+
+void JsonWriter::beginArray() {
+    separate();
+    out += '[';
+    if (depth + 1 < MAX_DEPTH) {
+        hasMembers[++depth] = false;
+    }
+}
+
+void JsonWriter::endArray() {
+    out += ']';
+    if (depth > 0) {
+        --depth;
+    }
+}
+
+void JsonWriter::writeKey(std::string_view key) {
+    separate();
+    out += '"';
+    appendEscaped(out, key);
+    out += "\":";
+    afterKey = true;
+}
+
+void JsonWriter::writeString(std::string_view value) {
+    separate();
+    out += '"';
+    appendEscaped(out, value);
+    out += '"';
+}
+
+void JsonWriter::writeInt(int64_t value) {
+    separate();
+    appendInt(out, value);
+}
+
+void JsonWriter::writeBool(bool value) {
+    separate();
+    out += value ? "true" : "false";
+}
+
+void JsonWriter::writeNull() {
+    separate();
+    out += "null";
+}
+
+void JsonWriter::writeDouble(double value) {
+    separate();
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buffer[NUMBER_BUFFER_SIZE];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void JsonWriter::writeFixed(double value, int decimals) {
+    separate();
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    appendChars(out, value, std::chars_format::fixed, decimals);
+}
+
+void JsonWriter::writePrecision(double value, int significantDigits) {
+    separate();
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    appendChars(out, value, std::chars_format::general, significantDigits);
+}
+
+void JsonWriter::writeRaw(std::string_view json) {
+    separate();
+    out.append(json.data(), json.size());
+}
+
+void JsonWriter::writeIntArray(const std::vector<int>& values) {
+    beginArray();
+    for (int value : values) {
+        writeInt(value);
+    }
+    endArray();
+}
+
+void JsonWriter::writeStringArray(const std::vector<std::string>& values) {
+    beginArray();
+    for (const std::string& value : values) {
+        writeString(value);
+    }
+    endArray();
+}
+
+void JsonWriter::appendInt(std::string& target, int64_t value) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    target.append(buffer, result.ptr);
+}
+
+void JsonWriter::appendFixed(std::string& target, double value, int decimals) {
+    appendChars(target, value, std::chars_format::fixed, decimals);
+}
+
+void JsonWriter::appendEscaped(std::string& target, std::string_view value) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    // Copy runs of plain characters in one append
+    size_t runStart = 0;
+    for (size_t i = findEscape(value, 0); i < value.size(); i = findEscape(value, i + 1)) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        target.append(value.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+            case '"':  target += "\\\""; break;
+            case '\\': target += "\\\\"; break;
+            case '\b': target += "\\b"; break;
+            case '\f': target += "\\f"; break;
+            case '\n': target += "\\n"; break;
+            case '\r': target += "\\r"; break;
+            case '\t': target += "\\t"; break;
+            default: {
+                char escape[6] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xf] };
+                target.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    target.append(value.data() + runStart, value.size() - runStart);
+}
+
+} // namespace RideSharing
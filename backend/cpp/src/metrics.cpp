@@ -0,0 +1,221 @@
+/**
+ * metrics.cpp
+ *
+ * Implementation of the metrics registry and Prometheus rendering
+ */
+
+#include "include/metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace RideSharing {
+
+namespace {
+
+// Relaxed add for atomic<double>, which has no fetch_add before C++20
+void atomicAdd(std::atomic<double>& target, double delta) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+// Prometheus float syntax: +Inf/-Inf/NaN spelled out. Numbers go through
+// std::to_chars (shortest round-trip form), so the host's locale cannot
+// turn the decimal point into a comma or group digits
+void writeNumber(std::ostream& out, double value) {
+    if (std::isnan(value)) {
+        out << "NaN";
+    } else if (std::isinf(value)) {
+        out << (value > 0 ? "+Inf" : "-Inf");
+    } else {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.write(buffer, result.ptr - buffer);
+    }
+}
+
+void writeCount(std::ostream& out, uint64_t value) {
+    char buffer[24];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, result.ptr - buffer);
+}
+
+// HELP text escapes backslashes and newlines
+std::string escapeHelp(const std::string& help) {
+    std::string escaped;
+    escaped.reserve(help.size());
+    for (char c : help) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Gauge::add(double delta) {
+    atomicAdd(current, delta);
+}
+
+Histogram::Histogram(const std::vector<double>& upperBounds) : bounds(upperBounds) {
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    if (!bounds.empty() && std::isinf(bounds.back())) {
+        bounds.pop_back(); // +Inf is always implied
+    }
+
+    for (Shard& shard : shards) {
+        shard.buckets.reset(new std::atomic<uint64_t>[bounds.size() + 1]);
+        for (size_t i = 0; i <= bounds.size(); ++i) {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Histogram::observe(double value) {
+    // First bucket whose upper bound is >= value (le semantics)
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    Shard& shard = shards[metricShard()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    atomicAdd(shard.sum, value);
+}
+
+std::vector<uint64_t> Histogram::bucketCounts() const {
+    std::vector<uint64_t> counts(bounds.size() + 1, 0);
+    for (const Shard& shard : shards) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return counts;
+}
+
+double Histogram::sum() const {
+    double total = 0.0;
+    for (const Shard& shard : shards) {
+        total += shard.sum.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::findOrAdd(const std::string& name, const std::string& help,
+                                                   MetricType type,
+                                                   const std::vector<double>* upperBounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        if (entry->name == name) {
+            if (entry->type != type) {
+                throw std::invalid_argument("Metric " + name + " is already registered with another type");
+            }
+            return *entry;
+        }
+    }
+
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->name = name;
+    entry->help = help;
+    entry->type = type;
+    if (type == COUNTER) {
+        entry->counter.reset(new Counter());
+    } else if (type == GAUGE) {
+        entry->gauge.reset(new Gauge());
+    } else {
+        entry->histogram.reset(new Histogram(*upperBounds));
+    }
+    entries.push_back(std::move(entry));
+    return *entries.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+    return *findOrAdd(name, help, COUNTER, nullptr).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+    return *findOrAdd(name, help, GAUGE, nullptr).gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& upperBounds) {
+    return *findOrAdd(name, help, HISTOGRAM, &upperBounds).histogram;
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& out) const {
+    std::vector<const Entry*> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<Entry>& entry : entries) {
+            sorted.push_back(entry.get());
+        }
+    }
+    // Entries are never removed, so they can be read outside the lock
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+        return a->name < b->name;
+    });
+
+    for (const Entry* entry : sorted) {
+        static const char* const typeNames[] = { "counter", "gauge", "histogram" };
+        out << "# HELP " << entry->name << " " << escapeHelp(entry->help) << "\n"
+            << "# TYPE " << entry->name << " " << typeNames[entry->type] << "\n";
+
+        if (entry->type == COUNTER) {
+            out << entry->name << " ";
+            writeCount(out, entry->counter->value());
+            out << "\n";
+        } else if (entry->type == GAUGE) {
+            out << entry->name << " ";
+            writeNumber(out, entry->gauge->value());
+            out << "\n";
+        } else {
+            const Histogram& histogram = *entry->histogram;
+            const std::vector<double>& bounds = histogram.upperBounds();
+            std::vector<uint64_t> counts = histogram.bucketCounts();
+
+            // Buckets are cumulative in the exposition format
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                cumulative += counts[i];
+                out << entry->name << "_bucket{le=\"";
+                writeNumber(out, i < bounds.size() ? bounds[i]
+                                                   : std::numeric_limits<double>::infinity());
+                out << "\"} ";
+                writeCount(out, cumulative);
+                out << "\n";
+            }
+            out << entry->name << "_sum ";
+            writeNumber(out, histogram.sum());
+            out << "\n" << entry->name << "_count ";
+            writeCount(out, cumulative);
+            out << "\n";
+        }
+    }
+}
+
+std::string MetricsRegistry::toPrometheusText() const {
+    std::ostringstream oss;
+    writePrometheus(oss);
+    return oss.str();
+}
+
+} // namespace RideSharing
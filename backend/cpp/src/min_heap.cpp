@@ -7,13 +7,49 @@
 #include "include/min_heap.h"
 #include <sstream>
 #include <iomanip>
+#include <atomic>
+#include <utility>
 
 namespace RideSharing {
 
-MinHeap::MinHeap() {
+namespace {
+std::atomic<size_t> heapPeakBytes(0);
+}
+
+MinHeap::MinHeap(std::pmr::memory_resource* memory, bool logging)
+    : heap(memory), positions(memory), logging(logging) {
     heap.reserve(100);
 }
 
+MinHeap::~MinHeap() {
+    // Summed directly: a MemoryBreakdown would allocate on every search
+    using namespace MemoryAccounting;
+    size_t bytes = vectorBytes(heap) + flatHashMapBytes(positions) +
+                   stringVectorBytes(operationLogs);
+    size_t peak = heapPeakBytes.load(std::memory_order_relaxed);
+    while (bytes > peak &&
+           !heapPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+MemoryBreakdown MinHeap::memoryUsage() const {
+    using namespace MemoryAccounting;
+
+    MemoryBreakdown usage;
+    usage.add("heap", vectorBytes(heap));
+    usage.add("positions", flatHashMapBytes(positions));
+    usage.add("logs", stringVectorBytes(operationLogs));
+    return usage;
+}
+
+size_t MinHeap::peakBytes() {
+    return heapPeakBytes.load(std::memory_order_relaxed);
+}
+
+void MinHeap::resetPeakBytes() {
+    heapPeakBytes.store(0, std::memory_order_relaxed);
+}
+
 void MinHeap::swap(int i, int j) {
     // Update positions map
     positions[heap[i].vertex] = j;
@@ -27,12 +63,14 @@ void MinHeap::swap(int i, int j) {
 
 void MinHeap::heapifyUp(int i) {
     while (i > 0 && heap[parent(i)].distance > heap[i].distance) {
-        std::ostringstream log;
-        log << "HeapifyUp: Swapping node " << heap[i].vertex
-            << " (dist=" << std::fixed << std::setprecision(2) << heap[i].distance
-            << ") with parent " << heap[parent(i)].vertex
-            << " (dist=" << heap[parent(i)].distance << ")";
-        logOperation(log.str());
+        if (logging) {
+            std::ostringstream log;
+            log << "HeapifyUp: Swapping node " << heap[i].vertex
+                << " (dist=" << std::fixed << std::setprecision(2) << heap[i].distance
+                << ") with parent " << heap[parent(i)].vertex
+                << " (dist=" << heap[parent(i)].distance << ")";
+            logOperation(log.str());
+        }
 
         swap(i, parent(i));
         i = parent(i);
@@ -52,12 +90,14 @@ void MinHeap::heapifyDown(int i) {
     }
 
     if (minIndex != i) {
-        std::ostringstream log;
-        log << "HeapifyDown: Swapping node " << heap[i].vertex
-            << " (dist=" << std::fixed << std::setprecision(2) << heap[i].distance
-            << ") with child " << heap[minIndex].vertex
-            << " (dist=" << heap[minIndex].distance << ")";
-        logOperation(log.str());
+        if (logging) {
+            std::ostringstream log;
+            log << "HeapifyDown: Swapping node " << heap[i].vertex
+                << " (dist=" << std::fixed << std::setprecision(2) << heap[i].distance
+                << ") with child " << heap[minIndex].vertex
+                << " (dist=" << heap[minIndex].distance << ")";
+            logOperation(log.str());
+        }
 
         swap(i, minIndex);
         heapifyDown(minIndex);
@@ -65,10 +105,12 @@ void MinHeap::heapifyDown(int i) {
 }
 
 void MinHeap::insert(int vertex, double distance) {
-    std::ostringstream log;
-    log << "Insert: Adding vertex " << vertex
-        << " with distance " << std::fixed << std::setprecision(2) << distance;
-    logOperation(log.str());
+    if (logging) {
+        std::ostringstream log;
+        log << "Insert: Adding vertex " << vertex
+            << " with distance " << std::fixed << std::setprecision(2) << distance;
+        logOperation(log.str());
+    }
 
     HeapNode node(vertex, distance);
     heap.push_back(node);
@@ -85,10 +127,12 @@ HeapNode MinHeap::extractMin() {
 
     HeapNode minNode = heap[0];
 
-    std::ostringstream log;
-    log << "ExtractMin: Removing vertex " << minNode.vertex
-        << " with distance " << std::fixed << std::setprecision(2) << minNode.distance;
-    logOperation(log.str());
+    if (logging) {
+        std::ostringstream log;
+        log << "ExtractMin: Removing vertex " << minNode.vertex
+            << " with distance " << std::fixed << std::setprecision(2) << minNode.distance;
+        logOperation(log.str());
+    }
 
     // Move last element to root
     heap[0] = heap.back();
@@ -116,11 +160,13 @@ void MinHeap::decreaseKey(int vertex, double newDistance) {
     int index = it->second;
     double oldDistance = heap[index].distance;
 
-    std::ostringstream log;
-    log << "DecreaseKey: Updating vertex " << vertex
-        << " from distance " << std::fixed << std::setprecision(2) << oldDistance
-        << " to " << newDistance;
-    logOperation(log.str());
+    if (logging) {
+        std::ostringstream log;
+        log << "DecreaseKey: Updating vertex " << vertex
+            << " from distance " << std::fixed << std::setprecision(2) << oldDistance
+            << " to " << newDistance;
+        logOperation(log.str());
+    }
 
     heap[index].distance = newDistance;
     heapifyUp(index);
@@ -130,8 +176,8 @@ bool MinHeap::contains(int vertex) const {
     return positions.find(vertex) != positions.end();
 }
 
-void MinHeap::logOperation(const std::string& operation) {
-    operationLogs.push_back(operation);
+void MinHeap::logOperation(std::string operation) {
+    operationLogs.push_back(std::move(operation));
 }
 
 std::string MinHeap::toString() const {
@@ -5,15 +5,106 @@
 #include "include/driver_manager.h"
 #include "include/ride_matcher.h"
 #include "include/city_graph_generator.h"
+#include "include/graph_snapshot.h"
+#include "include/cbor_encoder.h"
+#include "include/trace.h"
+#include "include/metrics.h"
+#include "include/thread_pool.h"
+#include "include/geo_distance.h"
+#include "include/graph_tile.h"
+#include "include/distance_table.h"
+#include "include/betweenness.h"
+#include "include/graph_components.h"
 #include <sstream>
+#include <algorithm>
+#include <memory>
 
 using namespace RideSharing;
 
+/**
+ * Hand a native vector to JavaScript as a typed array without copying.
+ * The vector is moved to the heap and owned by an external ArrayBuffer;
+ * its finalizer frees the storage once the typed array is garbage collected.
+ */
+template <typename T>
+static Napi::TypedArrayOf<T> ToTypedArray(Napi::Env env, std::vector<T>&& values) {
+    if (values.empty()) {
+        return Napi::TypedArrayOf<T>::New(env, 0);
+    }
+
+    std::vector<T>* storage = new std::vector<T>(std::move(values));
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+        env, storage->data(), storage->size() * sizeof(T),
+        [](Napi::Env /*env*/, void* /*data*/, std::vector<T>* hint) { delete hint; },
+        storage);
+
+    return Napi::TypedArrayOf<T>::New(env, storage->size(), buffer, 0);
+}
+
+// Hand an encoded byte vector to JavaScript as a Buffer without copying
+static Napi::Buffer<uint8_t> ToBuffer(Napi::Env env, std::vector<uint8_t>&& bytes) {
+    if (bytes.empty()) {
+        return Napi::Buffer<uint8_t>::New(env, 0);
+    }
+
+    std::vector<uint8_t>* storage = new std::vector<uint8_t>(std::move(bytes));
+    return Napi::Buffer<uint8_t>::New(
+        env, storage->data(), storage->size(),
+        [](Napi::Env /*env*/, uint8_t* /*data*/, std::vector<uint8_t>* hint) { delete hint; },
+        storage);
+}
+
+// Read a driver from a plain JS object
+static Driver DriverFromObject(const Napi::Object& driverObj) {
+    Driver driver;
+    driver.id = driverObj.Get("id").As<Napi::String>().Utf8Value();
+    driver.name = driverObj.Get("name").As<Napi::String>().Utf8Value();
+    driver.currentLocation = driverObj.Get("currentLocation").As<Napi::Number>().Int32Value();
+    driver.isAvailable = driverObj.Get("isAvailable").As<Napi::Boolean>().Value();
+    driver.vehicleType = driverObj.Get("vehicleType").As<Napi::String>().Utf8Value();
+    driver.rating = driverObj.Get("rating").As<Napi::Number>().DoubleValue();
+    driver.completedRides = driverObj.Get("completedRides").As<Napi::Number>().Int32Value();
+    return driver;
+}
+
+// Check that a value is a typed array of the given element type
+static bool IsTypedArrayOf(const Napi::Value& value, napi_typedarray_type type) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == type;
+}
+
+// { total, components: { name: bytes } } for one subsystem
+static Napi::Object BreakdownToObject(Napi::Env env, const MemoryBreakdown& usage) {
+    Napi::Object components = Napi::Object::New(env);
+    for (const auto& component : usage.components) {
+        components.Set(component.first, Napi::Number::New(env, static_cast<double>(component.second)));
+    }
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("total", Napi::Number::New(env, static_cast<double>(usage.total())));
+    obj.Set("components", components);
+    return obj;
+}
+
+// Per-instance addon state. Every worker_thread loads its own instance of
+// the addon, so constructors must not be shared through static members.
+struct AddonData {
+    Napi::FunctionReference graphConstructor;
+    Napi::FunctionReference rideMatcherConstructor;
+    std::unique_ptr<ThreadPool> threadPool; // Started by the first parallel call
+
+    // The instance's work-stealing pool, one worker per core; instances that
+    // never run parallel work start no threads
+    ThreadPool& pool() {
+        if (!threadPool) {
+            threadPool.reset(new ThreadPool());
+        }
+        return *threadPool;
+    }
+};
+
 // Graph wrapper class for Node.js
 class GraphWrapper : public Napi::ObjectWrap<GraphWrapper> {
 public:
-    static Napi::FunctionReference* constructor;
-
     static Napi::Object Init(Napi::Env env, Napi::Object exports) {
         Napi::Function func = DefineClass(env, "Graph", {
             InstanceMethod("addNode", &GraphWrapper::AddNode),
@@ -21,11 +112,20 @@ public:
             InstanceMethod("getNode", &GraphWrapper::GetNode),
             InstanceMethod("getAdjacentNodes", &GraphWrapper::GetAdjacentNodes),
             InstanceMethod("getAllNodes", &GraphWrapper::GetAllNodes),
-            InstanceMethod("getNumVertices", &GraphWrapper::GetNumVertices)
+            InstanceMethod("getNodeTable", &GraphWrapper::GetNodeTable),
+            InstanceMethod("exportGraph", &GraphWrapper::ExportGraph),
+            InstanceMethod("exportGraphCbor", &GraphWrapper::ExportGraphCbor),
+            InstanceMethod("getNumVertices", &GraphWrapper::GetNumVertices),
+            InstanceMethod("routeDistances", &GraphWrapper::RouteDistances),
+            InstanceMethod("straightLineDistances", &GraphWrapper::StraightLineDistances),
+            InstanceMethod("graphTile", &GraphWrapper::GraphTile),
+            InstanceMethod("buildDistanceTable", &GraphWrapper::BuildDistanceTable),
+            InstanceMethod("betweenness", &GraphWrapper::Betweenness),
+            InstanceMethod("getComponents", &GraphWrapper::GetComponents),
+            InstanceMethod("share", &GraphWrapper::Share)
         });
 
-        constructor = new Napi::FunctionReference();
-        *constructor = Napi::Persistent(func);
+        env.GetInstanceData<AddonData>()->graphConstructor = Napi::Persistent(func);
 
         exports.Set("Graph", func);
         return exports;
@@ -40,15 +140,47 @@ public:
         }
 
         int numVertices = info[0].As<Napi::Number>().Int32Value();
-        graph_ = new Graph(numVertices);
+        adopt(std::make_shared<Graph>(numVertices));
+    }
+
+    // Create a JS Graph object that owns the given (still editable) graph
+    static Napi::Object Wrap(Napi::Env env, std::shared_ptr<Graph> graph) {
+        Napi::Object obj = env.GetInstanceData<AddonData>()->graphConstructor.New(
+            {Napi::Number::New(env, 0)});
+        Unwrap(obj)->adopt(std::move(graph));
+        return obj;
     }
 
-    ~GraphWrapper() {
-        delete graph_;
+    // Create a JS Graph object over a shared, immutable snapshot
+    static Napi::Object WrapSnapshot(Napi::Env env, std::shared_ptr<const Graph> snapshot) {
+        Napi::Object obj = env.GetInstanceData<AddonData>()->graphConstructor.New(
+            {Napi::Number::New(env, 0)});
+        GraphWrapper* wrapper = Unwrap(obj);
+        wrapper->graph_ = std::move(snapshot);
+        wrapper->editable_ = nullptr;
+        return obj;
     }
 
+    std::shared_ptr<const Graph> getGraph() const { return graph_; }
+
 private:
-    Graph* graph_;
+    std::shared_ptr<const Graph> graph_; // Shared with matchers and other workers
+    Graph* editable_ = nullptr;          // Set only until the graph is shared
+    std::unique_ptr<GeoPoints> geoPoints_; // Node coordinates for straightLineDistances
+    std::unique_ptr<GraphTileIndex> tileIndex_; // Edge grid for graphTile, built on first use
+
+    void adopt(std::shared_ptr<Graph> graph) {
+        editable_ = graph.get();
+        graph_ = std::move(graph);
+    }
+
+    // Returns the graph for mutation, or throws if it has been shared
+    Graph* editableGraph(Napi::Env env) {
+        if (editable_ == nullptr) {
+            Napi::Error::New(env, "Graph is a shared snapshot and cannot be modified").ThrowAsJavaScriptException();
+        }
+        return editable_;
+    }
 
     Napi::Value AddNode(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
@@ -63,7 +195,13 @@ private:
         double latitude = info[2].As<Napi::Number>().DoubleValue();
         double longitude = info[3].As<Napi::Number>().DoubleValue();
 
-        graph_->addNode(id, name, latitude, longitude);
+        Graph* graph = editableGraph(env);
+        if (graph == nullptr) {
+            return env.Null();
+        }
+        graph->addNode(id, name, latitude, longitude);
+        geoPoints_.reset();
+        tileIndex_.reset();
         return env.Undefined();
     }
 
@@ -80,7 +218,30 @@ private:
         double weight = info[2].As<Napi::Number>().DoubleValue();
         std::string roadName = info.Length() > 3 ? info[3].As<Napi::String>().Utf8Value() : "";
 
-        graph_->addEdge(src, dest, weight, roadName);
+        // Road class as its number (0-4) or lower-case name; local by default
+        RoadClass roadClass = RoadClass::Local;
+        if (info.Length() > 4 && !info[4].IsUndefined()) {
+            bool valid;
+            if (info[4].IsNumber()) {
+                int value = info[4].As<Napi::Number>().Int32Value();
+                valid = value >= 0 && value < NUM_ROAD_CLASSES;
+                roadClass = static_cast<RoadClass>(value);
+            } else {
+                valid = info[4].IsString() &&
+                        parseRoadClass(info[4].As<Napi::String>().Utf8Value(), roadClass);
+            }
+            if (!valid) {
+                Napi::TypeError::New(env, "Unknown road class").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+
+        Graph* graph = editableGraph(env);
+        if (graph == nullptr) {
+            return env.Null();
+        }
+        graph->addEdge(src, dest, weight, roadName, roadClass);
+        tileIndex_.reset();
         return env.Undefined();
     }
 
@@ -121,6 +282,7 @@ private:
             obj.Set("destination", Napi::Number::New(env, edges[i].destination));
             obj.Set("weight", Napi::Number::New(env, edges[i].weight));
             obj.Set("roadName", Napi::String::New(env, edges[i].roadName));
+            obj.Set("roadClass", Napi::Number::New(env, static_cast<int>(edges[i].roadClass)));
             arr[i] = obj;
         }
 
@@ -130,7 +292,7 @@ private:
     Napi::Value GetAllNodes(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        const std::unordered_map<int, Node>& nodesMap = graph_->getAllNodes();
+        const FlatHashMap<int, Node>& nodesMap = graph_->getAllNodes();
         Napi::Array arr = Napi::Array::New(env, nodesMap.size());
 
         size_t index = 0;
@@ -146,19 +308,290 @@ private:
         return arr;
     }
 
+    // Columnar node table: { ids: Int32Array, latitudes: Float64Array,
+    // longitudes: Float64Array, names: string[] }, ordered by node ID
+    Napi::Value GetNodeTable(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        const FlatHashMap<int, Node>& nodesMap = graph_->getAllNodes();
+        std::vector<int> ids;
+        ids.reserve(nodesMap.size());
+        for (const auto& pair : nodesMap) {
+            ids.push_back(pair.first);
+        }
+        std::sort(ids.begin(), ids.end());
+
+        std::vector<double> latitudes(ids.size());
+        std::vector<double> longitudes(ids.size());
+        Napi::Array names = Napi::Array::New(env, ids.size());
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            const Node& node = nodesMap.at(ids[i]);
+            latitudes[i] = node.latitude;
+            longitudes[i] = node.longitude;
+            names[i] = Napi::String::New(env, node.name);
+        }
+
+        Napi::Object table = Napi::Object::New(env);
+        table.Set("ids", ToTypedArray(env, std::move(ids)));
+        table.Set("latitudes", ToTypedArray(env, std::move(latitudes)));
+        table.Set("longitudes", ToTypedArray(env, std::move(longitudes)));
+        table.Set("names", names);
+
+        return table;
+    }
+
+    // Whole graph in one call as typed-array columns plus a names table
+    Napi::Value ExportGraph(const Napi::CallbackInfo& info) {
+        TRACE_SPAN("binding", "exportGraph");
+        Napi::Env env = info.Env();
+
+        GraphColumns columns = graph_->exportColumns();
+
+        Napi::Array names = Napi::Array::New(env, columns.names.size());
+        for (size_t i = 0; i < columns.names.size(); i++) {
+            names[i] = Napi::String::New(env, columns.names[i]);
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("numVertices", Napi::Number::New(env, graph_->getNumVertices()));
+        result.Set("nodeIds", ToTypedArray(env, std::move(columns.nodeIds)));
+        result.Set("latitudes", ToTypedArray(env, std::move(columns.latitudes)));
+        result.Set("longitudes", ToTypedArray(env, std::move(columns.longitudes)));
+        result.Set("nodeNameIds", ToTypedArray(env, std::move(columns.nodeNameIds)));
+        result.Set("edgeSources", ToTypedArray(env, std::move(columns.edgeSources)));
+        result.Set("edgeTargets", ToTypedArray(env, std::move(columns.edgeTargets)));
+        result.Set("edgeWeights", ToTypedArray(env, std::move(columns.edgeWeights)));
+        result.Set("roadNameIds", ToTypedArray(env, std::move(columns.roadNameIds)));
+        result.Set("roadClasses", ToTypedArray(env, std::move(columns.roadClasses)));
+        result.Set("names", names);
+
+        return result;
+    }
+
+    // exportGraph() encoded as CBOR, returned as a Buffer
+    Napi::Value ExportGraphCbor(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        return ToBuffer(env, CborEncoder::encodeGraph(graph_->exportColumns(),
+                                                      graph_->getNumVertices()));
+    }
+
     Napi::Value GetNumVertices(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         return Napi::Number::New(env, graph_->getNumVertices());
     }
 
-    Graph* getGraph() { return graph_; }
+    // routeDistances(sources: Int32Array, targets: Int32Array) -> Float64Array
+    // Shortest distance per pair (Infinity if unreachable), searched in
+    // parallel on the addon's thread pool
+    Napi::Value RouteDistances(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-    friend class RideMatcherWrapper;
-    friend Napi::Object GenerateCityGraph(const Napi::CallbackInfo& info);
-};
+        if (info.Length() < 2 || !IsTypedArrayOf(info[0], napi_int32_array) ||
+            !IsTypedArrayOf(info[1], napi_int32_array)) {
+            Napi::TypeError::New(env, "Expected (Int32Array sources, Int32Array targets)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Int32Array sources = info[0].As<Napi::Int32Array>();
+        Napi::Int32Array targets = info[1].As<Napi::Int32Array>();
+        if (sources.ElementLength() != targets.ElementLength()) {
+            Napi::RangeError::New(env, "sources and targets must have the same length").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::vector<double> distances(sources.ElementLength());
+        Dijkstra::findRouteDistances(*graph_, sources.Data(), targets.Data(), distances.size(),
+                                     distances.data(), env.GetInstanceData<AddonData>()->pool());
+        return ToTypedArray(env, std::move(distances));
+    }
+
+    // straightLineDistances(lat, lon) -> Float64Array
+    // Great-circle distance in km from the point to every node, indexed by
+    // node ID (NaN for IDs without a node)
+    Napi::Value StraightLineDistances(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected (latitude, longitude)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        double latitude = info[0].As<Napi::Number>().DoubleValue();
+        double longitude = info[1].As<Napi::Number>().DoubleValue();
+        if (!geoPoints_) {
+            geoPoints_.reset(new GeoPoints(GeoPoints::fromGraph(*graph_)));
+        }
+
+        std::vector<double> distances(geoPoints_->size());
+        GeoDistance::haversineBatch(latitude, longitude, *geoPoints_, distances.data());
+        return ToTypedArray(env, std::move(distances));
+    }
+
+    const GraphTileIndex& tileIndex() {
+        if (!tileIndex_) {
+            tileIndex_.reset(new GraphTileIndex(*graph_));
+        }
+        return *tileIndex_;
+    }
+
+    // graphTile([minLon, minLat, maxLon, maxLat], zoom) -> Buffer
+    // Edges visible in the box at a web-map zoom, filtered by road class and
+    // simplified below the detail zoom (format in graph_tile.h)
+    Napi::Value GraphTile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected ([minLon, minLat, maxLon, maxLat], zoom)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Array bbox = info[0].As<Napi::Array>();
+        double corners[4];
+        for (uint32_t i = 0; i < 4; ++i) {
+            Napi::Value corner = bbox.Get(i);
+            if (bbox.Length() != 4 || !corner.IsNumber()) {
+                Napi::TypeError::New(env, "bbox must be [minLon, minLat, maxLon, maxLat]").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            corners[i] = corner.As<Napi::Number>().DoubleValue();
+        }
+
+        GeoBounds box(corners[1], corners[0], corners[3], corners[2]);
+        if (!box.isValid()) {
+            Napi::RangeError::New(env, "bbox minimum must be below its maximum").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        int zoom = info[1].As<Napi::Number>().Int32Value();
+        return ToBuffer(env, tileIndex().encodeTile(box, zoom));
+    }
+
+    // buildDistanceTable(path, precision = 'float' | 'uint16') ->
+    // { numVertices, bytes, maxError }
+    // All-pairs distances and next hops, searched in parallel on the addon's
+    // thread pool and written to path for RideMatcher.loadDistanceTable
+    Napi::Value BuildDistanceTable(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected (path, precision?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::string path = info[0].As<Napi::String>().Utf8Value();
+        std::string precisionName = info.Length() > 1 && info[1].IsString()
+            ? info[1].As<Napi::String>().Utf8Value() : "float";
+        if (precisionName != "float" && precisionName != "uint16") {
+            Napi::TypeError::New(env, "precision must be 'float' or 'uint16'").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        DistanceTable::Precision precision = precisionName == "uint16"
+            ? DistanceTable::Precision::UInt16 : DistanceTable::Precision::Float32;
+
+        std::shared_ptr<const DistanceTable> table;
+        try {
+            table = DistanceTable::build(*graph_, precision, env.GetInstanceData<AddonData>()->pool());
+            table->save(path);
+        } catch (const std::exception& error) {
+            Napi::Error::New(env, error.what()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("numVertices", Napi::Number::New(env, table->numVertices()));
+        result.Set("bytes", Napi::Number::New(env, static_cast<double>(table->sizeBytes())));
+        result.Set("maxError", Napi::Number::New(env, table->maxError()));
+        return result;
+    }
+
+    // betweenness({ samples?, epsilon?, delta?, seed? }) ->
+    // { nodeScores, edgeSources, edgeTargets, edgeScores, sourcesSearched,
+    //   exact, errorBound }
+    // Brandes betweenness of every node and directed edge (in
+    // getAdjacentNodes order), searched in parallel on the addon's thread
+    // pool. Exact by default; samples (or the count needed for epsilon)
+    // searches from that many random sources instead
+    Napi::Value Betweenness(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() > 0 && !info[0].IsObject() && !info[0].IsUndefined()) {
+            Napi::TypeError::New(env, "Expected ({ samples, epsilon, delta, seed }?)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        BetweennessOptions options;
+        double epsilon = 0.0;
+        if (info.Length() > 0 && info[0].IsObject()) {
+            Napi::Object settings = info[0].As<Napi::Object>();
+            if (settings.Get("samples").IsNumber()) {
+                options.samples = settings.Get("samples").As<Napi::Number>().Int32Value();
+            }
+            if (settings.Get("epsilon").IsNumber()) {
+                epsilon = settings.Get("epsilon").As<Napi::Number>().DoubleValue();
+            }
+            if (settings.Get("delta").IsNumber()) {
+                options.delta = settings.Get("delta").As<Napi::Number>().DoubleValue();
+            }
+            if (settings.Get("seed").IsNumber()) {
+                options.seed = settings.Get("seed").As<Napi::Number>().Uint32Value();
+            }
+        }
+
+        BetweennessResult scores;
+        try {
+            if (epsilon > 0.0) {
+                options.samples = RideSharing::Betweenness::samplesFor(*graph_, epsilon, options.delta);
+            }
+            scores = RideSharing::Betweenness::compute(*graph_, options,
+                                                       env.GetInstanceData<AddonData>()->pool());
+        } catch (const std::exception& error) {
+            Napi::Error::New(env, error.what()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("nodeScores", ToTypedArray(env, std::move(scores.nodeScores)));
+        result.Set("edgeSources", ToTypedArray(env, std::move(scores.edgeSources)));
+        result.Set("edgeTargets", ToTypedArray(env, std::move(scores.edgeTargets)));
+        result.Set("edgeScores", ToTypedArray(env, std::move(scores.edgeScores)));
+        result.Set("sourcesSearched", Napi::Number::New(env, scores.sourcesSearched));
+        result.Set("exact", Napi::Boolean::New(env, scores.exact));
+        result.Set("errorBound", Napi::Number::New(env, scores.errorBound));
+        return result;
+    }
+
+    // getComponents() -> { components, strongComponents, numComponents,
+    //                      numStrongComponents }
+    // Connected and strongly connected component label of every vertex
+    // (Int32Array), the labels that reject unreachable queries; strong
+    // labels are in topological order, so a path needs source <= target
+    Napi::Value GetComponents(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        std::shared_ptr<const ComponentLabels> labels = graph_->components();
+        std::vector<int> components = labels->getComponents();
+        std::vector<int> strongComponents = labels->getStrongComponents();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("components", ToTypedArray(env, std::move(components)));
+        result.Set("strongComponents", ToTypedArray(env, std::move(strongComponents)));
+        result.Set("numComponents", Napi::Number::New(env, labels->getNumComponents()));
+        result.Set("numStrongComponents", Napi::Number::New(env, labels->getNumStrongComponents()));
+        return result;
+    }
+
+    // Publish this graph as an immutable snapshot and return its handle.
+    // The handle can be passed to worker_threads and opened there with
+    // openGraphSnapshot(); the graph can no longer be modified afterwards.
+    Napi::Value Share(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-// Static member initialization
-Napi::FunctionReference* GraphWrapper::constructor = nullptr;
+        editable_ = nullptr;
+        int handle = GraphSnapshotRegistry::publish(graph_);
+        return Napi::Number::New(env, handle);
+    }
+};
 
 // RideMatcher wrapper class for Node.js
 class RideMatcherWrapper : public Napi::ObjectWrap<RideMatcherWrapper> {
@@ -169,13 +602,20 @@ public:
             InstanceMethod("getDriver", &RideMatcherWrapper::GetDriver),
             InstanceMethod("getAllDrivers", &RideMatcherWrapper::GetAllDrivers),
             InstanceMethod("findRide", &RideMatcherWrapper::FindRide),
+            InstanceMethod("findRideCbor", &RideMatcherWrapper::FindRideCbor),
+            InstanceMethod("getAllDriversCbor", &RideMatcherWrapper::GetAllDriversCbor),
             InstanceMethod("updateDriverLocation", &RideMatcherWrapper::UpdateDriverLocation),
-            InstanceMethod("setDriverAvailability", &RideMatcherWrapper::SetDriverAvailability)
+            InstanceMethod("setDriverAvailability", &RideMatcherWrapper::SetDriverAvailability),
+            InstanceMethod("addDrivers", &RideMatcherWrapper::AddDrivers),
+            InstanceMethod("getDriverHandles", &RideMatcherWrapper::GetDriverHandles),
+            InstanceMethod("updateDriverLocations", &RideMatcherWrapper::UpdateDriverLocations),
+            InstanceMethod("setDriverAvailabilities", &RideMatcherWrapper::SetDriverAvailabilities),
+            InstanceMethod("getStats", &RideMatcherWrapper::GetStats),
+            InstanceMethod("memoryReport", &RideMatcherWrapper::MemoryReport),
+            InstanceMethod("loadDistanceTable", &RideMatcherWrapper::LoadDistanceTable)
         });
 
-        Napi::FunctionReference* constructor = new Napi::FunctionReference();
-        *constructor = Napi::Persistent(func);
-        env.SetInstanceData(constructor);
+        env.GetInstanceData<AddonData>()->rideMatcherConstructor = Napi::Persistent(func);
 
         exports.Set("RideMatcher", func);
         return exports;
@@ -190,7 +630,8 @@ public:
         }
 
         GraphWrapper* graphWrapper = Napi::ObjectWrap<GraphWrapper>::Unwrap(info[0].As<Napi::Object>());
-        matcher_ = new RideMatcher(graphWrapper->getGraph());
+        graph_ = graphWrapper->getGraph();
+        matcher_ = new RideMatcher(graph_.get());
     }
 
     ~RideMatcherWrapper() {
@@ -198,6 +639,7 @@ public:
     }
 
 private:
+    std::shared_ptr<const Graph> graph_; // Keeps the graph alive for the matcher
     RideMatcher* matcher_;
 
     Napi::Value AddDriver(const Napi::CallbackInfo& info) {
@@ -208,21 +650,184 @@ private:
             return env.Null();
         }
 
-        Napi::Object driverObj = info[0].As<Napi::Object>();
-
-        Driver driver;
-        driver.id = driverObj.Get("id").As<Napi::String>().Utf8Value();
-        driver.name = driverObj.Get("name").As<Napi::String>().Utf8Value();
-        driver.currentLocation = driverObj.Get("currentLocation").As<Napi::Number>().Int32Value();
-        driver.isAvailable = driverObj.Get("isAvailable").As<Napi::Boolean>().Value();
-        driver.vehicleType = driverObj.Get("vehicleType").As<Napi::String>().Utf8Value();
-        driver.rating = driverObj.Get("rating").As<Napi::Number>().DoubleValue();
-        driver.completedRides = driverObj.Get("completedRides").As<Napi::Number>().Int32Value();
+        Driver driver = DriverFromObject(info[0].As<Napi::Object>());
 
         matcher_->addDriver(driver);
         return env.Undefined();
     }
 
+    // Fleet counters, queue depth and matching counters (all O(1) natively)
+    Napi::Value GetStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        MatcherStats stats = matcher_->getStats();
+
+        Napi::Object byVehicleType = Napi::Object::New(env);
+        for (const auto& pair : stats.fleet.byVehicleType) {
+            Napi::Object counts = Napi::Object::New(env);
+            counts.Set("total", Napi::Number::New(env, pair.second.total));
+            counts.Set("available", Napi::Number::New(env, pair.second.available));
+            counts.Set("busy", Napi::Number::New(env, pair.second.total - pair.second.available));
+            byVehicleType.Set(pair.first, counts);
+        }
+
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("totalDrivers", Napi::Number::New(env, stats.fleet.totalDrivers));
+        obj.Set("availableDrivers", Napi::Number::New(env, stats.fleet.availableDrivers));
+        obj.Set("busyDrivers", Napi::Number::New(env, stats.fleet.busyDrivers));
+        obj.Set("byVehicleType", byVehicleType);
+        obj.Set("queueDepth", Napi::Number::New(env, stats.queueDepth));
+        obj.Set("totalRequests", Napi::Number::New(env, static_cast<double>(stats.totalRequests)));
+        obj.Set("successfulMatches", Napi::Number::New(env, static_cast<double>(stats.successfulMatches)));
+        obj.Set("failedMatches", Napi::Number::New(env, static_cast<double>(stats.failedMatches)));
+
+        return obj;
+    }
+
+    // loadDistanceTable(path) -> boolean
+    // Map a table written by graph.buildDistanceTable and use it for every
+    // match; false (and the table is ignored) if the graph has changed since
+    Napi::Value LoadDistanceTable(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Path expected").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::shared_ptr<const DistanceTable> table;
+        try {
+            table = DistanceTable::open(info[0].As<Napi::String>().Utf8Value());
+        } catch (const std::exception& error) {
+            Napi::Error::New(env, error.what()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, matcher_->setDistanceTable(std::move(table)));
+    }
+
+    // memoryReport() -> bytes per subsystem (graph, drivers, matcher, heap)
+    // The graph is counted in full even when shared with other matchers
+    Napi::Value MemoryReport(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        MemoryBreakdown graphUsage = graph_->memoryUsage();
+        MemoryBreakdown driverUsage = matcher_->driverMemoryUsage();
+        MemoryBreakdown matcherUsage = matcher_->memoryUsage();
+
+        int numNodes = graph_->getNumVertices();
+        size_t numEdges = graph_->getNumDirectedEdges();
+        int numDrivers = matcher_->getStats().fleet.totalDrivers;
+
+        Napi::Object graphObj = BreakdownToObject(env, graphUsage);
+        graphObj.Set("nodes", Napi::Number::New(env, numNodes));
+        graphObj.Set("directedEdges", Napi::Number::New(env, static_cast<double>(numEdges)));
+        graphObj.Set("bytesPerNode", Napi::Number::New(env,
+            numNodes > 0 ? static_cast<double>(graphUsage.total()) / numNodes : 0.0));
+        graphObj.Set("bytesPerEdge", Napi::Number::New(env,
+            numEdges > 0 ? static_cast<double>(graphUsage.get("adjacency") + graphUsage.get("roadNames")) / numEdges
+                         : 0.0));
+
+        Napi::Object driverObj = BreakdownToObject(env, driverUsage);
+        driverObj.Set("drivers", Napi::Number::New(env, numDrivers));
+        driverObj.Set("bytesPerDriver", Napi::Number::New(env,
+            numDrivers > 0 ? static_cast<double>(driverUsage.total()) / numDrivers : 0.0));
+
+        Napi::Object heapObj = Napi::Object::New(env);
+        heapObj.Set("peakBytes", Napi::Number::New(env, static_cast<double>(MinHeap::peakBytes())));
+
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("total", Napi::Number::New(env, static_cast<double>(
+            graphUsage.total() + driverUsage.total() + matcherUsage.total())));
+        obj.Set("graph", graphObj);
+        obj.Set("driverManager", driverObj);
+        obj.Set("rideMatcher", BreakdownToObject(env, matcherUsage));
+        obj.Set("minHeap", heapObj);
+        return obj;
+    }
+
+    // addDrivers(drivers[]) -> Int32Array of handles (-1 where rejected)
+    Napi::Value AddDrivers(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            Napi::TypeError::New(env, "Array of driver objects expected").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Array driverArr = info[0].As<Napi::Array>();
+        std::vector<Driver> drivers;
+        drivers.reserve(driverArr.Length());
+        for (uint32_t i = 0; i < driverArr.Length(); i++) {
+            drivers.push_back(DriverFromObject(driverArr.Get(i).As<Napi::Object>()));
+        }
+
+        return ToTypedArray(env, matcher_->addDrivers(drivers));
+    }
+
+    // getDriverHandles(ids[]) -> Int32Array of handles (-1 where unknown)
+    Napi::Value GetDriverHandles(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            Napi::TypeError::New(env, "Array of driver IDs expected").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Array ids = info[0].As<Napi::Array>();
+        std::vector<int> handles(ids.Length());
+        for (uint32_t i = 0; i < ids.Length(); i++) {
+            handles[i] = matcher_->getDriverHandle(ids.Get(i).As<Napi::String>().Utf8Value());
+        }
+
+        return ToTypedArray(env, std::move(handles));
+    }
+
+    // updateDriverLocations(handles: Int32Array, locations: Int32Array) -> applied count
+    // Handles of removed drivers and locations outside the graph are skipped
+    Napi::Value UpdateDriverLocations(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !IsTypedArrayOf(info[0], napi_int32_array) ||
+            !IsTypedArrayOf(info[1], napi_int32_array)) {
+            Napi::TypeError::New(env, "Expected (Int32Array handles, Int32Array locations)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Int32Array handles = info[0].As<Napi::Int32Array>();
+        Napi::Int32Array locations = info[1].As<Napi::Int32Array>();
+        if (handles.ElementLength() != locations.ElementLength()) {
+            Napi::RangeError::New(env, "handles and locations must have the same length").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        int applied = matcher_->updateDriverLocations(
+            handles.Data(), locations.Data(), handles.ElementLength());
+        return Napi::Number::New(env, applied);
+    }
+
+    // setDriverAvailabilities(handles: Int32Array, available: Uint8Array) -> applied count
+    // Handles of removed drivers are skipped
+    Napi::Value SetDriverAvailabilities(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !IsTypedArrayOf(info[0], napi_int32_array) ||
+            !IsTypedArrayOf(info[1], napi_uint8_array)) {
+            Napi::TypeError::New(env, "Expected (Int32Array handles, Uint8Array available)").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Int32Array handles = info[0].As<Napi::Int32Array>();
+        Napi::Uint8Array available = info[1].As<Napi::Uint8Array>();
+        if (handles.ElementLength() != available.ElementLength()) {
+            Napi::RangeError::New(env, "handles and available must have the same length").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        int applied = matcher_->setDriverAvailabilities(
+            handles.Data(), available.Data(), handles.ElementLength());
+        return Napi::Number::New(env, applied);
+    }
+
     Napi::Value GetDriver(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
@@ -268,6 +873,7 @@ private:
     }
 
     Napi::Value FindRide(const Napi::CallbackInfo& info) {
+        TRACE_SPAN("binding", "findRide");
         Napi::Env env = info.Env();
 
         if (info.Length() < 3) {
@@ -303,22 +909,45 @@ private:
             obj.Set("totalDistance", Napi::Number::New(env, match.totalDistance));
             obj.Set("estimatedTime", Napi::Number::New(env, match.estimatedTime));
 
-            Napi::Array pathToPickup = Napi::Array::New(env, match.pathToPickup.size());
-            for (size_t i = 0; i < match.pathToPickup.size(); i++) {
-                pathToPickup[i] = Napi::Number::New(env, match.pathToPickup[i]);
-            }
-            obj.Set("pathToPickup", pathToPickup);
-
-            Napi::Array pathToDestination = Napi::Array::New(env, match.pathToDestination.size());
-            for (size_t i = 0; i < match.pathToDestination.size(); i++) {
-                pathToDestination[i] = Napi::Number::New(env, match.pathToDestination[i]);
-            }
-            obj.Set("pathToDestination", pathToDestination);
+            // Paths are handed over as Int32Array views of the native vectors
+            obj.Set("pathToPickup",
+                    ToTypedArray(env, std::move(match.pathToPickup)));
+            obj.Set("pathToDestination",
+                    ToTypedArray(env, std::move(match.pathToDestination)));
         }
 
         return obj;
     }
 
+    // findRide() with the result encoded as CBOR: { success, body: Buffer }
+    Napi::Value FindRideCbor(const Napi::CallbackInfo& info) {
+        TRACE_SPAN("binding", "findRideCbor");
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 3) {
+            Napi::TypeError::New(env, "Expected 3 arguments").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::string passengerId = info[0].As<Napi::String>().Utf8Value();
+        int pickup = info[1].As<Napi::Number>().Int32Value();
+        int destination = info[2].As<Napi::Number>().Int32Value();
+
+        RideRequest request("", pickup, destination, passengerId);
+        RideMatch match = matcher_->findRide(request);
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("success", Napi::Boolean::New(env, match.success));
+        result.Set("body", ToBuffer(env, CborEncoder::encodeRideMatch(match)));
+        return result;
+    }
+
+    // getAllDrivers() encoded as CBOR, returned as a Buffer
+    Napi::Value GetAllDriversCbor(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        return ToBuffer(env, CborEncoder::encodeDrivers(matcher_->getAllDrivers()));
+    }
+
     Napi::Value UpdateDriverLocation(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
@@ -363,11 +992,9 @@ Napi::Object GenerateCityGraph(const Napi::CallbackInfo& info) {
 
     Napi::Object result = Napi::Object::New(env);
 
-    // Wrap the graph
-    Napi::Object graphObj = GraphWrapper::constructor->New({Napi::Number::New(env, numNodes)});
-    GraphWrapper* graphWrapper = Napi::ObjectWrap<GraphWrapper>::Unwrap(graphObj);
-    delete graphWrapper->graph_;
-    graphWrapper->graph_ = cityData->graph;
+    // Wrap the graph (ownership moves to the wrapper)
+    Napi::Object graphObj = GraphWrapper::Wrap(env, std::shared_ptr<Graph>(cityData->graph));
+    cityData->graph = nullptr;
 
     result.Set("graph", graphObj);
 
@@ -386,19 +1013,116 @@ Napi::Object GenerateCityGraph(const Napi::CallbackInfo& info) {
     }
     result.Set("drivers", driversArray);
 
-    // Don't delete cityData->graph as it's now owned by graphWrapper
-    cityData->graph = nullptr;
     delete cityData;
 
     return result;
 }
 
+// Open a graph snapshot published with graph.share(), possibly by another worker
+Napi::Value OpenGraphSnapshot(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Snapshot handle expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int handle = info[0].As<Napi::Number>().Int32Value();
+    std::shared_ptr<const Graph> snapshot = GraphSnapshotRegistry::acquire(handle);
+    if (!snapshot) {
+        Napi::Error::New(env, "Unknown graph snapshot handle").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return GraphWrapper::WrapSnapshot(env, std::move(snapshot));
+}
+
+// Drop the registry's reference to a snapshot; open graphs stay valid
+Napi::Value ReleaseGraphSnapshot(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Snapshot handle expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int handle = info[0].As<Napi::Number>().Int32Value();
+    return Napi::Boolean::New(env, GraphSnapshotRegistry::release(handle));
+}
+
+// getTrace() -> Chrome trace-event JSON of every span recorded so far
+// (empty unless the addon was built with enable_tracing=true)
+Napi::Value GetTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::String::New(env, Tracer::toChromeTraceJSON());
+}
+
+// clearTrace() -> drop recorded spans
+Napi::Value ClearTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Tracer::clear();
+    return env.Undefined();
+}
+
+// metricsText() -> every registered metric in the Prometheus text format
+// (process-wide: includes the counts of all worker_threads)
+Napi::Value MetricsText(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::String::New(env, MetricsRegistry::global().toPrometheusText());
+}
+
+// threadPoolStats() -> { workers, uptimeMs, tasksRunByCallers,
+//   perWorker: [{ tasksExecuted, tasksStolen, busyMs, utilisation }] }
+// for this instance's pool (workers is 0 until a parallel call starts it)
+Napi::Value ThreadPoolStatsObject(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ThreadPoolStats stats;
+    AddonData* data = env.GetInstanceData<AddonData>();
+    if (data->threadPool) {
+        stats = data->threadPool->stats();
+    }
+    Napi::Array perWorker = Napi::Array::New(env, stats.workers.size());
+    for (size_t i = 0; i < stats.workers.size(); i++) {
+        const WorkerStats& worker = stats.workers[i];
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("tasksExecuted", Napi::Number::New(env, static_cast<double>(worker.tasksExecuted)));
+        obj.Set("tasksStolen", Napi::Number::New(env, static_cast<double>(worker.tasksStolen)));
+        obj.Set("busyMs", Napi::Number::New(env, worker.busyNanoseconds / 1e6));
+        obj.Set("utilisation", Napi::Number::New(env, worker.utilisation));
+        perWorker[i] = obj;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("workers", Napi::Number::New(env, static_cast<double>(stats.workerCount)));
+    result.Set("uptimeMs", Napi::Number::New(env, stats.uptimeNanoseconds / 1e6));
+    result.Set("tasksRunByCallers", Napi::Number::New(env, static_cast<double>(stats.tasksRunByCallers)));
+    result.Set("perWorker", perWorker);
+    return result;
+}
+
 // Initialize the addon
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    env.SetInstanceData(new AddonData());
+
     GraphWrapper::Init(env, exports);
     RideMatcherWrapper::Init(env, exports);
 
     exports.Set("generateCityGraph", Napi::Function::New(env, GenerateCityGraph));
+    exports.Set("openGraphSnapshot", Napi::Function::New(env, OpenGraphSnapshot));
+    exports.Set("releaseGraphSnapshot", Napi::Function::New(env, ReleaseGraphSnapshot));
+    exports.Set("getTrace", Napi::Function::New(env, GetTrace));
+    exports.Set("clearTrace", Napi::Function::New(env, ClearTrace));
+    exports.Set("tracingEnabled", Napi::Boolean::New(env, Tracer::isEnabled()));
+    exports.Set("metricsText", Napi::Function::New(env, MetricsText));
+    exports.Set("threadPoolStats", Napi::Function::New(env, ThreadPoolStatsObject));
+
+    // Names of the road classes, indexed by their numbers
+    Napi::Array roadClassNames = Napi::Array::New(env, NUM_ROAD_CLASSES);
+    for (int i = 0; i < NUM_ROAD_CLASSES; i++) {
+        roadClassNames[i] = Napi::String::New(env, roadClassName(static_cast<RoadClass>(i)));
+    }
+    exports.Set("roadClassNames", roadClassNames);
 
     return exports;
 }
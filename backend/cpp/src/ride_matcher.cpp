@@ -1,94 +1,203 @@
 #include "include/ride_matcher.h"
+#include "include/trace.h"
+#include "include/metrics.h"
+#include "include/flat_hash_map.h"
+#include "include/route_coalescer.h"
+#include "include/graph_components.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
-#include <unordered_map>
+#include <chrono>
+#include <cstddef>
+#include <utility>
 
 namespace RideSharing {
 
-std::string RideMatchResult::toJSON() const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2);
-
-    oss << "{\"success\":" << (success ? "true" : "false");
-
-    if (!success) {
-        oss << ",\"errorMessage\":\"" << errorMessage << "\"}";
-        return oss.str();
-    }
-
-    oss << ",\"assignedDriver\":" << assignedDriver.toJSON()
-        << ",\"driverToPickupDistance\":" << driverToPickupDistance
-        << ",\"driverToPickupETA\":" << driverToPickupETA
-        << ",\"driverToPickupPath\":[";
+namespace {
+
+// Bytes of request scratch kept on the stack before the arena grows
+const size_t REQUEST_ARENA_BYTES = 16 * 1024;
+
+// Largest block the pool recycles; covers the heap array and position
+// table of a search on a city of several thousand nodes
+const size_t REQUEST_POOL_MAX_BLOCK = 256 * 1024;
+
+// Scratch memory for one request: a monotonic arena starting in a stack
+// buffer, with a pool on top so the heap nodes freed by one driver's
+// search are reused by the next. Everything is released at scope exit.
+class RequestArena {
+private:
+    alignas(std::max_align_t) unsigned char buffer[REQUEST_ARENA_BYTES];
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::unsynchronized_pool_resource pool;
+
+public:
+    RequestArena()
+        : arena(buffer, sizeof(buffer)),
+          pool(std::pmr::pool_options{0, REQUEST_POOL_MAX_BLOCK}, &arena) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &pool; }
+};
+
+struct MatcherMetrics {
+    Counter& requests;
+    Counter& matches;
+    Counter& failures;
+    Histogram& duration;
+    Gauge& queueDepth;
+    Counter& tableLookups;
+    Counter& driversPruned;
+    Counter& unreachableRequests;
+
+    MatcherMetrics()
+        : requests(MetricsRegistry::global().counter(
+              "ridesharing_match_requests_total", "Ride match requests (findRide and processRequest)")),
+          matches(MetricsRegistry::global().counter(
+              "ridesharing_matches_total", "Ride requests matched to a driver")),
+          failures(MetricsRegistry::global().counter(
+              "ridesharing_match_failures_total", "Ride requests that could not be matched")),
+          duration(MetricsRegistry::global().histogram(
+              "ridesharing_match_duration_seconds", "Time to match one ride request",
+              {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+               0.25, 0.5, 1, 2.5, 5})),
+          queueDepth(MetricsRegistry::global().gauge(
+              "ridesharing_request_queue_depth", "Ride requests queued across all matchers")),
+          tableLookups(MetricsRegistry::global().counter(
+              "ridesharing_distance_table_lookups_total",
+              "Route distances answered from a distance table instead of a search")),
+          driversPruned(MetricsRegistry::global().counter(
+              "ridesharing_drivers_pruned_unreachable_total",
+              "Drivers skipped because component labels rule out a route to the pickup")),
+          unreachableRequests(MetricsRegistry::global().counter(
+              "ridesharing_match_requests_unreachable_total",
+              "Ride requests rejected because the destination cannot be reached from the pickup")) {}
+};
+
+MatcherMetrics& matcherMetrics() {
+    static MatcherMetrics metrics;
+    return metrics;
+}
 
-    for (size_t i = 0; i < driverToPickupPath.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << driverToPickupPath[i];
+// Times one request and mirrors its outcome (read from the matcher's
+// lifetime counters on scope exit) into the metrics registry
+class MatchObserver {
+private:
+    const long long& successes;
+    const long long& failures;
+    long long successesBefore;
+    long long failuresBefore;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    MatchObserver(const long long& successfulMatches, const long long& failedMatches)
+        : successes(successfulMatches), failures(failedMatches),
+          successesBefore(successfulMatches), failuresBefore(failedMatches),
+          start(std::chrono::steady_clock::now()) {
+        matcherMetrics().requests.inc();
     }
 
-    oss << "],\"pickupToDestinationPath\":[";
-
-    for (size_t i = 0; i < pickupToDestinationPath.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << pickupToDestinationPath[i];
+    ~MatchObserver() {
+        MatcherMetrics& metrics = matcherMetrics();
+        metrics.duration.observe(std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count());
+        if (successes > successesBefore) metrics.matches.inc();
+        if (failures > failuresBefore) metrics.failures.inc();
     }
 
-    oss << "],\"pickupToDestinationDistance\":" << pickupToDestinationDistance
-        << ",\"pickupToDestinationETA\":" << pickupToDestinationETA
-        << ",\"totalDistance\":" << totalDistance
-        << ",\"totalETA\":" << totalETA
-        << ",\"dijkstraLogs\":[";
+    MatchObserver(const MatchObserver&) = delete;
+    MatchObserver& operator=(const MatchObserver&) = delete;
+};
 
-    for (size_t i = 0; i < dijkstraLogs.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << "\"" << dijkstraLogs[i] << "\"";
-    }
+} // namespace
 
-    oss << "],\"heapLogs\":[";
-
-    for (size_t i = 0; i < heapLogs.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << "\"" << heapLogs[i] << "\"";
-    }
+std::string RideMatchResult::toJSON() const {
+    JsonWriter writer;
+    writeJSON(writer);
+    return writer.release();
+}
 
-    oss << "],\"matchingLogs\":[";
+void RideMatchResult::writeJSON(JsonWriter& writer) const {
+    TRACE_SPAN("serialize", "RideMatchResult::toJSON");
+    writer.beginObject();
+    writer.writeKey("success");
+    writer.writeBool(success);
 
-    for (size_t i = 0; i < matchingLogs.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << "\"" << matchingLogs[i] << "\"";
+    if (!success) {
+        writer.writeKey("errorMessage");
+        writer.writeString(errorMessage);
+        writer.endObject();
+        return;
     }
 
-    oss << "]}";
-    return oss.str();
+    // Distances and ETAs keep two decimals
+    writer.writeKey("assignedDriver");
+    assignedDriver.writeJSON(writer);
+    writer.writeKey("driverToPickupDistance");
+    writer.writeFixed(driverToPickupDistance, 2);
+    writer.writeKey("driverToPickupETA");
+    writer.writeFixed(driverToPickupETA, 2);
+    writer.writeKey("driverToPickupPath");
+    writer.writeIntArray(driverToPickupPath);
+    writer.writeKey("pickupToDestinationPath");
+    writer.writeIntArray(pickupToDestinationPath);
+    writer.writeKey("pickupToDestinationDistance");
+    writer.writeFixed(pickupToDestinationDistance, 2);
+    writer.writeKey("pickupToDestinationETA");
+    writer.writeFixed(pickupToDestinationETA, 2);
+    writer.writeKey("totalDistance");
+    writer.writeFixed(totalDistance, 2);
+    writer.writeKey("totalETA");
+    writer.writeFixed(totalETA, 2);
+    writer.writeKey("dijkstraLogs");
+    writer.writeStringArray(dijkstraLogs);
+    writer.writeKey("heapLogs");
+    writer.writeStringArray(heapLogs);
+    writer.writeKey("matchingLogs");
+    writer.writeStringArray(matchingLogs);
+    writer.endObject();
 }
 
 std::string DemandStats::toJSON() const {
-    std::ostringstream oss;
-    oss << "{\"totalRequests\":" << totalRequests
-        << ",\"successfulMatches\":" << successfulMatches
-        << ",\"failedMatches\":" << failedMatches
-        << ",\"avgWaitTime\":" << std::fixed << std::setprecision(2) << avgWaitTime
-        << ",\"hotspots\":[";
-
-    for (size_t i = 0; i < hotspots.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << hotspots[i];
-    }
+    JsonWriter writer;
+    writeJSON(writer);
+    return writer.release();
+}
 
-    oss << "]}";
-    return oss.str();
+void DemandStats::writeJSON(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.writeKey("totalRequests");
+    writer.writeInt(totalRequests);
+    writer.writeKey("successfulMatches");
+    writer.writeInt(successfulMatches);
+    writer.writeKey("failedMatches");
+    writer.writeInt(failedMatches);
+    writer.writeKey("avgWaitTime");
+    writer.writeFixed(avgWaitTime, 2);
+    writer.writeKey("hotspots");
+    writer.writeIntArray(hotspots);
+    writer.endObject();
 }
 
-RideMatcher::RideMatcher(Graph* g)
-    : graph(g), driverManager() {}
+RideMatcher::RideMatcher(const Graph* g)
+    : graph(g), distanceTableEdits(0), driverManager(), totalRequests(0),
+      successfulMatches(0), failedMatches(0) {
+    matcherMetrics(); // register before the first request so scrapes see zeros
+}
 
-void RideMatcher::logOperation(const std::string& operation) {
-    systemLogs.push_back(operation);
+RideMatcher::~RideMatcher() {
+    matcherMetrics().queueDepth.add(-static_cast<double>(rideRequestQueue.size()));
+}
+
+void RideMatcher::logOperation(std::string operation) {
+    systemLogs.push_back(std::move(operation));
 }
 
 void RideMatcher::addRideRequest(const RideRequest& request) {
     rideRequestQueue.push(request);
+    matcherMetrics().queueDepth.add(1);
     updateSlidingWindow(request);
 
     std::ostringstream log;
@@ -98,37 +207,57 @@ void RideMatcher::addRideRequest(const RideRequest& request) {
     logOperation(log.str());
 }
 
-NearestDriverResult RideMatcher::findNearestDriver(int pickupLocation) {
+NearestDriverResult RideMatcher::findNearestDriver(int pickupLocation,
+                                                   std::pmr::memory_resource* memory) {
+    TRACE_SPAN("matcher", "findNearestDriver");
     NearestDriverResult result;
     result.found = false;
 
-    std::vector<Driver> availableDrivers = driverManager.getAvailableDrivers();
+    int availableDrivers = driverManager.getAvailableDriverCount();
 
-    if (availableDrivers.empty()) {
+    if (availableDrivers == 0) {
         logOperation("No available drivers found");
         return result;
     }
 
     std::ostringstream log;
-    log << "Searching for nearest driver among " << availableDrivers.size()
+    log << "Searching for nearest driver among " << availableDrivers
         << " available drivers using Greedy approach";
     logOperation(log.str());
 
     // Greedy approach: find driver with minimum distance to pickup
     double minDistance = std::numeric_limits<double>::infinity();
-    Driver* nearestDriver = nullptr;
-    std::vector<int> bestPath;
-
-    Dijkstra dijkstra(*graph);
+    const Driver* nearestDriver = nullptr;
+    std::pmr::vector<int> path(memory);
+    std::pmr::vector<int> bestPath(memory);
+
+    Dijkstra dijkstra(*graph, memory, false);
+    const DistanceTable* table = currentDistanceTable();
+    std::shared_ptr<const ComponentLabels> labels = graph->components();
+    int pruned = 0;
+
+    driverManager.forEachAvailableDriver([&](const Driver& driver) {
+        // Drivers that cannot reach the pickup are skipped unsearched
+        if (!labels->mayReach(driver.currentLocation, pickupLocation)) {
+            ++pruned;
+            return;
+        }
 
-    for (Driver& driver : availableDrivers) {
-        // Calculate distance from driver to pickup
-        PathResult path = dijkstra.findShortestPath(driver.currentLocation, pickupLocation);
+        // Calculate distance from driver to pickup: a table lookup when
+        // there is a table (the winner's path is recovered afterwards)
+        double distance = 0.0;
+        bool found;
+        if (table != nullptr) {
+            distance = table->distance(driver.currentLocation, pickupLocation);
+            found = distance != std::numeric_limits<double>::infinity();
+        } else {
+            found = dijkstra.findRoute(driver.currentLocation, pickupLocation, distance, path);
+        }
 
-        if (path.found && path.totalDistance < minDistance) {
-            minDistance = path.totalDistance;
+        if (found && distance < minDistance) {
+            minDistance = distance;
             nearestDriver = &driver;
-            bestPath = path.path;
+            bestPath.swap(path);
 
             log.str("");
             log << "  Driver " << driver.id << " at location " << driver.currentLocation
@@ -136,13 +265,27 @@ NearestDriverResult RideMatcher::findNearestDriver(int pickupLocation) {
                 << minDistance << " km to pickup";
             logOperation(log.str());
         }
+    });
+
+    if (table != nullptr) {
+        matcherMetrics().tableLookups.inc(static_cast<uint64_t>(availableDrivers - pruned));
+    }
+    if (pruned > 0) {
+        matcherMetrics().driversPruned.inc(static_cast<uint64_t>(pruned));
+        log.str("");
+        log << "Skipped " << pruned << " drivers that cannot reach the pickup";
+        logOperation(log.str());
     }
 
     if (nearestDriver != nullptr) {
         result.found = true;
         result.driver = *nearestDriver;
         result.distance = minDistance;
-        result.pathToPassenger = bestPath;
+        if (table != nullptr) {
+            table->path(nearestDriver->currentLocation, pickupLocation, result.pathToPassenger);
+        } else {
+            result.pathToPassenger.assign(bestPath.begin(), bestPath.end());
+        }
 
         log.str("");
         log << "Selected nearest driver: " << result.driver.id
@@ -157,8 +300,12 @@ NearestDriverResult RideMatcher::findNearestDriver(int pickupLocation) {
 }
 
 RideMatchResult RideMatcher::processRequest(const RideRequest& request) {
+    TRACE_SPAN("matcher", "processRequest");
+    MatchObserver observer(successfulMatches, failedMatches);
+    RequestArena arena;
     RideMatchResult result;
     systemLogs.clear();
+    totalRequests++;
 
     std::ostringstream log;
     log << "Processing ride request " << request.requestId;
@@ -168,6 +315,7 @@ RideMatchResult RideMatcher::processRequest(const RideRequest& request) {
     if (!graph->nodeExists(request.pickupLocation)) {
         result.success = false;
         result.errorMessage = "Invalid pickup location";
+        failedMatches++;
         logOperation("Error: Invalid pickup location");
         return result;
     }
@@ -175,6 +323,7 @@ RideMatchResult RideMatcher::processRequest(const RideRequest& request) {
     if (!graph->nodeExists(request.destinationLocation)) {
         result.success = false;
         result.errorMessage = "Invalid destination location";
+        failedMatches++;
         logOperation("Error: Invalid destination location");
         return result;
     }
@@ -182,28 +331,40 @@ RideMatchResult RideMatcher::processRequest(const RideRequest& request) {
     if (request.pickupLocation == request.destinationLocation) {
         result.success = false;
         result.errorMessage = "Pickup and destination cannot be the same";
+        failedMatches++;
         logOperation("Error: Pickup and destination are the same");
         return result;
     }
 
+    if (!graph->components()->mayReach(request.pickupLocation, request.destinationLocation)) {
+        result.success = false;
+        result.errorMessage = "No route found from pickup to destination";
+        failedMatches++;
+        matcherMetrics().unreachableRequests.inc();
+        logOperation("Error: Destination is not reachable from pickup");
+        return result;
+    }
+
     // Find nearest driver
-    NearestDriverResult nearestDriver = findNearestDriver(request.pickupLocation);
+    NearestDriverResult nearestDriver = findNearestDriver(request.pickupLocation, arena.resource());
 
     if (!nearestDriver.found) {
         result.success = false;
         result.errorMessage = "No available drivers found";
+        failedMatches++;
         logOperation("Error: No available drivers");
         return result;
     }
 
-    // Calculate route from pickup to destination
-    Dijkstra dijkstra(*graph);
+    // Calculate route from pickup to destination (its logs are returned)
+    Dijkstra dijkstra(*graph, arena.resource());
     PathResult pickupToDestPath = dijkstra.findShortestPath(
         request.pickupLocation, request.destinationLocation);
 
     if (!pickupToDestPath.found) {
         result.success = false;
         result.errorMessage = "No route found from pickup to destination";
+        failedMatches++;
         logOperation("Error: No route from pickup to destination");
         return result;
     }
@@ -224,7 +385,9 @@ RideMatchResult RideMatcher::processRequest(const RideRequest& request) {
 
     // Copy logs
     result.matchingLogs = systemLogs;
-    result.dijkstraLogs = dijkstra.getLogs();
+    result.dijkstraLogs = dijkstra.takeLogs();
+
+    successfulMatches++;
 
     // Mark driver as busy
     driverManager.updateDriverAvailability(result.assignedDriver.id, false);
@@ -249,6 +412,7 @@ RideMatchResult RideMatcher::processNextRequest() {
 
     RideRequest request = rideRequestQueue.front();
     rideRequestQueue.pop();
+    matcherMetrics().queueDepth.add(-1);
 
     return processRequest(request);
 }
@@ -271,7 +435,7 @@ DemandStats RideMatcher::analyzeDemand() const {
     }
 
     // Count frequency of pickup locations (hotspots)
-    std::unordered_map<int, int> locationFrequency;
+    FlatHashMap<int, int> locationFrequency;
 
     for (const auto& request : recentRequests) {
         locationFrequency[request.pickupLocation]++;
@@ -281,9 +445,11 @@ DemandStats RideMatcher::analyzeDemand() const {
     std::vector<std::pair<int, int>> sortedLocations(
         locationFrequency.begin(), locationFrequency.end());
 
+    // Ties go to the lower location ID so the result does not depend on
+    // hash table order
     std::sort(sortedLocations.begin(), sortedLocations.end(),
               [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
-                  return a.second > b.second;
+                  return a.second != b.second ? a.second > b.second : a.first < b.first;
               });
 
     for (size_t i = 0; i < std::min(size_t(3), sortedLocations.size()); ++i) {
@@ -293,7 +459,56 @@ DemandStats RideMatcher::analyzeDemand() const {
     return stats;
 }
 
+MatcherStats RideMatcher::getStats() const {
+    MatcherStats stats;
+    stats.fleet = driverManager.getFleetStats();
+    stats.queueDepth = static_cast<int>(rideRequestQueue.size());
+    stats.totalRequests = totalRequests;
+    stats.successfulMatches = successfulMatches;
+    stats.failedMatches = failedMatches;
+    return stats;
+}
+
 // Node.js-friendly methods
+MemoryBreakdown RideMatcher::memoryUsage() const {
+    using namespace MemoryAccounting;
+
+    // std::queue does not expose its container; its requests are counted
+    // at their fixed size
+    size_t queueBytes = rideRequestQueue.size() * sizeof(RideRequest);
+
+    size_t windowBytes = dequeBytes(recentRequests);
+    for (const RideRequest& request : recentRequests) {
+        windowBytes += stringHeapBytes(request.requestId) + stringHeapBytes(request.passengerId);
+    }
+
+    MemoryBreakdown usage;
+    usage.add("requestQueue", queueBytes);
+    usage.add("slidingWindow", windowBytes);
+    usage.add("logs", stringVectorBytes(systemLogs));
+    // Mapped tables are counted in full, whether or not their pages are resident
+    usage.add("distanceTable", distanceTable ? distanceTable->sizeBytes() : 0);
+    return usage;
+}
+
+bool RideMatcher::setDistanceTable(std::shared_ptr<const DistanceTable> table) {
+    if (table && !table->matches(*graph)) {
+        logOperation("Distance table rejected: it was built from a different graph");
+        return false;
+    }
+    distanceTable = std::move(table);
+    distanceTableEdits = graph->getEditCount();
+    return true;
+}
+
+const DistanceTable* RideMatcher::currentDistanceTable() {
+    if (distanceTable && distanceTableEdits != graph->getEditCount()) {
+        logOperation("Distance table dropped: the graph was edited after it was built");
+        distanceTable.reset();
+    }
+    return distanceTable.get();
+}
+
 void RideMatcher::addDriver(const Driver& driver) {
     driverManager.addDriver(driver);
 }
@@ -311,6 +526,9 @@ std::vector<Driver> RideMatcher::getAllDrivers() const {
 }
 
 void RideMatcher::updateDriverLocation(const std::string& driverId, int newLocation) {
+    if (newLocation < 0 || newLocation >= graph->getNumVertices()) {
+        return;
+    }
     driverManager.updateDriverLocation(driverId, newLocation);
 }
 
@@ -318,47 +536,91 @@ void RideMatcher::setDriverAvailability(const std::string& driverId, bool isAvai
     driverManager.updateDriverAvailability(driverId, isAvailable);
 }
 
+std::vector<int> RideMatcher::addDrivers(const std::vector<Driver>& drivers) {
+    return driverManager.addDrivers(drivers);
+}
+
+int RideMatcher::getDriverHandle(const std::string& driverId) const {
+    return driverManager.getDriverHandle(driverId);
+}
+
+int RideMatcher::updateDriverLocations(const int* handles, const int* locations, size_t count) {
+    return driverManager.updateDriverLocations(handles, locations, count, graph->getNumVertices());
+}
+
+int RideMatcher::setDriverAvailabilities(const int* handles, const uint8_t* available, size_t count) {
+    return driverManager.updateDriverAvailabilities(handles, available, count);
+}
+
 RideMatch RideMatcher::findRide(const RideRequest& request) {
+    TRACE_SPAN("matcher", "findRide");
+    MatchObserver observer(successfulMatches, failedMatches);
+    RequestArena arena;
     RideMatch match;
+    totalRequests++;
+
+    // A destination the pickup cannot reach fails before any driver search
+    if (!graph->components()->mayReach(request.pickupLocation, request.destinationLocation)) {
+        failedMatches++;
+        matcherMetrics().unreachableRequests.inc();
+        match.success = false;
+        match.message = "No valid path found";
+        return match;
+    }
 
     // Find nearest available driver
-    NearestDriverResult nearestDriver = findNearestDriver(request.pickupLocation);
+    NearestDriverResult nearestDriver = findNearestDriver(request.pickupLocation, arena.resource());
 
     if (!nearestDriver.found) {
+        failedMatches++;
         match.success = false;
         match.message = "No available drivers found";
         return match;
     }
 
-    // Calculate route from driver to pickup
-    Dijkstra dijkstra(*graph);
-    PathResult driverToPickup = dijkstra.findShortestPath(
-        nearestDriver.driver.currentLocation,
-        request.pickupLocation
-    );
-
-    // Calculate route from pickup to destination
-    PathResult pickupToDestination = dijkstra.findShortestPath(
-        request.pickupLocation,
-        request.destinationLocation
-    );
+    // The driver-to-pickup route comes from the nearest-driver search;
+    // calculate route from pickup to destination. With a distance table it
+    // is a lookup; otherwise riders asking for the same trip at the same
+    // moment (on any matcher sharing this graph) share one search
+    RouteCoalescer::RoutePtr destinationRoute;
+    if (const DistanceTable* table = currentDistanceTable()) {
+        std::shared_ptr<SharedRoute> route = std::make_shared<SharedRoute>();
+        route->distance = table->distance(request.pickupLocation, request.destinationLocation);
+        route->found = table->path(request.pickupLocation, request.destinationLocation, route->path);
+        matcherMetrics().tableLookups.inc();
+        destinationRoute = std::move(route);
+    } else {
+        destinationRoute = RouteCoalescer::global().route(
+            *graph, request.pickupLocation, request.destinationLocation, [&](SharedRoute& shared) {
+                Dijkstra dijkstra(*graph, arena.resource(), false);
+                std::pmr::vector<int> path(arena.resource());
+                shared.found = dijkstra.findRoute(request.pickupLocation, request.destinationLocation,
+                                                  shared.distance, path);
+                if (shared.found) {
+                    shared.path.assign(path.begin(), path.end());
+                }
+            });
+    }
 
-    if (!driverToPickup.found || !pickupToDestination.found) {
+    if (!destinationRoute->found) {
+        failedMatches++;
         match.success = false;
         match.message = "No valid path found";
         return match;
     }
 
+    successfulMatches++;
+
     // Fill match result
     match.success = true;
     match.message = "Ride matched successfully";
     match.driver = nearestDriver.driver;
-    match.distanceToPickup = driverToPickup.totalDistance;
-    match.distanceToDestination = pickupToDestination.totalDistance;
-    match.totalDistance = driverToPickup.totalDistance + pickupToDestination.totalDistance;
+    match.distanceToPickup = nearestDriver.distance;
+    match.distanceToDestination = destinationRoute->distance;
+    match.totalDistance = nearestDriver.distance + destinationRoute->distance;
     match.estimatedTime = static_cast<int>((match.totalDistance / 40.0) * 60); // 40 km/h avg speed
-    match.pathToPickup = driverToPickup.path;
-    match.pathToDestination = pickupToDestination.path;
+    match.pathToPickup = std::move(nearestDriver.pathToPassenger);
+    match.pathToDestination = destinationRoute->path;
 
     // Update driver availability
     driverManager.updateDriverAvailability(nearestDriver.driver.id, false);
@@ -0,0 +1,105 @@
+/**
+ * route_coalescer.cpp
+ *
+ * Implementation of singleflight route query deduplication
+ */
+
+#include "include/route_coalescer.h"
+#include "include/metrics.h"
+#include "include/trace.h"
+#include <cstdint>
+#include <exception>
+
+namespace RideSharing {
+
+namespace {
+
+struct CoalescerMetrics {
+    Counter& queries;
+    Counter& coalesced;
+    Gauge& inFlight;
+
+    CoalescerMetrics()
+        : queries(MetricsRegistry::global().counter(
+              "ridesharing_route_queries_total", "Point-to-point route queries")),
+          coalesced(MetricsRegistry::global().counter(
+              "ridesharing_route_queries_coalesced_total",
+              "Route queries answered by an identical query already in flight")),
+          inFlight(MetricsRegistry::global().gauge(
+              "ridesharing_route_queries_in_flight", "Distinct route queries being searched")) {}
+};
+
+CoalescerMetrics& coalescerMetrics() {
+    static CoalescerMetrics metrics;
+    return metrics;
+}
+
+} // namespace
+
+size_t RouteCoalescer::QueryKeyHash::operator()(const QueryKey& key) const {
+    uint64_t pair = (static_cast<uint64_t>(static_cast<uint32_t>(key.source)) << 32) |
+                    static_cast<uint32_t>(key.destination);
+    uint64_t hash = pair ^ (reinterpret_cast<uintptr_t>(key.graph) * 0x9e3779b97f4a7c15ULL);
+    // Murmur3 finaliser
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+}
+
+RouteCoalescer& RouteCoalescer::global() {
+    static RouteCoalescer coalescer;
+    return coalescer;
+}
+
+RouteCoalescer::RoutePtr RouteCoalescer::route(const Graph& graph, int source, int destination,
+                                               const Search& search) {
+    CoalescerMetrics& metrics = coalescerMetrics();
+    metrics.queries.inc();
+
+    QueryKey key = {&graph, source, destination};
+    std::promise<RoutePtr> promise;
+    std::shared_future<RoutePtr> result;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            result = it->second;
+        } else {
+            result = promise.get_future().share();
+            pending.emplace(key, result);
+            leader = true;
+        }
+    }
+
+    if (!leader) {
+        TRACE_SPAN("dijkstra", "RouteCoalescer::wait");
+        metrics.coalesced.inc();
+        return result.get();
+    }
+
+    metrics.inFlight.add(1);
+    try {
+        std::shared_ptr<SharedRoute> route = std::make_shared<SharedRoute>();
+        search(*route);
+        promise.set_value(std::move(route));
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    metrics.inFlight.add(-1);
+
+    // Callers that arrive between set_value and here still get this result
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.erase(key);
+    }
+    return result.get();
+}
+
+size_t RouteCoalescer::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+} // namespace RideSharing
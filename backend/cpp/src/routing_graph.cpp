@@ -0,0 +1,160 @@
+/**
+ * routing_graph.cpp
+ *
+ * CSR routing graph construction and search, with the explicit
+ * instantiations declared in routing_graph.h
+ */
+
+#include "include/routing_graph.h"
+#include "include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace RideSharing {
+
+namespace {
+
+// Stored form of one graph weight: scaled, and rounded for integer types
+template <typename WeightT>
+WeightT quantiseWeight(double weight, double scale) {
+    double scaled = weight * scale;
+    if (std::is_integral<WeightT>::value) {
+        scaled = std::round(scaled);
+        if (scaled > static_cast<double>(std::numeric_limits<WeightT>::max())) {
+            throw std::overflow_error("Edge weight does not fit the routing weight type");
+        }
+    }
+    return static_cast<WeightT>(scaled);
+}
+
+} // namespace
+
+template <typename IdT, typename WeightT>
+RoutingGraph<IdT, WeightT> RoutingGraph<IdT, WeightT>::fromGraph(const Graph& graph,
+                                                                double weightScale) {
+    TRACE_SPAN("routing", "RoutingGraph::fromGraph");
+    const size_t numVertices = static_cast<size_t>(graph.getNumVertices());
+    const size_t numEdges = graph.getNumDirectedEdges();
+    // NO_NODE is reserved, and offsets must hold the edge count itself
+    if (numVertices >= static_cast<size_t>(NO_NODE) || numEdges >= static_cast<size_t>(NO_NODE)) {
+        throw std::overflow_error("Graph is too large for the routing id type");
+    }
+
+    RoutingGraph routing;
+    routing.scale = weightScale;
+    routing.offsets.reserve(numVertices + 1);
+    routing.targets.reserve(numEdges);
+    routing.weights.reserve(numEdges);
+
+    routing.offsets.push_back(0);
+    for (size_t v = 0; v < numVertices; ++v) {
+        for (const Edge& edge : graph.getAdjacentNodes(static_cast<int>(v))) {
+            routing.targets.push_back(static_cast<IdT>(edge.destination));
+            routing.weights.push_back(quantiseWeight<WeightT>(edge.weight, weightScale));
+        }
+        routing.offsets.push_back(static_cast<IdT>(routing.targets.size()));
+    }
+    return routing;
+}
+
+template <typename IdT, typename WeightT>
+size_t RoutingGraph<IdT, WeightT>::memoryBytes() const {
+    return offsets.capacity() * sizeof(IdT) + targets.capacity() * sizeof(IdT) +
+           weights.capacity() * sizeof(WeightT);
+}
+
+template <typename IdT, typename WeightT>
+RoutingSearch<IdT, WeightT>::RoutingSearch(const SearchGraph& routingGraph)
+    : graph(routingGraph), settled(0) {}
+
+template <typename IdT, typename WeightT>
+void RoutingSearch<IdT, WeightT>::run(IdT source, IdT target) {
+    typedef std::pair<Distance, IdT> Entry;
+    const IdT n = graph.numVertices();
+    distances.assign(n, UNREACHABLE);
+    predecessors.assign(n, SearchGraph::NO_NODE);
+    heap.clear();
+    settled = 0;
+
+    distances[source] = 0;
+    heap.push_back(Entry(0, source));
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+
+        IdT u = top.second;
+        if (top.first > distances[u]) {
+            continue; // Stale entry, already settled with a shorter distance
+        }
+        ++settled;
+        if (u == target) {
+            return;
+        }
+
+        for (IdT e = graph.edgesBegin(u), end = graph.edgesEnd(u); e < end; ++e) {
+            IdT v = graph.target(e);
+            Distance candidate = top.first + static_cast<Distance>(graph.weight(e));
+            if (candidate < distances[v]) {
+                distances[v] = candidate;
+                predecessors[v] = u;
+                heap.push_back(Entry(candidate, v));
+                std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            }
+        }
+    }
+}
+
+template <typename IdT, typename WeightT>
+const std::vector<typename RoutingSearch<IdT, WeightT>::Distance>&
+RoutingSearch<IdT, WeightT>::oneToAll(IdT source) {
+    if (source >= graph.numVertices()) {
+        distances.assign(graph.numVertices(), UNREACHABLE);
+        predecessors.assign(graph.numVertices(), SearchGraph::NO_NODE);
+        settled = 0;
+        return distances;
+    }
+    run(source, SearchGraph::NO_NODE);
+    return distances;
+}
+
+template <typename IdT, typename WeightT>
+bool RoutingSearch<IdT, WeightT>::route(IdT source, IdT target, Distance& distance,
+                                        std::vector<IdT>* path) {
+    if (source >= graph.numVertices() || target >= graph.numVertices()) {
+        return false;
+    }
+    run(source, target);
+    if (distances[target] == UNREACHABLE) {
+        return false;
+    }
+
+    distance = distances[target];
+    if (path != nullptr) {
+        path->clear();
+        for (IdT v = target; v != SearchGraph::NO_NODE; v = predecessors[v]) {
+            path->push_back(v);
+        }
+        std::reverse(path->begin(), path->end());
+    }
+    return true;
+}
+
+template class RoutingGraph<uint32_t, float>;
+template class RoutingGraph<uint32_t, uint32_t>;
+template class RoutingGraph<uint32_t, double>;
+template class RoutingGraph<uint64_t, float>;
+template class RoutingGraph<uint64_t, uint32_t>;
+template class RoutingGraph<uint64_t, double>;
+
+template class RoutingSearch<uint32_t, float>;
+template class RoutingSearch<uint32_t, uint32_t>;
+template class RoutingSearch<uint32_t, double>;
+template class RoutingSearch<uint64_t, float>;
+template class RoutingSearch<uint64_t, uint32_t>;
+template class RoutingSearch<uint64_t, double>;
+
+} // namespace RideSharing
@@ -0,0 +1,235 @@
+/**
+ * thread_pool.cpp
+ *
+ * Implementation of the work-stealing thread pool and task groups
+ */
+
+#include "include/thread_pool.h"
+
+namespace RideSharing {
+
+namespace {
+
+// Pool and worker index of the calling thread (null/-1 outside any pool)
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentIndex = -1;
+
+uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+} // namespace
+
+size_t ThreadPool::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+ThreadPool::ThreadPool(size_t workerCount)
+    : pendingTasks(0), nextQueue(0), callerTasks(0), stopping(false),
+      startTime(std::chrono::steady_clock::now()) {
+    if (workerCount == 0) {
+        workerCount = defaultWorkerCount();
+    }
+
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    // Start threads only once every deque exists, since they steal from all
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+int ThreadPool::currentWorker() const {
+    return currentPool == this ? currentIndex : -1;
+}
+
+void ThreadPool::submit(Task task) {
+    int self = currentWorker();
+    size_t index = self >= 0 ? static_cast<size_t>(self)
+                             : nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    pendingTasks.fetch_add(1);
+
+    // Taking the lock orders this wake-up after a sleeper's predicate check
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::popBack(size_t index, Task& task) {
+    Worker& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    pendingTasks.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::stealFront(size_t index, Task& task) {
+    Worker& worker = *workers[index];
+    std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    pendingTasks.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::takeTask(size_t self, Task& task, bool& wasStolen) {
+    wasStolen = false;
+    size_t count = workers.size();
+    size_t start = self < count ? self + 1 : nextQueue.load(std::memory_order_relaxed);
+
+    // Own deque first, then every other one starting next to ours to
+    // spread thieves; repeat while tasks are known to be queued (a victim
+    // may have been locked, or an outside submit may have landed in ours)
+    do {
+        if (self < count && popBack(self, task)) {
+            return true;
+        }
+        for (size_t offset = 0; offset < count; ++offset) {
+            size_t victim = (start + offset) % count;
+            if (victim != self && stealFront(victim, task)) {
+                wasStolen = true;
+                return true;
+            }
+        }
+    } while (pendingTasks.load() > 0 && !stopping.load(std::memory_order_relaxed));
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = static_cast<int>(index);
+    Worker& worker = *workers[index];
+
+    while (true) {
+        Task task;
+        bool wasStolen = false;
+        if (takeTask(index, task, wasStolen)) {
+            std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+            task();
+            worker.busyNanoseconds.fetch_add(elapsedNanoseconds(started), std::memory_order_relaxed);
+            worker.executed.fetch_add(1, std::memory_order_relaxed);
+            if (wasStolen) {
+                worker.stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return pendingTasks.load() > 0 || stopping.load(); });
+        if (stopping.load() && pendingTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::runPendingTask() {
+    int self = currentWorker();
+    Task task;
+    bool wasStolen = false;
+    if (!takeTask(self >= 0 ? static_cast<size_t>(self) : workers.size(), task, wasStolen)) {
+        return false;
+    }
+
+    if (self >= 0) {
+        Worker& worker = *workers[self];
+        std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        task();
+        worker.busyNanoseconds.fetch_add(elapsedNanoseconds(started), std::memory_order_relaxed);
+        worker.executed.fetch_add(1, std::memory_order_relaxed);
+        if (wasStolen) {
+            worker.stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        task();
+        callerTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+    ThreadPoolStats result;
+    result.workerCount = workers.size();
+    result.uptimeNanoseconds = elapsedNanoseconds(startTime);
+    result.tasksRunByCallers = callerTasks.load(std::memory_order_relaxed);
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        WorkerStats stats;
+        stats.tasksExecuted = worker->executed.load(std::memory_order_relaxed);
+        stats.tasksStolen = worker->stolen.load(std::memory_order_relaxed);
+        stats.busyNanoseconds = worker->busyNanoseconds.load(std::memory_order_relaxed);
+        if (result.uptimeNanoseconds > 0) {
+            stats.utilisation = static_cast<double>(stats.busyNanoseconds) / result.uptimeNanoseconds;
+        }
+        result.workers.push_back(stats);
+    }
+    return result;
+}
+
+TaskGroup::TaskGroup(ThreadPool& threadPool, CancellationToken token)
+    : pool(threadPool), cancelToken(std::move(token)), outstanding(0) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::finishTask() {
+    // Decrement under the mutex so wait() cannot return (and the group be
+    // destroyed) between the decrement and the notification
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outstanding.fetch_sub(1) == 1) {
+        done.notify_all();
+    }
+}
+
+void TaskGroup::wait() {
+    while (outstanding.load() > 0) {
+        if (pool.runPendingTask()) {
+            continue;
+        }
+        // Nothing left to help with: our tasks are running elsewhere
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::milliseconds(1),
+                      [this] { return outstanding.load() == 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace RideSharing
@@ -0,0 +1,162 @@
+/**
+ * trace.cpp
+ *
+ * Implementation of the per-thread span buffers and Chrome trace export
+ */
+
+#include "include/trace.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace RideSharing {
+
+namespace {
+
+// Events of one thread; the mutex is only contended while dumping
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t dropped;
+    int threadId;
+
+    explicit ThreadBuffer(int id) : dropped(0), threadId(id) {}
+};
+
+// Every buffer ever created, kept alive after its thread exits
+struct BufferRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int nextThreadId;
+
+    BufferRegistry() : nextThreadId(1) {}
+};
+
+BufferRegistry& registry() {
+    static BufferRegistry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        BufferRegistry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffer = std::make_shared<ThreadBuffer>(reg.nextThreadId++);
+        buffer->events.reserve(4096);
+        reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+const std::chrono::steady_clock::time_point& epoch() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+} // namespace
+
+bool Tracer::isEnabled() {
+#ifdef RIDESHARING_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+int64_t Tracer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch()).count();
+}
+
+void Tracer::record(const char* name, const char* category, int64_t startNs, int64_t endNs) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back(TraceEvent{name, category, startNs, endNs - startNs});
+}
+
+void Tracer::writeChromeTrace(std::ostream& out) {
+    BufferRegistry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+
+    size_t dropped = 0;
+    bool first = true;
+    out << "{\"traceEvents\":[";
+
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        dropped += buffer->dropped;
+
+        out << (first ? "" : ",")
+            << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"thread " << buffer->threadId << "\"}}";
+        first = false;
+
+        // Timestamps and durations are in microseconds
+        for (const TraceEvent& event : buffer->events) {
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << (event.startNs / 1000) << "." << ((event.startNs % 1000) / 100)
+                << ",\"dur\":" << (event.durationNs / 1000) << "." << ((event.durationNs % 1000) / 100)
+                << "}";
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+}
+
+std::string Tracer::toChromeTraceJSON() {
+    std::ostringstream oss;
+    writeChromeTrace(oss);
+    return oss.str();
+}
+
+bool Tracer::writeChromeTraceFile(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    writeChromeTrace(file);
+    return static_cast<bool>(file);
+}
+
+void Tracer::clear() {
+    BufferRegistry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+}
+
+size_t Tracer::eventCount() {
+    BufferRegistry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    size_t total = 0;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        total += buffer->events.size();
+    }
+    return total;
+}
+
+size_t Tracer::droppedCount() {
+    BufferRegistry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    size_t total = 0;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        total += buffer->dropped;
+    }
+    return total;
+}
+
+} // namespace RideSharing
@@ -25,7 +25,56 @@ app.use(express.static(path.join(__dirname, '../frontend')));
 // Global state (in production, use database)
 let cityGraph = null;
 let rideMatcher = null;
-let drivers = [];
+
+/**
+ * Convert a native ride match into a JSON-serialisable object.
+ * Paths arrive as Int32Array views over native memory; JSON.stringify
+ * would render them as index-keyed objects, so copy them to plain arrays.
+ */
+function toPlainMatch(match) {
+    if (!match.success) {
+        return match;
+    }
+    return {
+        ...match,
+        pathToPickup: Array.from(match.pathToPickup),
+        pathToDestination: Array.from(match.pathToDestination)
+    };
+}
+
+/**
+ * Content negotiation: true if the client prefers CBOR over JSON.
+ * CBOR bodies carry the payload only (the JSON `data` field); the HTTP
+ * status code signals success. Errors are always JSON.
+ */
+function wantsCbor(req) {
+    return req.accepts(['application/json', 'application/cbor']) === 'application/cbor';
+}
+
+function sendCbor(res, status, buffer) {
+    res.status(status).vary('Accept').type('application/cbor').send(buffer);
+}
+
+/**
+ * Load the distance table at tablePath into the matcher, rebuilding it
+ * from the current graph when the file is missing or was built from
+ * another graph
+ */
+function useDistanceTable(tablePath) {
+    let loaded = false;
+    try {
+        loaded = rideMatcher.loadDistanceTable(tablePath);
+    } catch (error) {
+        // Missing or unreadable: rebuilt below
+    }
+    if (!loaded) {
+        const table = cityGraph.buildDistanceTable(tablePath);
+        rideMatcher.loadDistanceTable(tablePath);
+        console.log(`- Built distance table ${tablePath} (${table.bytes} bytes)`);
+    } else {
+        console.log(`- Mapped distance table ${tablePath}`);
+    }
+}
 
 /**
  * Initialize system with demo data from C++
@@ -38,18 +87,23 @@ function initializeSystem() {
         const cityData = nativeAddon.generateCityGraph(50);
 
         cityGraph = cityData.graph;
-        drivers = cityData.drivers;
         rideMatcher = new nativeAddon.RideMatcher(cityGraph);
 
-        // Add all drivers to the matcher
-        drivers.forEach(driver => {
-            rideMatcher.addDriver(driver);
-        });
+        // Add all drivers to the matcher in a single native call;
+        // from here on the native DriverManager is the only copy
+        rideMatcher.addDrivers(cityData.drivers);
+
+        // DISTANCE_TABLE=path: answer distances from an all-pairs table,
+        // mapped from path, or built there if it is missing or stale
+        if (process.env.DISTANCE_TABLE) {
+            useDistanceTable(process.env.DISTANCE_TABLE);
+        }
+        const stats = rideMatcher.getStats();
 
         console.log('System initialized successfully with C++ backend!');
         console.log(`- Graph nodes: ${cityGraph.getNumVertices()}`);
-        console.log(`- Total drivers: ${drivers.length}`);
-        console.log(`- Available drivers: ${drivers.filter(d => d.isAvailable).length}`);
+        console.log(`- Total drivers: ${stats.totalDrivers}`);
+        console.log(`- Available drivers: ${stats.availableDrivers}`);
 
     } catch (error) {
         console.error('Failed to initialize system:', error);
@@ -67,17 +121,52 @@ initializeSystem();
 
 // Health check
 app.get('/api/health', (req, res) => {
-    const availableDrivers = drivers.filter(d => d.isAvailable).length;
+    // O(1) counters maintained by the native DriverManager/RideMatcher
+    const stats = rideMatcher.getStats();
     res.json({
         status: 'healthy',
         backend: 'C++ Native Addon',
         timestamp: new Date().toISOString(),
         graphNodes: cityGraph ? cityGraph.getNumVertices() : 0,
-        totalDrivers: drivers.length,
-        availableDrivers: availableDrivers
+        totalDrivers: stats.totalDrivers,
+        availableDrivers: stats.availableDrivers,
+        busyDrivers: stats.busyDrivers,
+        driversByVehicleType: stats.byVehicleType,
+        queueDepth: stats.queueDepth,
+        totalRequests: stats.totalRequests,
+        successfulMatches: stats.successfulMatches,
+        failedMatches: stats.failedMatches
     });
 });
 
+// Native memory breakdown: graph, driver manager, matcher and heap peak
+app.get('/api/debug/memory', (req, res) => {
+    res.json({
+        success: true,
+        data: rideMatcher.memoryReport()
+    });
+});
+
+// Chrome trace of native spans recorded since the last call (load it in
+// chrome://tracing or Perfetto); needs an addon built with enable_tracing=true
+app.get('/api/debug/trace', (req, res) => {
+    if (!nativeAddon.tracingEnabled) {
+        return res.status(404).json({
+            success: false,
+            error: 'Tracing not compiled in (rebuild with --enable_tracing=true)'
+        });
+    }
+
+    const trace = nativeAddon.getTrace();
+    nativeAddon.clearTrace();
+    res.type('application/json').send(trace);
+});
+
+// Prometheus scrape endpoint; the counters are aggregated natively
+app.get('/metrics', (req, res) => {
+    res.type('text/plain; version=0.0.4').send(nativeAddon.metricsText());
+});
+
 // Get graph data
 app.get('/api/graph', (req, res) => {
     try {
@@ -88,30 +177,62 @@ app.get('/api/graph', (req, res) => {
             });
         }
 
-        const nodes = cityGraph.getAllNodes();
-        const numVertices = cityGraph.getNumVertices();
+        // Columnar export encoded natively (numeric columns as typed arrays)
+        if (wantsCbor(req)) {
+            return sendCbor(res, 200, cityGraph.exportGraphCbor());
+        }
 
-        // Get all edges
-        const edges = [];
-        for (let i = 0; i < numVertices; i++) {
-            const adjacentNodes = cityGraph.getAdjacentNodes(i);
-            adjacentNodes.forEach(edge => {
-                // Avoid duplicate edges (undirected graph)
-                if (i < edge.destination) {
-                    edges.push({
-                        source: i,
-                        destination: edge.destination,
-                        weight: edge.weight,
-                        roadName: edge.roadName
-                    });
+        // Whole graph in a single native call, as typed-array columns
+        const graph = cityGraph.exportGraph();
+
+        if (req.query.format === 'columnar') {
+            // edges=false: nodes only, for clients that draw roads from tiles
+            const withEdges = req.query.edges !== 'false';
+            return res.json({
+                success: true,
+                data: {
+                    format: 'columnar',
+                    numVertices: graph.numVertices,
+                    numEdges: graph.edgeSources.length,
+                    nodeIds: Array.from(graph.nodeIds),
+                    latitudes: Array.from(graph.latitudes),
+                    longitudes: Array.from(graph.longitudes),
+                    nodeNameIds: Array.from(graph.nodeNameIds),
+                    edgeSources: withEdges ? Array.from(graph.edgeSources) : [],
+                    edgeTargets: withEdges ? Array.from(graph.edgeTargets) : [],
+                    edgeWeights: withEdges ? Array.from(graph.edgeWeights) : [],
+                    roadNameIds: withEdges ? Array.from(graph.roadNameIds) : [],
+                    roadClasses: withEdges ? Array.from(graph.roadClasses) : [],
+                    names: graph.names
                 }
             });
         }
 
+        const nodes = new Array(graph.nodeIds.length);
+        for (let i = 0; i < graph.nodeIds.length; i++) {
+            nodes[i] = {
+                id: graph.nodeIds[i],
+                name: graph.names[graph.nodeNameIds[i]],
+                latitude: graph.latitudes[i],
+                longitude: graph.longitudes[i]
+            };
+        }
+
+        const edges = new Array(graph.edgeSources.length);
+        for (let i = 0; i < graph.edgeSources.length; i++) {
+            edges[i] = {
+                source: graph.edgeSources[i],
+                destination: graph.edgeTargets[i],
+                weight: graph.edgeWeights[i],
+                roadName: graph.names[graph.roadNameIds[i]],
+                roadClass: graph.roadClasses[i]
+            };
+        }
+
         res.json({
             success: true,
             data: {
-                numVertices: numVertices,
+                numVertices: graph.numVertices,
                 nodes: nodes,
                 edges: edges
             }
@@ -126,9 +247,106 @@ app.get('/api/graph', (req, res) => {
     }
 });
 
+// Roads visible in a box at a web-map zoom, as a binary tile
+// (?bbox=minLon,minLat,maxLon,maxLat&zoom=z; format in cpp/include/graph_tile.h)
+app.get('/api/graph/tile', (req, res) => {
+    try {
+        if (!cityGraph) {
+            return res.status(500).json({
+                success: false,
+                error: 'Graph not initialized'
+            });
+        }
+
+        const bbox = String(req.query.bbox || '').split(',').map(Number);
+        const zoom = Number(req.query.zoom);
+        if (bbox.length !== 4 || bbox.some(value => !Number.isFinite(value)) || !Number.isFinite(zoom)) {
+            return res.status(400).json({
+                success: false,
+                error: 'Expected bbox=minLon,minLat,maxLon,maxLat and zoom'
+            });
+        }
+
+        res.type('application/octet-stream').send(cityGraph.graphTile(bbox, Math.floor(zoom)));
+    } catch (error) {
+        res.status(400).json({
+            success: false,
+            error: error.message
+        });
+    }
+});
+
+// Roads carrying the largest share of shortest paths (betweenness), both
+// directions of a road summed (?top=20&samples=N; exact without samples)
+app.get('/api/graph/critical-roads', (req, res) => {
+    try {
+        if (!cityGraph) {
+            return res.status(500).json({
+                success: false,
+                error: 'Graph not initialized'
+            });
+        }
+
+        const top = Math.max(1, parseInt(req.query.top, 10) || 20);
+        const samples = parseInt(req.query.samples, 10) || 0;
+        const scores = cityGraph.betweenness(samples > 0 ? { samples } : undefined);
+
+        // Edges come in getAdjacentNodes order, so position is the edge's
+        // index in its source's adjacency list
+        const roads = new Map();
+        let position = 0;
+        for (let e = 0; e < scores.edgeScores.length; e++) {
+            const source = scores.edgeSources[e];
+            const target = scores.edgeTargets[e];
+            position = e > 0 && scores.edgeSources[e - 1] === source ? position + 1 : 0;
+            const key = source < target ? `${source}-${target}` : `${target}-${source}`;
+            const road = roads.get(key);
+            if (road) {
+                road.score += scores.edgeScores[e];
+            } else {
+                roads.set(key, { source, target, position, score: scores.edgeScores[e] });
+            }
+        }
+
+        const critical = Array.from(roads.values())
+            .sort((a, b) => b.score - a.score)
+            .slice(0, top)
+            .map(road => {
+                const edge = cityGraph.getAdjacentNodes(road.source)[road.position];
+                return {
+                    from: road.source,
+                    to: road.target,
+                    roadName: edge.roadName,
+                    roadClass: edge.roadClass,
+                    score: road.score
+                };
+            });
+
+        res.json({
+            success: true,
+            data: {
+                roads: critical,
+                sourcesSearched: scores.sourcesSearched,
+                exact: scores.exact,
+                errorBound: scores.errorBound
+            }
+        });
+    } catch (error) {
+        console.error('Error computing critical roads:', error);
+        res.status(500).json({
+            success: false,
+            error: error.message
+        });
+    }
+});
+
 // Get all drivers
 app.get('/api/drivers', (req, res) => {
     try {
+        if (wantsCbor(req)) {
+            return sendCbor(res, 200, rideMatcher.getAllDriversCbor());
+        }
+
         const allDrivers = rideMatcher.getAllDrivers();
         res.json({
             success: true,
@@ -184,12 +402,6 @@ app.put('/api/drivers/:driverId/location', (req, res) => {
 
         rideMatcher.updateDriverLocation(driverId, location);
 
-        // Update local drivers array
-        const driverIndex = drivers.findIndex(d => d.id === driverId);
-        if (driverIndex !== -1) {
-            drivers[driverIndex].currentLocation = location;
-        }
-
         res.json({
             success: true,
             message: 'Driver location updated',
@@ -219,12 +431,6 @@ app.put('/api/drivers/:driverId/availability', (req, res) => {
 
         rideMatcher.setDriverAvailability(driverId, isAvailable);
 
-        // Update local drivers array
-        const driverIndex = drivers.findIndex(d => d.id === driverId);
-        if (driverIndex !== -1) {
-            drivers[driverIndex].isAvailable = isAvailable;
-        }
-
         res.json({
             success: true,
             message: 'Driver availability updated',
@@ -252,6 +458,12 @@ app.post('/api/rides/find', (req, res) => {
             });
         }
 
+        if (wantsCbor(req)) {
+            // Native matching + encoding; the banner log is skipped on this path
+            const encoded = rideMatcher.findRideCbor(passengerId, pickupLocation, destinationLocation);
+            return sendCbor(res, encoded.success ? 200 : 404, encoded.body);
+        }
+
         console.log(`\n${'='.repeat(60)}`);
         console.log(`RIDE REQUEST`);
         console.log(`${'='.repeat(60)}`);
@@ -278,13 +490,7 @@ app.post('/api/rides/find', (req, res) => {
         console.log(`Estimated time: ${match.estimatedTime} minutes`);
         console.log(`${'='.repeat(60)}\n`);
 
-        // Update driver availability in local array
-        const driverIndex = drivers.findIndex(d => d.id === match.driver.id);
-        if (driverIndex !== -1) {
-            drivers[driverIndex].isAvailable = false;
-        }
-
-        res.json(match);
+        res.json(toPlainMatch(match));
 
     } catch (error) {
         console.error('Error finding ride:', error);
@@ -337,12 +543,6 @@ app.post('/api/ride/request', (req, res) => {
         console.log(`Estimated time: ${match.estimatedTime} minutes`);
         console.log(`${'='.repeat(60)}\n`);
 
-        // Update driver availability in local array
-        const driverIndex = drivers.findIndex(d => d.id === match.driver.id);
-        if (driverIndex !== -1) {
-            drivers[driverIndex].isAvailable = false;
-        }
-
         // Format response to match frontend expectations
         res.json({
             success: true,
@@ -350,12 +550,12 @@ app.post('/api/ride/request', (req, res) => {
                 assignedDriver: match.driver,
                 driverToPickup: {
                     distance: match.distanceToPickup,
-                    path: match.pathToPickup,
+                    path: Array.from(match.pathToPickup),
                     eta: match.estimatedTime
                 },
                 pickupToDestination: {
                     distance: match.distanceToDestination,
-                    path: match.pathToDestination,
+                    path: Array.from(match.pathToDestination),
                     eta: match.estimatedTime
                 },
                 totalDistance: match.totalDistance,
@@ -427,7 +627,7 @@ app.post('/api/path/shortest', (req, res) => {
         res.json({
             success: true,
             data: {
-                path: match.pathToDestination,
+                path: Array.from(match.pathToDestination),
                 distance: match.distanceToDestination,
                 source: source,
                 destination: destination,
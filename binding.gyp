@@ -1,20 +1,74 @@
 {
+  "variables": {
+    # node-gyp rebuild --enable_tracing=true compiles in TRACE_SPAN spans
+    "enable_tracing%": "false"
+  },
+  "target_defaults": {
+    "conditions": [
+      ["enable_tracing=='true'", {
+        "defines": [ "RIDESHARING_ENABLE_TRACING" ]
+      }]
+    ]
+  },
   "targets": [
+    # Routing and matching core shared by the addon, server and benchmarks
+    {
+      "target_name": "uber_mini_core",
+      "type": "static_library",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "backend/cpp/src/graph.cpp",
+        "backend/cpp/src/graph_snapshot.cpp",
+        "backend/cpp/src/cbor_encoder.cpp",
+        "backend/cpp/src/dijkstra.cpp",
+        "backend/cpp/src/min_heap.cpp",
+        "backend/cpp/src/driver_manager.cpp",
+        "backend/cpp/src/ride_matcher.cpp",
+        "backend/cpp/src/city_graph_generator.cpp",
+        "backend/cpp/src/trace.cpp",
+        "backend/cpp/src/metrics.cpp",
+        "backend/cpp/src/json_writer.cpp",
+        "backend/cpp/src/thread_pool.cpp",
+        "backend/cpp/src/routing_graph.cpp",
+        "backend/cpp/src/geo_distance.cpp",
+        "backend/cpp/src/graph_tile.cpp",
+        "backend/cpp/src/route_coalescer.cpp",
+        "backend/cpp/src/distance_table.cpp",
+        "backend/cpp/src/betweenness.cpp",
+        "backend/cpp/src/graph_components.cpp"
+      ],
+      "include_dirs": [
+        "backend/cpp",
+        "backend/cpp/include"
+      ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": [ "/std:c++17" ]
+        }
+      },
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [ "_HAS_EXCEPTIONS=1" ]
+        }],
+        ["OS!='win'", {
+          "cflags": [ "-std=c++17", "-fno-math-errno" ],
+          "cflags_cc": [ "-std=c++17", "-fno-math-errno" ]
+        }]
+      ]
+    },
     {
       "target_name": "uber_mini_native",
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
+      "dependencies": [ "uber_mini_core" ],
       "sources": [
-        "backend/cpp/node_binding.cpp",
-        "backend/cpp/graph.cpp",
-        "backend/cpp/dijkstra.cpp",
-        "backend/cpp/min_heap.cpp",
-        "backend/cpp/driver_manager.cpp",
-        "backend/cpp/ride_matcher.cpp",
-        "backend/cpp/city_graph_generator.cpp"
+        "backend/cpp/src/node_binding.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
+        "backend/cpp",
         "backend/cpp/include"
       ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
@@ -33,6 +87,85 @@
           "cflags_cc": [ "-std=c++17" ]
         }]
       ]
+    },
+    # Native micro-benchmarks of the core (JSON results)
+    {
+      "target_name": "uber_mini_bench",
+      "type": "executable",
+      "dependencies": [ "uber_mini_core" ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "backend/cpp/bench/core_bench.cpp",
+        "backend/cpp/bench/alloc_counter.cpp"
+      ],
+      "include_dirs": [
+        "backend/cpp",
+        "backend/cpp/include"
+      ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": [ "/std:c++17" ]
+        }
+      },
+      "conditions": [
+        ["OS!='win'", {
+          "cflags": [ "-std=c++17" ],
+          "cflags_cc": [ "-std=c++17" ]
+        }]
+      ]
+    },
+    # End-to-end load generator (open/closed loop, latency percentiles)
+    {
+      "target_name": "uber_mini_loadgen",
+      "type": "executable",
+      "dependencies": [ "uber_mini_core" ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "backend/cpp/bench/load_generator.cpp"
+      ],
+      "include_dirs": [
+        "backend/cpp",
+        "backend/cpp/include"
+      ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": [ "/std:c++17" ]
+        }
+      },
+      "conditions": [
+        ["OS!='win'", {
+          "cflags": [ "-std=c++17" ],
+          "cflags_cc": [ "-std=c++17" ]
+        }]
+      ]
     }
+  ],
+  "conditions": [
+    # Standalone epoll dispatch server (Linux only)
+    ["OS=='linux'", {
+      "targets": [
+        {
+          "target_name": "uber_mini_server",
+          "type": "executable",
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "cflags": [ "-std=c++17" ],
+          "cflags_cc": [ "-std=c++17" ],
+          "dependencies": [ "uber_mini_core" ],
+          "sources": [
+            "backend/cpp/server/native_server.cpp",
+            "backend/cpp/src/http_server.cpp"
+          ],
+          "include_dirs": [
+            "backend/cpp",
+            "backend/cpp/include"
+          ]
+        }
+      ]
+    }]
   ]
 }
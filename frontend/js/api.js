@@ -87,10 +87,30 @@ class ApiClient {
     }
 
     /**
-     * Get city graph data
+     * Get city graph data (columnar export, expanded by MapRenderer).
+     * Roads are not included; MapRenderer fetches them as tiles
      */
     async getGraph() {
-        return await this.get('/graph');
+        return await this.get('/graph?format=columnar&edges=false');
+    }
+
+    /**
+     * Get the roads visible in a box at a zoom level as a binary tile
+     * (bbox is [minLon, minLat, maxLon, maxLat])
+     */
+    async getGraphTile(bbox, zoom) {
+        const endpoint = `/graph/tile?bbox=${bbox.join(',')}&zoom=${zoom}`;
+        try {
+            const response = await fetch(`${API_BASE_URL}${endpoint}`);
+            if (!response.ok) {
+                const data = await response.json();
+                throw new Error(data.error || 'Request failed');
+            }
+            return await response.arrayBuffer();
+        } catch (error) {
+            console.error(`GET ${endpoint} failed:`, error);
+            throw error;
+        }
     }
 
     /**
@@ -53,8 +53,8 @@ class App {
             const response = await apiClient.getGraph();
 
             if (response.success) {
-                this.graphData = response.data;
-                this.mapRenderer.loadGraph(this.graphData);
+                this.mapRenderer.loadGraph(response.data);
+                this.graphData = this.mapRenderer.graph;
                 this.uiController.populateLocations(this.graphData.nodes);
 
                 // Update stats
@@ -65,7 +65,7 @@ class App {
                 this.uiController.updateStats(
                     availableDrivers,
                     this.graphData.numVertices,
-                    this.graphData.edges.length
+                    this.graphData.numEdges
                 );
 
                 console.log('Graph data loaded:', this.graphData);
@@ -95,7 +95,7 @@ class App {
                 this.uiController.updateStats(
                     availableDrivers,
                     this.graphData ? this.graphData.numVertices : 0,
-                    this.graphData ? this.graphData.edges.length : 0
+                    this.graphData ? this.graphData.numEdges : 0
                 );
 
                 console.log('Drivers loaded:', this.driversData);
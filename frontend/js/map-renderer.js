@@ -3,6 +3,8 @@
  *
  * Renders the city map with nodes, edges, drivers, and routes
  * Shows weighted edges, driver names, and real-time selection highlighting
+ * Roads come from native graph tiles covering the visible area, with less
+ * detail (major roads, simplified lines) when zoomed out
  */
 
 class MapRenderer {
@@ -26,6 +28,12 @@ class MapRenderer {
         this.showLabels = true;
         this.showWeights = true; // Show edge weights
 
+        // Road tile covering the view (see updateTile)
+        this.tile = null;
+        this.tileBox = null;
+        this.tileZoom = null;
+        this.pendingTileKey = null;
+
         // Animation
         this.animationFrame = 0;
         this.isAnimating = false;
@@ -99,14 +107,105 @@ class MapRenderer {
     }
 
     /**
-     * Load graph data
+     * Load graph data (row or columnar format)
      */
     loadGraph(graphData) {
-        this.graph = graphData;
+        this.graph = graphData.format === 'columnar'
+            ? MapRenderer.fromColumnarGraph(graphData)
+            : graphData;
+        this.tile = null;
+        this.tileBox = null;
+        this.tileZoom = null;
+        this.pendingTileKey = null;
         this.centerView();
         this.render();
     }
 
+    /**
+     * Build node/edge lists from the columnar graph export
+     */
+    static fromColumnarGraph(columns) {
+        const nodes = new Array(columns.nodeIds.length);
+        for (let i = 0; i < nodes.length; i++) {
+            nodes[i] = {
+                id: columns.nodeIds[i],
+                name: columns.names[columns.nodeNameIds[i]],
+                latitude: columns.latitudes[i],
+                longitude: columns.longitudes[i]
+            };
+        }
+
+        const edges = new Array(columns.edgeSources.length);
+        for (let i = 0; i < edges.length; i++) {
+            edges[i] = {
+                source: columns.edgeSources[i],
+                destination: columns.edgeTargets[i],
+                weight: columns.edgeWeights[i],
+                roadName: columns.names[columns.roadNameIds[i]],
+                roadClass: columns.roadClasses[i]
+            };
+        }
+
+        return {
+            numVertices: columns.numVertices,
+            numEdges: columns.numEdges !== undefined ? columns.numEdges : edges.length,
+            nodes: nodes,
+            edges: edges
+        };
+    }
+
+    /**
+     * Decode a binary graph tile (format in backend/cpp/include/graph_tile.h)
+     * into lines of { roadClass, weight, points: [{ latitude, longitude }] }
+     */
+    static decodeTile(buffer, bbox) {
+        const bytes = new Uint8Array(buffer);
+        let pos = 0;
+        const readVarint = () => {
+            let value = 0;
+            let multiplier = 1;
+            let byte;
+            do {
+                byte = bytes[pos++];
+                value += (byte & 0x7f) * multiplier;
+                multiplier *= 128;
+            } while (byte & 0x80);
+            return value;
+        };
+        const readSignedVarint = () => {
+            const value = readVarint();
+            return value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+        };
+
+        readVarint(); // version
+        const extent = readVarint();
+        const hasWeights = (readVarint() & 1) !== 0;
+        const lineCount = readVarint();
+
+        const [minLon, minLat, maxLon, maxLat] = bbox;
+        const lonPerUnit = (maxLon - minLon) / extent;
+        const latPerUnit = (maxLat - minLat) / extent;
+
+        const lines = new Array(lineCount);
+        let x = 0;
+        let y = 0;
+        for (let i = 0; i < lineCount; i++) {
+            const header = readVarint();
+            const weight = hasWeights ? readVarint() / 10 : null;
+            const points = new Array(Math.floor(header / 8));
+            for (let j = 0; j < points.length; j++) {
+                x += readSignedVarint();
+                y += readSignedVarint();
+                points[j] = {
+                    latitude: maxLat - y * latPerUnit,
+                    longitude: minLon + x * lonPerUnit
+                };
+            }
+            lines[i] = { roadClass: header & 7, weight: weight, points: points };
+        }
+        return lines;
+    }
+
     /**
      * Load drivers
      */
@@ -189,6 +288,72 @@ class MapRenderer {
         return { x, y };
     }
 
+    /**
+     * Convert canvas coordinates to lat/lon
+     */
+    canvasToLatLon(x, y) {
+        return {
+            lat: this.centerLat - (y - this.offsetY) / (10000 * this.scale),
+            lon: this.centerLon + (x - this.offsetX) / (10000 * this.scale)
+        };
+    }
+
+    /**
+     * Web-map zoom level of the current scale (256-pixel world at zoom 0)
+     */
+    viewZoom() {
+        const pixelsPerDegree = 10000 * this.scale;
+        return Math.floor(Math.log2(pixelsPerDegree * 360 / 256));
+    }
+
+    /**
+     * Fetch a new road tile if the view has left the current one or the
+     * zoom level changed. The tile covers the view plus half a screen on
+     * each side, so small pans reuse it
+     */
+    updateTile() {
+        if (!this.graph || this.graph.edges.length > 0 || this.centerLat === undefined) {
+            return;
+        }
+
+        const topLeft = this.canvasToLatLon(0, 0);
+        const bottomRight = this.canvasToLatLon(this.canvas.width, this.canvas.height);
+        const view = [topLeft.lon, bottomRight.lat, bottomRight.lon, topLeft.lat];
+        const zoom = this.viewZoom();
+
+        const covered = this.tileBox && this.tileZoom === zoom &&
+            view[0] >= this.tileBox[0] && view[1] >= this.tileBox[1] &&
+            view[2] <= this.tileBox[2] && view[3] <= this.tileBox[3];
+        if (covered) {
+            return;
+        }
+
+        const padLon = (view[2] - view[0]) / 2;
+        const padLat = (view[3] - view[1]) / 2;
+        const bbox = [view[0] - padLon, view[1] - padLat, view[2] + padLon, view[3] + padLat];
+        const key = `${bbox.join(',')}@${zoom}`;
+        if (this.pendingTileKey !== null) {
+            return; // One request at a time; the next render asks again
+        }
+
+        const graph = this.graph;
+        this.pendingTileKey = key;
+        apiClient.getGraphTile(bbox, zoom)
+            .then((buffer) => {
+                if (this.graph !== graph) return;
+                this.tile = MapRenderer.decodeTile(buffer, bbox);
+                this.tileBox = bbox;
+                this.tileZoom = zoom;
+            })
+            .catch((error) => console.error('Error loading graph tile:', error))
+            .finally(() => {
+                if (this.pendingTileKey === key) {
+                    this.pendingTileKey = null;
+                    this.render();
+                }
+            });
+    }
+
     /**
      * Zoom in
      */
@@ -283,6 +448,7 @@ class MapRenderer {
         if (!this.graph) return;
 
         // Draw edges (with weights)
+        this.updateTile();
         this.drawEdges();
 
         // Draw route paths (if any)
@@ -299,10 +465,14 @@ class MapRenderer {
     }
 
     /**
-     * Draw all edges with weights
+     * Draw all edges with weights: from the graph when it carries edges,
+     * otherwise from the current road tile
      */
     drawEdges() {
-        if (!this.graph.edges) return;
+        if (this.graph.edges.length === 0) {
+            this.drawTile();
+            return;
+        }
 
         this.ctx.strokeStyle = '#d0d0d0';
         this.ctx.lineWidth = 2;
@@ -324,25 +494,76 @@ class MapRenderer {
 
             // Draw weight label (if zoomed in enough)
             if (this.showWeights && this.scale > 0.6) {
-                const midX = (start.x + end.x) / 2;
-                const midY = (start.y + end.y) / 2;
-
-                // Background for weight label
-                this.ctx.fillStyle = 'rgba(255, 255, 255, 0.9)';
-                const weightText = edge.weight.toFixed(1) + ' km';
-                const textWidth = this.ctx.measureText(weightText).width;
-                this.ctx.fillRect(midX - textWidth / 2 - 3, midY - 8, textWidth + 6, 16);
-
-                // Weight text
-                this.ctx.fillStyle = '#555';
-                this.ctx.font = 'bold 11px Arial';
-                this.ctx.textAlign = 'center';
-                this.ctx.textBaseline = 'middle';
-                this.ctx.fillText(weightText, midX, midY);
+                this.drawWeightLabel(start, end, edge.weight);
+            }
+        }
+    }
+
+    /**
+     * Draw the road tile, major roads wider and darker
+     */
+    drawTile() {
+        if (!this.tile) return;
+
+        // Highway, ring, arterial, connector, local
+        const styles = [
+            { color: '#a8a8a8', width: 4 },
+            { color: '#b4b4b4', width: 3.5 },
+            { color: '#c4c4c4', width: 2.5 },
+            { color: '#c4c4c4', width: 2 },
+            { color: '#d0d0d0', width: 2 }
+        ];
+
+        for (const line of this.tile) {
+            const style = styles[line.roadClass] || styles[styles.length - 1];
+            this.ctx.strokeStyle = style.color;
+            this.ctx.lineWidth = style.width;
+
+            this.ctx.beginPath();
+            line.points.forEach((point, i) => {
+                const p = this.latLonToCanvas(point.latitude, point.longitude);
+                if (i === 0) {
+                    this.ctx.moveTo(p.x, p.y);
+                } else {
+                    this.ctx.lineTo(p.x, p.y);
+                }
+            });
+            this.ctx.stroke();
+        }
+
+        // Weights are only sent at detail zoom, one edge per line
+        if (this.showWeights && this.scale > 0.6) {
+            for (const line of this.tile) {
+                if (line.weight === null) continue;
+                const first = line.points[0];
+                const last = line.points[line.points.length - 1];
+                this.drawWeightLabel(this.latLonToCanvas(first.latitude, first.longitude),
+                    this.latLonToCanvas(last.latitude, last.longitude), line.weight);
             }
         }
     }
 
+    /**
+     * Draw an edge weight at the middle of a segment
+     */
+    drawWeightLabel(start, end, weight) {
+        const midX = (start.x + end.x) / 2;
+        const midY = (start.y + end.y) / 2;
+
+        // Background for weight label
+        this.ctx.fillStyle = 'rgba(255, 255, 255, 0.9)';
+        const weightText = weight.toFixed(1) + ' km';
+        const textWidth = this.ctx.measureText(weightText).width;
+        this.ctx.fillRect(midX - textWidth / 2 - 3, midY - 8, textWidth + 6, 16);
+
+        // Weight text
+        this.ctx.fillStyle = '#555';
+        this.ctx.font = 'bold 11px Arial';
+        this.ctx.textAlign = 'center';
+        this.ctx.textBaseline = 'middle';
+        this.ctx.fillText(weightText, midX, midY);
+    }
+
     /**
      * Draw route paths with animation
      */